@@ -6,7 +6,7 @@
 #include "bucket/BucketList.h"
 #include "bucket/BucketManager.h"
 #include "catchup/ApplyLedgerWork.h"
-#include "history/FileTransferInfo.h"
+#include "crypto/SHA.h"
 #include "history/HistoryManager.h"
 #include "historywork/Progress.h"
 #include "invariant/InvariantDoesNotHold.h"
@@ -14,30 +14,146 @@
 #include "ledger/LedgerManager.h"
 #include "main/Application.h"
 #include "main/ErrorMessages.h"
-#include "util/FileSystemException.h"
+#include "transactions/SignatureUtils.h"
+#include "transactions/TransactionUtils.h"
 #include "util/GlobalChecks.h"
 #include "util/XDRCereal.h"
 #include <Tracy.hpp>
 #include <fmt/format.h>
+#include <xdrpp/marshal.h>
+#include <algorithm>
 #include <optional>
 
 namespace stellar
 {
 
-ApplyCheckpointWork::ApplyCheckpointWork(Application& app,
-                                         TmpDir const& downloadDir,
-                                         LedgerRange const& range,
-                                         OnFailureCallback cb)
+uint32_t const ApplyCheckpointWork::REPLAY_LOOKAHEAD_LEDGERS = 8;
+
+namespace
+{
+// Verifies the signatures of `sigs` made by any of `keys`, populating the
+// signature verification cache.
+void
+verifySignatures(xdr::xvector<DecoratedSignature, 20> const& sigs,
+                 std::vector<AccountID> const& keys, Hash const& contentsHash)
+{
+    for (auto const& sig : sigs)
+    {
+        for (auto const& key : keys)
+        {
+            // Only signatures with a matching hint get verified
+            if (SignatureUtils::verify(sig, key, contentsHash))
+            {
+                break;
+            }
+        }
+    }
+}
+
+// Without the ledger state, only the master keys of the source accounts are
+// known signers, which covers most transactions.
+void
+verifyTxSignatures(xdr::xvector<DecoratedSignature, 20> const& sigs,
+                   AccountID const& source,
+                   xdr::xvector<Operation, MAX_OPS_PER_TX> const& ops,
+                   Hash const& contentsHash)
+{
+    std::vector<AccountID> keys{source};
+    for (auto const& op : ops)
+    {
+        if (op.sourceAccount)
+        {
+            keys.emplace_back(toAccountID(*op.sourceAccount));
+        }
+    }
+    verifySignatures(sigs, keys, contentsHash);
+}
+
+// The contents hashes are computed as in TransactionFrame and
+// FeeBumpTransactionFrame, without copying the envelopes into frames.
+void
+verifyTxSignatures(Hash const& networkID, TransactionV1Envelope const& env)
+{
+    verifyTxSignatures(
+        env.signatures, toAccountID(env.tx.sourceAccount), env.tx.operations,
+        sha256(xdr::xdr_to_opaque(networkID, ENVELOPE_TYPE_TX, env.tx)));
+}
+
+void
+verifyTxSignatures(Hash const& networkID, TransactionEnvelope const& env)
+{
+    switch (env.type())
+    {
+    case ENVELOPE_TYPE_TX_V0:
+    {
+        auto const& v0 = env.v0();
+        AccountID source;
+        source.ed25519() = v0.tx.sourceAccountEd25519;
+        verifyTxSignatures(
+            v0.signatures, source, v0.tx.operations,
+            sha256(xdr::xdr_to_opaque(networkID, ENVELOPE_TYPE_TX, 0, v0.tx)));
+        break;
+    }
+    case ENVELOPE_TYPE_TX:
+        verifyTxSignatures(networkID, env.v1());
+        break;
+    case ENVELOPE_TYPE_TX_FEE_BUMP:
+    {
+        auto const& feeBump = env.feeBump();
+        auto contentsHash = sha256(xdr::xdr_to_opaque(
+            networkID, ENVELOPE_TYPE_TX_FEE_BUMP, feeBump.tx));
+        verifySignatures(feeBump.signatures,
+                         {toAccountID(feeBump.tx.feeSource)}, contentsHash);
+        verifyTxSignatures(networkID, feeBump.tx.innerTx.v1());
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// Runs on a background thread, ahead of the application of `txSet`, so that
+// its signatures are found in the verification cache when it's applied.
+void
+verifyTxSetSignatures(Hash const& networkID,
+                      TransactionHistoryEntry const& txSet)
+{
+    ZoneScoped;
+    if (txSet.ext.v() == 0)
+    {
+        for (auto const& env : txSet.txSet.txs)
+        {
+            verifyTxSignatures(networkID, env);
+        }
+        return;
+    }
+    for (auto const& phase : txSet.ext.generalizedTxSet().v1TxSet().phases)
+    {
+        for (auto const& component : phase.v0Components())
+        {
+            for (auto const& env : component.txsMaybeDiscountedFee().txs)
+            {
+                verifyTxSignatures(networkID, env);
+            }
+        }
+    }
+}
+}
+
+ApplyCheckpointWork::ApplyCheckpointWork(
+    Application& app, std::shared_ptr<CheckpointReplayData> data,
+    LedgerRange const& range, OnFailureCallback cb)
     : BasicWork(app,
                 "apply-ledgers-" + fmt::format(FMT_STRING("{}-{}"),
                                                range.mFirst, range.limit()),
                 BasicWork::RETRY_NEVER)
-    , mDownloadDir(downloadDir)
     , mLedgerRange(range)
     , mCheckpoint(
           app.getHistoryManager().checkpointContainingLedger(range.mFirst))
+    , mData(data)
     , mOnFailure(cb)
 {
+    releaseAssert(mData);
     // Ledger range check to enforce application of a single checkpoint
     auto const& hm = mApp.getHistoryManager();
     auto low = hm.firstLedgerInCheckpointContaining(mCheckpoint);
@@ -65,37 +181,94 @@ ApplyCheckpointWork::getStatus() const
 }
 
 void
-ApplyCheckpointWork::closeFiles()
+ApplyCheckpointWork::closeInput()
 {
-    mHdrIn.close();
-    mTxIn.close();
-    mFilesOpen = false;
+    // Release the memory held by the checkpoint as soon as it's applied
+    *mData = CheckpointReplayData();
+    mInputOpen = false;
 }
 
 void
 ApplyCheckpointWork::onReset()
 {
+    // Entries are moved out of mData as they are consumed: restarting this
+    // work requires running its `ReadCheckpointWork` again first.
     mConditionalWork.reset();
-    closeFiles();
+    mInputOpen = false;
 }
 
 void
-ApplyCheckpointWork::openInputFiles()
+ApplyCheckpointWork::openInput()
 {
     ZoneScoped;
-    mHdrIn.close();
-    mTxIn.close();
-    FileTransferInfo hi(mDownloadDir, HISTORY_FILE_TYPE_LEDGER, mCheckpoint);
-    FileTransferInfo ti(mDownloadDir, HISTORY_FILE_TYPE_TRANSACTIONS,
-                        mCheckpoint);
-    CLOG_DEBUG(History, "Replaying ledger headers from {}",
-               hi.localPath_nogz());
-    CLOG_DEBUG(History, "Replaying transactions from {}", ti.localPath_nogz());
-    mHdrIn.open(hi.localPath_nogz());
-    mTxIn.open(ti.localPath_nogz());
-    mTxHistoryEntry = TransactionHistoryEntry();
+    CLOG_DEBUG(History,
+               "Replaying {} ledger headers and {} txsets of checkpoint {}",
+               mData->mHeaders.size(), mData->mTxSets.size(), mCheckpoint);
+    mNextHeader = 0;
+    mNextTxSet = 0;
+    mNextTxSetToVerify = 0;
+    mTxHistoryEntry = std::make_shared<TransactionHistoryEntry const>();
     mHeaderHistoryEntry = LedgerHeaderHistoryEntry();
-    mFilesOpen = true;
+    mInputOpen = true;
+}
+
+bool
+ApplyCheckpointWork::readNextHeader()
+{
+    if (mNextHeader == mData->mHeaders.size())
+    {
+        return false;
+    }
+    mHeaderHistoryEntry = std::move(mData->mHeaders[mNextHeader++]);
+    return true;
+}
+
+bool
+ApplyCheckpointWork::readNextTxSet()
+{
+    if (mNextTxSet == mData->mTxSets.size())
+    {
+        return false;
+    }
+    mTxHistoryEntry = std::move(mData->mTxSets[mNextTxSet++]);
+    return true;
+}
+
+void
+ApplyCheckpointWork::verifySignaturesAhead(uint32_t nextLedger)
+{
+    ZoneScoped;
+    mNextTxSetToVerify = std::max(mNextTxSetToVerify, mNextTxSet);
+    auto const& txSets = mData->mTxSets;
+    for (; mNextTxSetToVerify < txSets.size(); ++mNextTxSetToVerify)
+    {
+        auto const& txSet = txSets[mNextTxSetToVerify];
+        if (txSet->ledgerSeq >= nextLedger + REPLAY_LOOKAHEAD_LEDGERS)
+        {
+            break;
+        }
+        if (txSet->ledgerSeq < nextLedger)
+        {
+            // Skipped, already applied
+            continue;
+        }
+        mApp.postOnBackgroundThread(
+            [networkID = mApp.getNetworkID(), txSet]() {
+                try
+                {
+                    verifyTxSetSignatures(networkID, *txSet);
+                }
+                catch (std::exception const& e)
+                {
+                    // Not validated yet: application will reject it
+                    CLOG_DEBUG(History,
+                               "Could not verify signatures ahead for "
+                               "ledger {}: {}",
+                               txSet->ledgerSeq, e.what());
+                }
+            },
+            "verify-signatures-ahead");
+    }
 }
 
 TxSetFrameConstPtr
@@ -111,30 +284,30 @@ ApplyCheckpointWork::getCurrentTxSet()
     // sets, as those are not uploaded).
     do
     {
-        if (mTxHistoryEntry.ledgerSeq < seq)
+        if (mTxHistoryEntry->ledgerSeq < seq)
         {
             CLOG_DEBUG(History, "Skipping txset for ledger {}",
-                       mTxHistoryEntry.ledgerSeq);
+                       mTxHistoryEntry->ledgerSeq);
         }
-        else if (mTxHistoryEntry.ledgerSeq > seq)
+        else if (mTxHistoryEntry->ledgerSeq > seq)
         {
             break;
         }
         else
         {
-            releaseAssert(mTxHistoryEntry.ledgerSeq == seq);
+            releaseAssert(mTxHistoryEntry->ledgerSeq == seq);
             CLOG_DEBUG(History, "Loaded txset for ledger {}", seq);
-            if (mTxHistoryEntry.ext.v() == 0)
+            if (mTxHistoryEntry->ext.v() == 0)
             {
-                return TxSetFrame::makeFromWire(mApp, mTxHistoryEntry.txSet);
+                return TxSetFrame::makeFromWire(mApp, mTxHistoryEntry->txSet);
             }
             else
             {
                 return TxSetFrame::makeFromWire(
-                    mApp, mTxHistoryEntry.ext.generalizedTxSet());
+                    mApp, mTxHistoryEntry->ext.generalizedTxSet());
             }
         }
-    } while (mTxIn && mTxIn.readOne(mTxHistoryEntry));
+    } while (readNextTxSet());
 
     CLOG_DEBUG(History, "Using empty txset for ledger {}", seq);
     return TxSetFrame::makeEmpty(lm.getLastClosedLedgerHeader());
@@ -144,7 +317,7 @@ std::shared_ptr<LedgerCloseData>
 ApplyCheckpointWork::getNextLedgerCloseData()
 {
     ZoneScoped;
-    if (!mHdrIn || !mHdrIn.readOne(mHeaderHistoryEntry))
+    if (!readNextHeader())
     {
         throw std::runtime_error("No more ledgers to replay!");
     }
@@ -293,15 +466,17 @@ ApplyCheckpointWork::onRun()
 
     if (done)
     {
-        closeFiles();
+        closeInput();
         return State::WORK_SUCCESS;
     }
 
-    if (!mFilesOpen)
+    if (!mInputOpen)
     {
-        openInputFiles();
+        openInput();
     }
 
+    verifySignaturesAhead(lm.getLastClosedLedgerNum() + 1);
+
     auto lcd = getNextLedgerCloseData();
     if (!lcd)
     {
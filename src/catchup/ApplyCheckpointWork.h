@@ -4,11 +4,11 @@
 
 #pragma once
 
+#include "catchup/ReadCheckpointWork.h"
 #include "herder/LedgerCloseData.h"
 #include "herder/TxSetFrame.h"
 #include "history/HistoryArchive.h"
 #include "ledger/LedgerRange.h"
-#include "util/XDRStream.h"
 #include "work/ConditionalWork.h"
 #include "work/Work.h"
 #include "xdr/Stellar-SCP.h"
@@ -17,54 +17,63 @@
 namespace stellar
 {
 
-class TmpDir;
 struct LedgerHeaderHistoryEntry;
 
 /**
- * This class is responsible for applying transactions stored in files on
- * temporary directory (downloadDir) to local ledger. It requires two sets of
- * files - ledgers and transactions - int .xdr format. Transaction files are
- * used to read transactions that will be used and ledger files are used to
- * check if ledger hashes are matching.
+ * This class is responsible for applying transactions of a checkpoint to local
+ * ledger. It consumes the ledger headers and transaction sets decoded from the
+ * history files by a `ReadCheckpointWork` that must have succeeded before this
+ * work runs. Transaction sets are the ones that will be applied and ledger
+ * headers are used to check if ledger hashes are matching.
  *
  * In each run it skips or applies transactions from one ledger. Skipping occurs
  * when ledger to be applied is older than LCL from local ledger. At LCL
  * boundary checks are made to confirm that ledgers from files knit up with
  * LCL. If everything is OK, an apply ledger operation is performed. Then
  * another check is made - if new local ledger matches corresponding ledger from
- * file.
+ * file. Meanwhile, the signatures of the next few ledgers' transactions are
+ * verified on background threads, filling the signature verification cache.
  *
  * Constructor of this class takes some important parameters:
- * * downloadDir - directory containing ledger and transaction files
+ * * data - decoded ledger headers and transaction sets of the checkpoint
  * * range - LedgerRange to apply, must be checkpoint-aligned,
  * and cover at most one checkpoint.
  */
 
 class ApplyCheckpointWork : public BasicWork
 {
-    TmpDir const& mDownloadDir;
     LedgerRange const mLedgerRange;
     uint32_t const mCheckpoint;
 
-    XDRInputFileStream mHdrIn;
-    XDRInputFileStream mTxIn;
-    TransactionHistoryEntry mTxHistoryEntry;
+    std::shared_ptr<CheckpointReplayData> mData;
+    size_t mNextHeader{0};
+    size_t mNextTxSet{0};
+    size_t mNextTxSetToVerify{0};
+    std::shared_ptr<TransactionHistoryEntry const> mTxHistoryEntry;
     LedgerHeaderHistoryEntry mHeaderHistoryEntry;
     OnFailureCallback mOnFailure;
 
-    bool mFilesOpen{false};
+    bool mInputOpen{false};
 
     std::shared_ptr<ConditionalWork> mConditionalWork;
 
     TxSetFrameConstPtr getCurrentTxSet();
-    void openInputFiles();
+    void openInput();
+    bool readNextHeader();
+    bool readNextTxSet();
+    void verifySignaturesAhead(uint32_t nextLedger);
 
     std::shared_ptr<LedgerCloseData> getNextLedgerCloseData();
 
-    void closeFiles();
+    void closeInput();
 
   public:
-    ApplyCheckpointWork(Application& app, TmpDir const& downloadDir,
+    // Signatures of the transactions of this many ledgers ahead of the one
+    // being applied are verified in the background.
+    static uint32_t const REPLAY_LOOKAHEAD_LEDGERS;
+
+    ApplyCheckpointWork(Application& app,
+                        std::shared_ptr<CheckpointReplayData> data,
                         LedgerRange const& range, OnFailureCallback cb);
     ~ApplyCheckpointWork() = default;
     std::string getStatus() const override;
@@ -40,7 +40,7 @@ static std::shared_ptr<LedgerHeaderHistoryEntry>
 getHistoryEntryForLedger(uint32_t ledgerSeq, FileTransferInfo const& ft)
 {
     XDRInputFileStream in;
-    in.open(ft.localPath_nogz());
+    in.open(ft.localPath_gz());
 
     auto lhhe = std::make_shared<LedgerHeaderHistoryEntry>();
 
@@ -6,6 +6,7 @@
 #include "bucket/BucketList.h"
 #include "bucket/BucketManager.h"
 #include "catchup/ApplyCheckpointWork.h"
+#include "catchup/ReadCheckpointWork.h"
 #include "history/FileTransferInfo.h"
 #include "history/HistoryManager.h"
 #include "historywork/GetAndUnzipRemoteFileWork.h"
@@ -20,6 +21,8 @@
 namespace stellar
 {
 
+uint32_t const DownloadApplyTxsWork::MAX_CHECKPOINTS_READ_AHEAD = 4;
+
 DownloadApplyTxsWork::DownloadApplyTxsWork(
     Application& app, TmpDir const& downloadDir, LedgerRange const& range,
     LedgerHeaderHistoryEntry& lastApplied, bool waitForPublish,
@@ -44,8 +47,7 @@ DownloadApplyTxsWork::yieldMoreWork()
         throw std::runtime_error("Work has no more children to iterate over!");
     }
 
-    CLOG_INFO(History,
-              "Downloading, unzipping and applying {} for checkpoint {}",
+    CLOG_INFO(History, "Downloading, reading and applying {} for checkpoint {}",
               HISTORY_FILE_TYPE_TRANSACTIONS, mCheckpointToQueue);
     FileTransferInfo ft(mDownloadDir, HISTORY_FILE_TYPE_TRANSACTIONS,
                         mCheckpointToQueue);
@@ -75,10 +77,27 @@ DownloadApplyTxsWork::yieldMoreWork()
         }
     };
 
+    // Checkpoints are decoded in the background as soon as they're
+    // downloaded, while earlier ones are being applied, but only a few
+    // checkpoints ahead of the one being applied.
+    auto data = std::make_shared<CheckpointReplayData>();
+    auto read = std::make_shared<ReadCheckpointWork>(mApp, mDownloadDir,
+                                                     checkpoint, data);
+    auto readAhead = [checkpoint](Application& app) {
+        auto const& hm = app.getHistoryManager();
+        auto applying = hm.checkpointContainingLedger(
+            app.getLedgerManager().getLastClosedLedgerNum() + 1);
+        return checkpoint <= applying + MAX_CHECKPOINTS_READ_AHEAD *
+                                            hm.getCheckpointFrequency();
+    };
+
     auto apply = std::make_shared<ApplyCheckpointWork>(
-        mApp, mDownloadDir, LedgerRange::inclusive(low, high), cb);
+        mApp, data, LedgerRange::inclusive(low, high), cb);
 
-    std::vector<std::shared_ptr<BasicWork>> seq{getAndUnzip};
+    std::vector<std::shared_ptr<BasicWork>> seq{
+        getAndUnzip, std::make_shared<ConditionalWork>(
+                         mApp, "read-ahead-" + read->getName(), readAhead,
+                         read)};
 
     auto maybeWaitForMerges = [](Application& app) {
         if (app.getConfig().CATCHUP_WAIT_MERGES_TX_APPLY_FOR_TESTING)
@@ -144,15 +163,15 @@ DownloadApplyTxsWork::yieldMoreWork()
             try
             {
                 std::filesystem::remove(
-                    std::filesystem::path(ft.localPath_nogz()));
+                    std::filesystem::path(ft.localPath_gz()));
                 CLOG_DEBUG(History, "Deleted transactions {}",
-                           ft.localPath_nogz());
+                           ft.localPath_gz());
                 return true;
             }
             catch (std::filesystem::filesystem_error const& e)
             {
                 CLOG_ERROR(History, "Could not delete transactions {}: {}",
-                           ft.localPath_nogz(), e.what());
+                           ft.localPath_gz(), e.what());
                 return false;
             }
         }));
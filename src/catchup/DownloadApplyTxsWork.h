@@ -32,6 +32,11 @@ class DownloadApplyTxsWork : public BatchWork
     std::shared_ptr<HistoryArchive> mArchive;
 
   public:
+    // Decode at most this many checkpoints ahead of the one being applied,
+    // bounding the memory used by decoded checkpoints. Downloads still run
+    // ahead up to MAX_CONCURRENT_SUBPROCESSES checkpoints.
+    static uint32_t const MAX_CHECKPOINTS_READ_AHEAD;
+
     DownloadApplyTxsWork(Application& app, TmpDir const& downloadDir,
                          LedgerRange const& range,
                          LedgerHeaderHistoryEntry& lastApplied,
@@ -0,0 +1,71 @@
+// Copyright 2023 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "catchup/ReadCheckpointWork.h"
+#include "history/FileTransferInfo.h"
+#include "util/GlobalChecks.h"
+#include "util/XDRStream.h"
+#include <Tracy.hpp>
+#include <type_traits>
+
+namespace stellar
+{
+
+namespace
+{
+template <typename T, typename Out>
+void
+readAll(std::string const& filename, std::vector<Out>& out)
+{
+    ZoneScoped;
+    XDRInputFileStream in;
+    in.open(filename);
+    T entry;
+    while (in && in.readOne(entry))
+    {
+        if constexpr (std::is_same_v<Out, T>)
+        {
+            out.emplace_back(std::move(entry));
+        }
+        else
+        {
+            out.emplace_back(std::make_shared<T const>(std::move(entry)));
+        }
+    }
+}
+}
+
+ReadCheckpointWork::ReadCheckpointWork(
+    Application& app, TmpDir const& downloadDir, uint32_t checkpoint,
+    std::shared_ptr<CheckpointReplayData> data)
+    : RunInBackgroundWork(app, "read-checkpoint-" + std::to_string(checkpoint),
+                          BasicWork::RETRY_NEVER)
+    , mLedgerFile(FileTransferInfo(downloadDir, HISTORY_FILE_TYPE_LEDGER,
+                                   checkpoint)
+                      .localPath_gz())
+    , mTxFile(FileTransferInfo(downloadDir, HISTORY_FILE_TYPE_TRANSACTIONS,
+                               checkpoint)
+                  .localPath_gz())
+    , mData(data)
+{
+    releaseAssert(mData);
+}
+
+std::function<void()>
+ReadCheckpointWork::getTask()
+{
+    // The data is only accessed by the main thread once the task is done
+    return [ledgerFile = mLedgerFile, txFile = mTxFile, data = mData]() {
+        readAll<LedgerHeaderHistoryEntry>(ledgerFile, data->mHeaders);
+        readAll<TransactionHistoryEntry>(txFile, data->mTxSets);
+    };
+}
+
+void
+ReadCheckpointWork::onReset()
+{
+    *mData = CheckpointReplayData();
+    RunInBackgroundWork::onReset();
+}
+}
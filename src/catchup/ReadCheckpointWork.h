@@ -0,0 +1,47 @@
+// Copyright 2023 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#pragma once
+
+#include "historywork/RunInBackgroundWork.h"
+#include "xdr/Stellar-ledger.h"
+#include <memory>
+#include <vector>
+
+namespace stellar
+{
+
+class TmpDir;
+
+// Ledger headers and transaction sets of one checkpoint, decoded from the
+// downloaded history files and consumed by `ApplyCheckpointWork`. Transaction
+// sets are shared with the tasks preparing them ahead of their application.
+struct CheckpointReplayData
+{
+    std::vector<LedgerHeaderHistoryEntry> mHeaders;
+    std::vector<std::shared_ptr<TransactionHistoryEntry const>> mTxSets;
+};
+
+/**
+ * Reads and decodes the (compressed) ledger and transactions files of a
+ * checkpoint on a background thread, so that the application of the
+ * checkpoint doesn't wait on I/O and XDR decoding on the main thread.
+ */
+class ReadCheckpointWork : public RunInBackgroundWork
+{
+    std::string const mLedgerFile;
+    std::string const mTxFile;
+    std::shared_ptr<CheckpointReplayData> mData;
+    std::function<void()> getTask() override;
+
+  public:
+    ReadCheckpointWork(Application& app, TmpDir const& downloadDir,
+                       uint32_t checkpoint,
+                       std::shared_ptr<CheckpointReplayData> data);
+    ~ReadCheckpointWork() = default;
+
+  protected:
+    void onReset() override;
+};
+}
@@ -145,7 +145,7 @@ VerifyLedgerChainWork::verifyHistoryOfSingleCheckpoint()
     FileTransferInfo ft(mDownloadDir, HISTORY_FILE_TYPE_LEDGER,
                         mCurrCheckpoint);
     XDRInputFileStream hdrIn;
-    hdrIn.open(ft.localPath_nogz());
+    hdrIn.open(ft.localPath_gz());
 
     bool beginCheckpoint = true;
 
@@ -159,7 +159,7 @@ VerifyLedgerChainWork::verifyHistoryOfSingleCheckpoint()
     LedgerHeaderHistoryEntry prev;
 
     CLOG_DEBUG(History, "Verifying ledger headers from {} for checkpoint {}",
-               ft.localPath_nogz(), mCurrCheckpoint);
+               ft.localPath_gz(), mCurrCheckpoint);
 
     while (hdrIn)
     {
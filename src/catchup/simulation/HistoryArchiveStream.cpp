@@ -53,7 +53,7 @@ HistoryArchiveStream::readHeaderHistory(uint32_t ledgerSeq)
             mDownloadDir, HISTORY_FILE_TYPE_LEDGER,
             mHistoryManager.checkpointContainingLedger(ledgerSeq));
         mHeaderStream.close();
-        mHeaderStream.open(info.localPath_nogz());
+        mHeaderStream.open(info.localPath_gz());
     }
 
     if (!(mHeaderStream && mHeaderStream.readOne(lhhe)))
@@ -119,7 +119,7 @@ HistoryArchiveStream::readTransactionHistory()
             mDownloadDir, HISTORY_FILE_TYPE_TRANSACTIONS,
             mHistoryManager.checkpointContainingLedger(ledgerSeq));
         mTransactionStream.close();
-        mTransactionStream.open(info.localPath_nogz());
+        mTransactionStream.open(info.localPath_gz());
     }
 
     if (mTransactionHistory.ledgerSeq < ledgerSeq && mTransactionStream &&
@@ -193,7 +193,7 @@ HistoryArchiveStream::readResultHistory()
             mDownloadDir, HISTORY_FILE_TYPE_RESULTS,
             mHistoryManager.checkpointContainingLedger(ledgerSeq));
         mResultStream.close();
-        mResultStream.open(info.localPath_nogz());
+        mResultStream.open(info.localPath_gz());
     }
 
     if (mResultHistory.ledgerSeq < ledgerSeq && mResultStream &&
@@ -0,0 +1,122 @@
+// Copyright 2023 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "herder/CompactTxSet.h"
+#include "crypto/BLAKE2.h"
+#include "herder/Herder.h"
+#include "util/GlobalChecks.h"
+#include "util/UnorderedMap.h"
+#include "xdrpp/marshal.h"
+#include <Tracy.hpp>
+
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+namespace stellar
+{
+
+CompactTxSetShortIDs::CompactTxSetShortIDs(Hash const& txSetHash,
+                                           uint64_t salt)
+{
+    BLAKE2 hasher;
+    hasher.add(txSetHash);
+    hasher.add(xdr::xdr_to_opaque(salt));
+    auto seed = hasher.finish();
+    static_assert(sizeof(seed) >= crypto_shorthash_KEYBYTES);
+    std::copy(seed.begin(), seed.begin() + mKey.size(), mKey.begin());
+}
+
+uint64_t
+CompactTxSetShortIDs::operator()(Hash const& txFullHash) const
+{
+    uint64_t res;
+    static_assert(sizeof(res) == crypto_shorthash_BYTES);
+    crypto_shorthash(reinterpret_cast<unsigned char*>(&res),
+                     txFullHash.data(), txFullHash.size(), mKey.data());
+    return res;
+}
+
+CompactTxSetReconstructor::CompactTxSetReconstructor(
+    CompactTxSet const& compactTxSet, Herder const& herder)
+    : mCompactTxSet(compactTxSet)
+{
+    ZoneScoped;
+    CompactTxSetShortIDs shortIDs(mCompactTxSet.txSetHash,
+                                  mCompactTxSet.shortIDSalt);
+    // nullptr marks the short ids shared by several known transactions
+    UnorderedMap<uint64_t, TransactionFrameBaseConstPtr> knownTxs;
+    herder.forEachKnownTx([&](TransactionFrameBaseConstPtr const& tx) {
+        auto res = knownTxs.emplace(shortIDs(tx->getFullHash()), tx);
+        if (!res.second && res.first->second != tx)
+        {
+            res.first->second = nullptr;
+        }
+    });
+
+    for (auto const& phase : mCompactTxSet.phases)
+    {
+        for (auto const& component : phase.components)
+        {
+            for (auto const& id : component.shortTxIDs)
+            {
+                auto it = knownTxs.find(id);
+                if (it != knownTxs.end() && it->second)
+                {
+                    mTxs.emplace_back(it->second->getEnvelope());
+                }
+                else
+                {
+                    mMissingIndices.emplace_back(
+                        static_cast<uint32_t>(mTxs.size()));
+                    mTxs.emplace_back(std::nullopt);
+                }
+            }
+        }
+    }
+}
+
+bool
+CompactTxSetReconstructor::addMissingTransactions(
+    xdr::xvector<TransactionEnvelope> const& txs)
+{
+    if (txs.size() != mMissingIndices.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < txs.size(); ++i)
+    {
+        mTxs[mMissingIndices[i]] = txs[i];
+    }
+    mMissingIndices.clear();
+    return true;
+}
+
+GeneralizedTransactionSet
+CompactTxSetReconstructor::finish()
+{
+    ZoneScoped;
+    releaseAssert(isComplete());
+    GeneralizedTransactionSet res(1);
+    auto& txSet = res.v1TxSet();
+    txSet.previousLedgerHash = mCompactTxSet.previousLedgerHash;
+    size_t txIndex = 0;
+    for (auto& compactPhase : mCompactTxSet.phases)
+    {
+        auto& phase = txSet.phases.emplace_back().v0Components();
+        for (auto& compactComponent : compactPhase.components)
+        {
+            phase.emplace_back(TXSET_COMP_TXS_MAYBE_DISCOUNTED_FEE);
+            auto& component = phase.back().txsMaybeDiscountedFee();
+            component.baseFee = std::move(compactComponent.baseFee);
+            component.txs.reserve(compactComponent.shortTxIDs.size());
+            for (size_t i = 0; i < compactComponent.shortTxIDs.size(); ++i)
+            {
+                component.txs.emplace_back(std::move(*mTxs[txIndex++]));
+            }
+        }
+    }
+    mTxs.clear();
+    mCompactTxSet.phases.clear();
+    return res;
+}
+}
+#endif
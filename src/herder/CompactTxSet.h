@@ -0,0 +1,84 @@
+#pragma once
+
+// Copyright 2023 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "xdr/Stellar-overlay.h"
+#include <array>
+#include <optional>
+#include <sodium.h>
+#include <vector>
+
+// The compact tx set messages are only defined in the current protocol XDR for
+// now, so the compact tx set relay isn't available with the next one.
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+namespace stellar
+{
+
+class Herder;
+
+// Computes the short ids used to announce transactions in a `CompactTxSet`.
+// The ids are SipHash-2-4 of the full transaction hashes, keyed with both the
+// tx set hash and a salt chosen by the sender, so that colliding transactions
+// can't be crafted before the tx set is announced.
+class CompactTxSetShortIDs
+{
+  public:
+    CompactTxSetShortIDs(Hash const& txSetHash, uint64_t salt);
+
+    uint64_t operator()(Hash const& txFullHash) const;
+
+  private:
+    std::array<unsigned char, crypto_shorthash_KEYBYTES> mKey;
+};
+
+// Rebuilds the generalized tx set announced by a `CompactTxSet` from the
+// transactions known to the herder. The transactions that couldn't be matched
+// locally have to be fetched from the peer (see `getMissingIndices`).
+//
+// Short id collisions are not resolved here: ambiguous ids are treated as
+// missing, and any remaining mismatch is detected by the caller comparing the
+// hash of the rebuilt tx set with the announced one.
+class CompactTxSetReconstructor
+{
+  public:
+    CompactTxSetReconstructor(CompactTxSet const& compactTxSet,
+                              Herder const& herder);
+
+    Hash const&
+    getTxSetHash() const
+    {
+        return mCompactTxSet.txSetHash;
+    }
+
+    // Positions of the transactions that have to be fetched, counted across
+    // all the components of all the phases.
+    std::vector<uint32_t> const&
+    getMissingIndices() const
+    {
+        return mMissingIndices;
+    }
+
+    // Fills in the transactions fetched for `getMissingIndices`. Returns false
+    // if `txs` doesn't match the requested transactions.
+    bool addMissingTransactions(xdr::xvector<TransactionEnvelope> const& txs);
+
+    bool
+    isComplete() const
+    {
+        return mMissingIndices.empty();
+    }
+
+    // Builds the tx set XDR. Must only be called once the reconstruction is
+    // complete, and leaves the reconstructor empty.
+    GeneralizedTransactionSet finish();
+
+  private:
+    CompactTxSet mCompactTxSet;
+    std::vector<std::optional<TransactionEnvelope>> mTxs;
+    std::vector<uint32_t> mMissingIndices;
+};
+
+}
+#endif
@@ -71,6 +71,14 @@ class Herder
 
     static std::chrono::minutes const TX_SET_GC_DELAY;
 
+    // Parameters of the transaction queues: how many ledgers transactions
+    // stay pending and banned for, and the queue capacity as a multiple of
+    // the maximum transaction set size.
+    static uint32 constexpr TRANSACTION_QUEUE_TIMEOUT_LEDGERS = 4;
+    static uint32 constexpr TRANSACTION_QUEUE_BAN_LEDGERS = 10;
+    static uint32 constexpr TRANSACTION_QUEUE_SIZE_MULTIPLIER = 2;
+    static uint32 constexpr SOROBAN_TRANSACTION_QUEUE_SIZE_MULTIPLIER = 2;
+
     enum State
     {
         // Starting up, no state is known
@@ -123,7 +131,8 @@ class Herder
     virtual bool recvTxSet(Hash const& hash, TxSetFrameConstPtr txset) = 0;
     // We are learning about a new transaction.
     virtual TransactionQueue::AddResult
-    recvTransaction(TransactionFrameBasePtr tx, bool submittedFromSelf) = 0;
+    recvTransaction(TransactionFrameBasePtr const& tx,
+                    bool submittedFromSelf) = 0;
     virtual void peerDoesntHave(stellar::MessageType type,
                                 uint256 const& itemID, Peer::pointer peer) = 0;
     virtual TxSetFrameConstPtr getTxSet(Hash const& hash) = 0;
@@ -132,6 +141,16 @@ class Herder
     // We are learning about a new envelope.
     virtual EnvelopeStatus recvSCPEnvelope(SCPEnvelope const& envelope) = 0;
 
+    // Same as `recvSCPEnvelope`, but the signature of the envelope may be
+    // verified on a background thread (see
+    // BACKGROUND_SCP_SIGNATURE_VERIFICATION). `onDone` is invoked on the main
+    // thread with the status of the envelope, once it is processed. Envelopes
+    // are processed as soon as their signature is verified, which is not
+    // necessarily in the order they were received.
+    virtual void
+    recvSCPEnvelopeAsync(SCPEnvelope const& envelope,
+                         std::function<void(EnvelopeStatus)> onDone) = 0;
+
     virtual bool isTracking() const = 0;
 
 #ifdef BUILD_TESTS
@@ -214,5 +233,10 @@ class Herder
 #endif
     virtual bool isBannedTx(Hash const& hash) const = 0;
     virtual TransactionFrameBaseConstPtr getTx(Hash const& hash) const = 0;
+    // Calls `f` for every transaction currently held in the transaction
+    // queues.
+    virtual void forEachKnownTx(
+        std::function<void(TransactionFrameBaseConstPtr const&)> const& f)
+        const = 0;
 };
 }
@@ -33,6 +33,7 @@
 #include "medida/counter.h"
 #include "medida/meter.h"
 #include "medida/metrics_registry.h"
+#include "medida/timer.h"
 #include "util/Decoder.h"
 #include "util/XDRStream.h"
 #include "xdr/Stellar-internal.h"
@@ -48,11 +49,6 @@ using namespace std;
 namespace stellar
 {
 
-constexpr uint32 const TRANSACTION_QUEUE_TIMEOUT_LEDGERS = 4;
-constexpr uint32 const TRANSACTION_QUEUE_BAN_LEDGERS = 10;
-constexpr uint32 const TRANSACTION_QUEUE_SIZE_MULTIPLIER = 2;
-constexpr uint32 const SOROBAN_TRANSACTION_QUEUE_SIZE_MULTIPLIER = 2;
-
 std::unique_ptr<Herder>
 Herder::create(Application& app)
 {
@@ -71,6 +67,8 @@ HerderImpl::SCPMetrics::SCPMetrics(Application& app)
           {"scp", "envelope", "validsig"}, "envelope"))
     , mEnvelopeInvalidSig(app.getMetrics().NewMeter(
           {"scp", "envelope", "invalidsig"}, "envelope"))
+    , mEnvelopeVerifyQueueDelay(
+          app.getMetrics().NewTimer({"scp", "envelope", "verify-delay"}))
 {
 }
 
@@ -100,6 +98,11 @@ HerderImpl::HerderImpl(Application& app)
 
     mPendingEnvelopes.addSCPQuorumSet(ln->getQuorumSetHash(),
                                       ln->getQuorumSet());
+
+    if (app.getConfig().BACKGROUND_SCP_SIGNATURE_VERIFICATION)
+    {
+        mSignatureVerifier = std::make_unique<OverlayThreadPool>(1);
+    }
 }
 
 HerderImpl::~HerderImpl()
@@ -234,7 +237,7 @@ HerderImpl::newSlotExternalized(bool synchronous, StellarValue const& value)
     {
         eraseBelow(minSlotToRemember);
     }
-    mPendingEnvelopes.forceRebuildQuorum();
+    mPendingEnvelopes.refreshQuorum();
 
     // Process new ready messages for the next slot
     safelyProcessSCPQueue(synchronous);
@@ -259,6 +262,11 @@ HerderImpl::shutdown()
     mSorobanTransactionQueue.shutdown();
 #endif
     mTxSetGarbageCollectTimer.cancel();
+    if (mSignatureVerifier)
+    {
+        mSignatureVerifier->shutdown();
+    }
+    mPendingSignatureChecks.clear();
 }
 
 void
@@ -454,7 +462,8 @@ HerderImpl::emitEnvelope(SCPEnvelope const& envelope)
 }
 
 TransactionQueue::AddResult
-HerderImpl::recvTransaction(TransactionFrameBasePtr tx, bool submittedFromSelf)
+HerderImpl::recvTransaction(TransactionFrameBasePtr const& tx,
+                            bool submittedFromSelf)
 {
     ZoneScoped;
 #ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
@@ -631,8 +640,101 @@ HerderImpl::recvSCPEnvelope(SCPEnvelope const& envelope)
     mSCPMetrics.mEnvelopeReceive.Mark();
 
     // **** first perform checks that do NOT require signature verification
-    // this allows to fast fail messages that we'd throw away anyways
+    if (!checkEnvelopeBeforeSignature(envelope))
+    {
+        return Herder::ENVELOPE_STATUS_DISCARDED;
+    }
+
+    // **** from this point, we have to check signatures
+    if (!verifyEnvelope(envelope))
+    {
+        std::string txt("DISCARDED - bad envelope");
+        ZoneText(txt.c_str(), txt.size());
+        CLOG_TRACE(Herder, "Received bad envelope, discarding");
+        return Herder::ENVELOPE_STATUS_DISCARDED;
+    }
+
+    return recvVerifiedSCPEnvelope(envelope);
+}
+
+void
+HerderImpl::recvSCPEnvelopeAsync(SCPEnvelope const& envelope,
+                                 std::function<void(EnvelopeStatus)> onDone)
+{
+    ZoneScoped;
+    if (!mSignatureVerifier || mApp.getConfig().MANUAL_CLOSE ||
+        mPendingSignatureChecks.size() >= mMaxPendingSignatureChecks)
+    {
+        onDone(recvSCPEnvelope(envelope));
+        return;
+    }
+
+    mSCPMetrics.mEnvelopeReceive.Mark();
+    if (!checkEnvelopeBeforeSignature(envelope))
+    {
+        onDone(Herder::ENVELOPE_STATUS_DISCARDED);
+        return;
+    }
+
+    auto check = std::make_shared<PendingSignatureCheck>(PendingSignatureCheck{
+        envelope, std::move(onDone), mApp.getClock().now()});
+    mPendingSignatureChecks.emplace(check);
+
+    // SCP doesn't depend on the order envelopes are received in, which the
+    // network doesn't guarantee anyway, so each envelope is processed as soon
+    // as its signature is verified.
+    std::weak_ptr<PendingSignatureCheck> weak = check;
+    auto payload = std::make_shared<std::vector<uint8_t>>(xdr::xdr_to_opaque(
+        mApp.getNetworkID(), ENVELOPE_TYPE_SCP, envelope.statement));
+    mSignatureVerifier->post(
+        0, [this, &app = mApp, weak, payload,
+            nodeID = envelope.statement.nodeID, sig = envelope.signature]() {
+            bool valid = PubKeyUtils::verifySig(nodeID, sig, *payload);
+            app.postOnMainThread(
+                [this, weak, valid]() {
+                    // checks are only owned by the herder, and dropped on
+                    // shutdown
+                    auto check = weak.lock();
+                    if (!check)
+                    {
+                        return;
+                    }
+                    mPendingSignatureChecks.erase(check);
+                    processVerifiedSCPEnvelope(*check, valid);
+                },
+                "HerderImpl: verified SCP envelope");
+        });
+}
 
+void
+HerderImpl::processVerifiedSCPEnvelope(PendingSignatureCheck& check,
+                                       bool valid)
+{
+    ZoneScoped;
+    mSCPMetrics.mEnvelopeVerifyQueueDelay.Update(mApp.getClock().now() -
+                                                 check.mReceivedAt);
+    auto status = Herder::ENVELOPE_STATUS_DISCARDED;
+    if (!valid)
+    {
+        mSCPMetrics.mEnvelopeInvalidSig.Mark();
+        CLOG_TRACE(Herder, "Received bad envelope, discarding");
+    }
+    else
+    {
+        mSCPMetrics.mEnvelopeValidSig.Mark();
+        // the state may have changed while the signature was being verified
+        // (e.g. a ledger closed), so check the envelope again
+        if (checkEnvelopeBeforeSignature(check.mEnvelope))
+        {
+            status = recvVerifiedSCPEnvelope(check.mEnvelope);
+        }
+    }
+    check.mOnDone(status);
+}
+
+bool
+HerderImpl::checkEnvelopeBeforeSignature(SCPEnvelope const& envelope)
+{
     uint32_t minLedgerSeq = getMinLedgerSeqToRemember();
     uint32_t maxLedgerSeq = std::numeric_limits<uint32>::max();
 
@@ -646,7 +748,7 @@ HerderImpl::recvSCPEnvelope(SCPEnvelope const& envelope)
             "skipping invalid close time (incompatible with current state)");
         std::string txt("DISCARDED - incompatible close time");
         ZoneText(txt.c_str(), txt.size());
-        return Herder::ENVELOPE_STATUS_DISCARDED;
+        return false;
     }
 
     auto checkpoint = getMostRecentCheckpointSeq();
@@ -676,7 +778,7 @@ HerderImpl::recvSCPEnvelope(SCPEnvelope const& envelope)
                            "(check MAXIMUM_LEDGER_CLOSETIME_DRIFT)");
         std::string txt("DISCARDED - invalid close time");
         ZoneText(txt.c_str(), txt.size());
-        return Herder::ENVELOPE_STATUS_DISCARDED;
+        return false;
     }
 
     // If envelopes are out of our validity brackets, or if envelope does not
@@ -687,18 +789,15 @@ HerderImpl::recvSCPEnvelope(SCPEnvelope const& envelope)
                    envelope.statement.slotIndex, minLedgerSeq, maxLedgerSeq);
         std::string txt("DISCARDED - out of range");
         ZoneText(txt.c_str(), txt.size());
-        return Herder::ENVELOPE_STATUS_DISCARDED;
+        return false;
     }
 
-    // **** from this point, we have to check signatures
-    if (!verifyEnvelope(envelope))
-    {
-        std::string txt("DISCARDED - bad envelope");
-        ZoneText(txt.c_str(), txt.size());
-        CLOG_TRACE(Herder, "Received bad envelope, discarding");
-        return Herder::ENVELOPE_STATUS_DISCARDED;
-    }
+    return true;
+}
 
+Herder::EnvelopeStatus
+HerderImpl::recvVerifiedSCPEnvelope(SCPEnvelope const& envelope)
+{
     if (envelope.statement.nodeID == getSCP().getLocalNode()->getNodeID())
     {
         CLOG_TRACE(Herder, "recvSCPEnvelope: skipping own message");
@@ -1697,12 +1796,17 @@ HerderImpl::checkAndMaybeReanalyzeQuorumMap()
         mLastQuorumMapIntersectionState.mCheckingQuorumMapHash = curr;
         auto& cfg = mApp.getConfig();
         auto qic = QuorumIntersectionChecker::create(
-            qmap, cfg, mLastQuorumMapIntersectionState.mInterruptFlag);
+            qmap, cfg, mLastQuorumMapIntersectionState.mInterruptFlag,
+            gRandomEngine(), /*quiet=*/false,
+            mLastQuorumMapIntersectionState.mSearchCache);
+        // The worker can't use gRandomEngine, draw its seed here.
+        auto seed = gRandomEngine();
         auto ledger = trackingConsensusLedgerIndex();
         auto nNodes = qmap.size();
         auto& hState = mLastQuorumMapIntersectionState;
         auto& app = mApp;
-        auto worker = [curr, ledger, nNodes, qic, qmap, cfg, &app, &hState] {
+        auto worker = [curr, ledger, nNodes, qic, qmap, cfg, seed, &app,
+                       &hState] {
             try
             {
                 ZoneScoped;
@@ -1715,8 +1819,8 @@ HerderImpl::checkAndMaybeReanalyzeQuorumMap()
                     // intersecting; if not intersecting we should finish ASAP
                     // and raise an alarm.
                     critical = QuorumIntersectionChecker::
-                        getIntersectionCriticalGroups(qmap, cfg,
-                                                      hState.mInterruptFlag);
+                        getIntersectionCriticalGroups(
+                            qmap, cfg, hState.mInterruptFlag, seed);
                 }
                 app.postOnMainThread(
                     [ok, curr, ledger, nNodes, split, critical, &hState] {
@@ -2209,4 +2313,14 @@ HerderImpl::getTx(Hash const& hash) const
     return classic;
 }
 
+void
+HerderImpl::forEachKnownTx(
+    std::function<void(TransactionFrameBaseConstPtr const&)> const& f) const
+{
+    mTransactionQueue.forEachKnownTx(f);
+#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    mSorobanTransactionQueue.forEachKnownTx(f);
+#endif
+}
+
 }
@@ -7,13 +7,18 @@
 #include "herder/Herder.h"
 #include "herder/HerderSCPDriver.h"
 #include "herder/PendingEnvelopes.h"
+#include "herder/QuorumIntersectionChecker.h"
 #include "herder/TransactionQueue.h"
 #include "herder/Upgrades.h"
+#include "overlay/OverlayThreadPool.h"
 #include "util/Timer.h"
 #include "util/UnorderedMap.h"
+#include "util/UnorderedSet.h"
 #include "util/XDROperators.h"
 #include <deque>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace medida
@@ -94,10 +99,13 @@ class HerderImpl : public Herder
     void emitEnvelope(SCPEnvelope const& envelope);
 
     TransactionQueue::AddResult
-    recvTransaction(TransactionFrameBasePtr tx,
+    recvTransaction(TransactionFrameBasePtr const& tx,
                     bool submittedFromSelf) override;
 
     EnvelopeStatus recvSCPEnvelope(SCPEnvelope const& envelope) override;
+    void
+    recvSCPEnvelopeAsync(SCPEnvelope const& envelope,
+                         std::function<void(EnvelopeStatus)> onDone) override;
 #ifdef BUILD_TESTS
     EnvelopeStatus recvSCPEnvelope(SCPEnvelope const& envelope,
                                    const SCPQuorumSet& qset,
@@ -175,6 +183,17 @@ class HerderImpl : public Herder
     SorobanTransactionQueue& getSorobanTransactionQueue() override;
 #endif
     bool sourceAccountPending(AccountID const& accountID) const override;
+
+    OverlayThreadPool*
+    getSignatureVerifierForTesting()
+    {
+        return mSignatureVerifier.get();
+    }
+    void
+    setMaxPendingSignatureChecksForTesting(size_t maxPending)
+    {
+        mMaxPendingSignatureChecks = maxPending;
+    }
 #endif
 
     // helper function to verify envelopes are signed
@@ -191,6 +210,9 @@ class HerderImpl : public Herder
 #endif
     bool isBannedTx(Hash const& hash) const override;
     TransactionFrameBaseConstPtr getTx(Hash const& hash) const override;
+    void forEachKnownTx(
+        std::function<void(TransactionFrameBaseConstPtr const&)> const& f)
+        const override;
 
   private:
     // return true if values referenced by envelope have a valid close time:
@@ -198,6 +220,29 @@ class HerderImpl : public Herder
     // * it's recent enough (if `enforceRecent` is set)
     bool checkCloseTime(SCPEnvelope const& envelope, bool enforceRecent);
 
+    // checks that do NOT require signature verification, this allows to fast
+    // fail messages that we'd throw away anyways
+    bool checkEnvelopeBeforeSignature(SCPEnvelope const& envelope);
+    // processes an envelope whose signature has been verified
+    EnvelopeStatus recvVerifiedSCPEnvelope(SCPEnvelope const& envelope);
+
+    // envelopes waiting for their signature to be verified on
+    // `mSignatureVerifier`. Jobs only hold weak references to them, so that
+    // the results arriving after shutdown are ignored.
+    struct PendingSignatureCheck
+    {
+        SCPEnvelope mEnvelope;
+        std::function<void(EnvelopeStatus)> mOnDone;
+        VirtualClock::time_point mReceivedAt;
+    };
+    UnorderedSet<std::shared_ptr<PendingSignatureCheck>>
+        mPendingSignatureChecks;
+    // Past this many pending checks, envelopes are verified on the main
+    // thread, which slows down reading from peers.
+    static constexpr size_t MAX_PENDING_SIGNATURE_CHECKS = 1000;
+    size_t mMaxPendingSignatureChecks{MAX_PENDING_SIGNATURE_CHECKS};
+    void processVerifiedSCPEnvelope(PendingSignatureCheck& check, bool valid);
+
     // Given a candidate close time, determine an offset needed to make it
     // valid (at current system time). Returns 0 if ct is already valid
     std::chrono::milliseconds
@@ -278,6 +323,8 @@ class HerderImpl : public Herder
         // envelope signature verification
         medida::Meter& mEnvelopeValidSig;
         medida::Meter& mEnvelopeInvalidSig;
+        // time envelopes spend waiting for background signature verification
+        medida::Timer& mEnvelopeVerifyQueueDelay;
 
         SCPMetrics(Application& app);
     };
@@ -305,6 +352,10 @@ class HerderImpl : public Herder
         std::pair<std::vector<PublicKey>, std::vector<PublicKey>>
             mPotentialSplit{};
         std::set<std::set<PublicKey>> mIntersectionCriticalNodes{};
+        // Results of previous scans, reused when the quorum map only changes
+        // outside of the part of the network that has quorums.
+        std::shared_ptr<QuorumIntersectionChecker::SearchCache> mSearchCache{
+            std::make_shared<QuorumIntersectionChecker::SearchCache>()};
 
         bool
         hasAnyResults() const
@@ -328,5 +379,10 @@ class HerderImpl : public Herder
     // network or not (Herder::State is used to properly track the state of
     // Herder) On startup, this variable is set to LCL
     ConsensusData mTrackingSCP;
+
+    // Thread dedicated to verifying the signatures of the SCP envelopes
+    // received from peers (see BACKGROUND_SCP_SIGNATURE_VERIFICATION),
+    // declared last so that it is joined first.
+    std::unique_ptr<OverlayThreadPool> mSignatureVerifier;
 };
 }
@@ -34,6 +34,7 @@ namespace stellar
 {
 
 uint32_t const TXSETVALID_CACHE_SIZE = 1000;
+uint32_t const VALUE_CACHE_SIZE = 1000;
 
 Hash
 HerderSCPDriver::getHashOf(std::vector<xdr::opaque_vec<>> const& vals) const
@@ -52,6 +53,8 @@ HerderSCPDriver::SCPMetrics::SCPMetrics(Application& app)
     , mValueValid(app.getMetrics().NewMeter({"scp", "value", "valid"}, "value"))
     , mValueInvalid(
           app.getMetrics().NewMeter({"scp", "value", "invalid"}, "value"))
+    , mValueCacheHit(
+          app.getMetrics().NewMeter({"scp", "value", "cached"}, "value"))
     , mCombinedCandidates(app.getMetrics().NewMeter(
           {"scp", "nomination", "combinecandidates"}, "value"))
     , mNominateToPrepare(
@@ -84,6 +87,7 @@ HerderSCPDriver::HerderSCPDriver(Application& app, HerderImpl& herder,
           {"scp", "slot", "values-referenced"})}
     , mLedgerSeqNominating(0)
     , mTxSetValidCache(TXSETVALID_CACHE_SIZE)
+    , mValueCache(VALUE_CACHE_SIZE)
 {
 }
 
@@ -336,25 +340,74 @@ HerderSCPDriver::validateValueHelper(uint64_t slotIndex, StellarValue const& b,
     return res;
 }
 
-SCPDriver::ValidationLevel
-HerderSCPDriver::validateValue(uint64_t slotIndex, Value const& value,
-                               bool nomination)
+HerderSCPDriver::CachedValue
+HerderSCPDriver::getCachedValue(uint64_t slotIndex, Value const& value,
+                                ValueCacheKey& key)
 {
     ZoneScoped;
-    StellarValue b;
+    auto const& lclHash = mLedgerManager.getLastClosedLedgerHeader().hash;
+    if (mValueCacheLCLHash != lclHash)
+    {
+        mValueCache.clear();
+        mValueCacheLCLHash = lclHash;
+    }
+
+    key = ValueCacheKey{slotIndex, sha256(value)};
+    auto cached = mValueCache.maybeGet(key);
+    if (cached)
+    {
+        mSCPMetrics.mValueCacheHit.Mark();
+        return *cached;
+    }
+
+    CachedValue res;
     try
     {
         ZoneNamedN(xdrZone, "XDR deserialize", true);
-        xdr::xdr_from_opaque(value, b);
+        auto b = std::make_shared<StellarValue>();
+        xdr::xdr_from_opaque(value, *b);
+        res.mValue = b;
     }
     catch (...)
+    {
+    }
+    mValueCache.put(key, res);
+    return res;
+}
+
+SCPDriver::ValidationLevel
+HerderSCPDriver::validateValue(uint64_t slotIndex, Value const& value,
+                               bool nomination)
+{
+    ZoneScoped;
+    ValueCacheKey key;
+    auto cached = getCachedValue(slotIndex, value, key);
+    if (!cached.mValue)
     {
         mSCPMetrics.mValueInvalid.Mark();
         return SCPDriver::kInvalidValue;
     }
+    StellarValue const& b = *cached.mValue;
 
-    SCPDriver::ValidationLevel res =
-        validateValueHelper(slotIndex, b, nomination);
+    SCPDriver::ValidationLevel res;
+    if (cached.mFullyValidated)
+    {
+        res = SCPDriver::kFullyValidatedValue;
+    }
+    else
+    {
+        res = validateValueHelper(slotIndex, b, nomination);
+        if (res == SCPDriver::kFullyValidatedValue)
+        {
+            // Only values for the ledger on top of the LCL are fully
+            // validated, and they stay valid until the LCL changes.
+            cached.mFullyValidated = true;
+            mValueCache.put(key, cached);
+        }
+    }
+
+    // Upgrades are checked every time: their validity depends on whether
+    // this is for nomination, and on the time for scheduled upgrades.
     if (res != SCPDriver::kInvalidValue)
     {
         auto const& lcl = mLedgerManager.getLastClosedLedgerHeader();
@@ -403,18 +456,18 @@ ValueWrapperPtr
 HerderSCPDriver::extractValidValue(uint64_t slotIndex, Value const& value)
 {
     ZoneScoped;
-    StellarValue b;
-    try
-    {
-        xdr::xdr_from_opaque(value, b);
-    }
-    catch (...)
+    ValueCacheKey key;
+    auto cached = getCachedValue(slotIndex, value, key);
+    if (!cached.mValue)
     {
         return nullptr;
     }
+    StellarValue b = *cached.mValue;
     ValueWrapperPtr res;
-    if (validateValueHelper(slotIndex, b, true) ==
-        SCPDriver::kFullyValidatedValue)
+    bool fullyValidated = cached.mFullyValidated ||
+                          validateValueHelper(slotIndex, b, true) ==
+                              SCPDriver::kFullyValidatedValue;
+    if (fullyValidated)
     {
         auto const& lcl = mLedgerManager.getLastClosedLedgerHeader();
 
@@ -1224,4 +1277,12 @@ HerderSCPDriver::TxSetValidityKeyHash::operator()(
     hashMix(res, std::get<3>(key));
     return res;
 }
+
+size_t
+HerderSCPDriver::ValueCacheKeyHash::operator()(ValueCacheKey const& key) const
+{
+    size_t res = std::hash<Hash>()(key.second);
+    hashMix(res, key.first);
+    return res;
+}
 }
@@ -143,6 +143,7 @@ class HerderSCPDriver : public SCPDriver
 
         medida::Meter& mValueValid;
         medida::Meter& mValueInvalid;
+        medida::Meter& mValueCacheHit;
 
         // listeners
         medida::Meter& mCombinedCandidates;
@@ -209,6 +210,34 @@ class HerderSCPDriver : public SCPDriver
     mutable RandomEvictionCache<TxSetValidityKey, bool, TxSetValidityKeyHash>
         mTxSetValidCache;
 
+    // Values seen for a slot, keyed by {slotIndex, hash of the value}. SCP
+    // validates a value again for every nomination vote and ballot statement
+    // that refers to it, so this avoids decoding it, checking its signature
+    // and checking its tx set each time. Entries only record results that
+    // can't change until the next ledger closes, and the whole cache is
+    // dropped when the LCL changes.
+    struct CachedValue
+    {
+        // `nullptr` if the value couldn't be decoded
+        std::shared_ptr<StellarValue const> mValue;
+        // whether `validateValueHelper` fully validated the value
+        bool mFullyValidated{false};
+    };
+    using ValueCacheKey = std::pair<uint64_t, Hash>;
+
+    class ValueCacheKeyHash
+    {
+      public:
+        size_t operator()(ValueCacheKey const& key) const;
+    };
+    RandomEvictionCache<ValueCacheKey, CachedValue, ValueCacheKeyHash>
+        mValueCache;
+    Hash mValueCacheLCLHash;
+
+    // Looks up `value` in `mValueCache`, decoding and inserting it if needed.
+    CachedValue getCachedValue(uint64_t slotIndex, Value const& value,
+                               ValueCacheKey& key);
+
     SCPDriver::ValidationLevel validateValueHelper(uint64_t slotIndex,
                                                    StellarValue const& sv,
                                                    bool nomination) const;
@@ -35,6 +35,7 @@ PendingEnvelopes::PendingEnvelopes(Application& app, HerderImpl& herder)
     , mTxSetCache(TXSET_CACHE_SIZE)
     , mValueSizeCache(TXSET_CACHE_SIZE + QSET_CACHE_SIZE)
     , mRebuildQuorum(true)
+    , mRefreshQuorum(false)
     , mQuorumTracker(mApp.getConfig().NODE_SEED.getPublicKey())
     , mProcessedCount(
           app.getMetrics().NewCounter({"scp", "pending", "processed"}))
@@ -47,6 +48,10 @@ PendingEnvelopes::PendingEnvelopes(Application& app, HerderImpl& herder)
     , mFetchTxSetTimer(app.getMetrics().NewTimer({"overlay", "fetch", "txset"}))
     , mFetchQsetTimer(app.getMetrics().NewTimer({"overlay", "fetch", "qset"}))
     , mCostPerSlot(app.getMetrics().NewHistogram({"scp", "cost", "per-slot"}))
+    , mQuorumRebuildTimer(
+          app.getMetrics().NewTimer({"scp", "quorum", "rebuild"}))
+    , mQuorumUpdateCost(
+          app.getMetrics().NewHistogram({"scp", "quorum", "update-cost"}))
 {
 }
 
@@ -257,6 +262,12 @@ PendingEnvelopes::isNodeDefinitelyInQuorum(NodeID const& node)
     {
         rebuildQuorumTrackerState();
         mRebuildQuorum = false;
+        mRefreshQuorum = false;
+    }
+    else if (mRefreshQuorum)
+    {
+        refreshQuorumTrackerState();
+        mRefreshQuorum = false;
     }
     return mQuorumTracker.isNodeDefinitelyInQuorum(node);
 }
@@ -713,10 +724,9 @@ PendingEnvelopes::stopAllBelow(uint64 slotIndex, uint64 slotToKeep)
 }
 
 void
-PendingEnvelopes::forceRebuildQuorum()
+PendingEnvelopes::refreshQuorum()
 {
-    // force recomputing the transitive quorum
-    mRebuildQuorum = true;
+    mRefreshQuorum = true;
 }
 
 TxSetFrameConstPtr
@@ -786,40 +796,78 @@ PendingEnvelopes::getJsonInfo(size_t limit)
     return ret;
 }
 
-void
-PendingEnvelopes::rebuildQuorumTrackerState()
+SCPQuorumSetPtr
+PendingEnvelopes::lookupNodeQuorumSet(NodeID const& id)
 {
-    // rebuild quorum information using data sources starting with the
-    // freshest source
-    mQuorumTracker.rebuild([&](NodeID const& id) -> SCPQuorumSetPtr {
-        SCPQuorumSetPtr res;
-        if (id == mHerder.getSCP().getLocalNodeID())
+    // use data sources starting with the freshest source
+    SCPQuorumSetPtr res;
+    if (id == mHerder.getSCP().getLocalNodeID())
+    {
+        res = getQSet(mHerder.getSCP().getLocalNode()->getQuorumSetHash());
+    }
+    else
+    {
+        auto m = mHerder.getSCP().getLatestMessage(id);
+        if (m != nullptr)
         {
-            res = getQSet(mHerder.getSCP().getLocalNode()->getQuorumSetHash());
+            auto h = Slot::getCompanionQuorumSetHashFromStatement(m->statement);
+            res = getQSet(h);
         }
-        else
+        if (res == nullptr)
         {
-            auto m = mHerder.getSCP().getLatestMessage(id);
-            if (m != nullptr)
-            {
-                auto h =
-                    Slot::getCompanionQuorumSetHashFromStatement(m->statement);
-                res = getQSet(h);
-            }
-            if (res == nullptr)
+            // see if we had some information for that node
+            auto& db = mApp.getDatabase();
+            auto h =
+                HerderPersistence::getNodeQuorumSet(db, db.getSession(), id);
+            if (h)
             {
-                // see if we had some information for that node
-                auto& db = mApp.getDatabase();
-                auto h = HerderPersistence::getNodeQuorumSet(
-                    db, db.getSession(), id);
-                if (h)
-                {
-                    res = getQSet(*h);
-                }
+                res = getQSet(*h);
             }
         }
-        return res;
-    });
+    }
+    return res;
+}
+
+void
+PendingEnvelopes::rebuildQuorumTrackerState()
+{
+    ZoneScoped;
+    auto timer = mQuorumRebuildTimer.TimeScope();
+    mQuorumTracker.rebuild(
+        [&](NodeID const& id) { return lookupNodeQuorumSet(id); });
+}
+
+void
+PendingEnvelopes::updateQuorumTracker(NodeID const& id)
+{
+    auto cost = mQuorumTracker.update(
+        id, lookupNodeQuorumSet(id),
+        [&](NodeID const& node) { return lookupNodeQuorumSet(node); });
+    if (cost != 0)
+    {
+        mQuorumUpdateCost.Update(static_cast<int64_t>(cost));
+    }
+}
+
+void
+PendingEnvelopes::refreshQuorumTrackerState()
+{
+    ZoneScoped;
+    // The information used to build the quorum (latest messages) changes as
+    // slots get purged: catch up with it one node at a time, which is
+    // equivalent to a rebuild but only touches the nodes whose quorum set
+    // changed.
+    std::vector<NodeID> nodes;
+    nodes.reserve(mQuorumTracker.getQuorum().size());
+    for (auto const& kv : mQuorumTracker.getQuorum())
+    {
+        nodes.emplace_back(kv.first);
+    }
+    for (auto const& id : nodes)
+    {
+        // nodes added while refreshing already use the latest information
+        updateQuorumTracker(id);
+    }
 }
 
 QuorumTracker::QuorumMap const&
@@ -831,16 +879,15 @@ PendingEnvelopes::getCurrentlyTrackedQuorum() const
 void
 PendingEnvelopes::envelopeProcessed(SCPEnvelope const& env)
 {
-    auto const& st = env.statement;
-    auto const& id = st.nodeID;
-
-    auto h = Slot::getCompanionQuorumSetHashFromStatement(st);
+    auto const& id = env.statement.nodeID;
 
-    SCPQuorumSetPtr qset = getQSet(h);
-    if (!mQuorumTracker.expand(id, qset))
+    // a pending rebuild will pick up the new information, and nodes outside
+    // of the transitive quorum don't impact it
+    if (!mRebuildQuorum && mQuorumTracker.isNodeDefinitelyInQuorum(id))
     {
-        // could not expand quorum, queue up a rebuild
-        mRebuildQuorum = true;
+        // the envelope may be for an older slot: use the quorum set from the
+        // latest message instead of the one from `env`
+        updateQuorumTracker(id);
     }
 }
 
@@ -70,6 +70,7 @@ class PendingEnvelopes
     RandomEvictionCache<Hash, size_t> mValueSizeCache;
 
     bool mRebuildQuorum;
+    bool mRefreshQuorum;
     QuorumTracker mQuorumTracker;
 
     medida::Counter& mProcessedCount;
@@ -81,6 +82,9 @@ class PendingEnvelopes
     medida::Timer& mFetchQsetTimer;
     // Tracked cost per slot
     medida::Histogram& mCostPerSlot;
+    medida::Timer& mQuorumRebuildTimer;
+    // number of nodes visited by incremental updates of the quorum tracker
+    medida::Histogram& mQuorumUpdateCost;
 
     // discards all SCP envelopes that use QSet with a given hash,
     // as it is not sane QSet
@@ -107,6 +111,11 @@ class PendingEnvelopes
 
     void cleanKnownData();
 
+    // returns the freshest quorum set known for `id`
+    SCPQuorumSetPtr lookupNodeQuorumSet(NodeID const& id);
+    void updateQuorumTracker(NodeID const& id);
+    void refreshQuorumTrackerState();
+
     void recordReceivedCost(SCPEnvelope const& env);
 
     UnorderedMap<NodeID, size_t> getCostPerValidator(uint64 slotIndex) const;
@@ -182,7 +191,9 @@ class PendingEnvelopes
     // slotToKeep.
     void eraseBelow(uint64 slotIndex, uint64 slotToKeep);
 
-    void forceRebuildQuorum();
+    // queues up a check of the quorum sets of all the nodes in the transitive
+    // quorum against the freshest information available
+    void refreshQuorum();
 
     std::vector<uint64> readySlots();
 
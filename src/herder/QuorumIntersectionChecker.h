@@ -5,8 +5,13 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "herder/QuorumTracker.h"
+#include "util/HashOfHash.h"
+#include "util/Math.h"
+#include "util/RandomEvictionCache.h"
 #include <atomic>
 #include <memory>
+#include <mutex>
+#include <optional>
 
 namespace stellar
 {
@@ -16,15 +21,42 @@ class Config;
 class QuorumIntersectionChecker
 {
   public:
+    // Outcome of the exhaustive min-quorum search over an SCC.
+    struct SearchResult
+    {
+        bool mFoundDisjoint{false};
+        std::pair<std::vector<NodeID>, std::vector<NodeID>> mPotentialSplit;
+    };
+
+    // Search results of previous checks, keyed by the members of the scanned
+    // SCC and their quorum sets (the search doesn't depend on anything else).
+    // Sharing a cache between checkers lets a check skip the search when the
+    // quorum map only changed outside of the SCC with quorums.
+    class SearchCache
+    {
+      public:
+        std::optional<SearchResult> get(Hash const& sccKey);
+        void put(Hash const& sccKey, SearchResult const& result);
+
+      private:
+        static constexpr size_t MAX_SIZE = 64;
+        std::mutex mMutex;
+        RandomEvictionCache<Hash, SearchResult> mResults{MAX_SIZE};
+    };
+
+    // The checkers run off the main thread, so they don't use gRandomEngine:
+    // callers on the main thread draw a `seed` from it for them instead.
     static std::shared_ptr<QuorumIntersectionChecker>
     create(stellar::QuorumTracker::QuorumMap const& qmap,
            stellar::Config const& cfg, std::atomic<bool>& interruptFlag,
-           bool quiet = false);
+           stellar::stellar_default_random_engine::result_type seed,
+           bool quiet = false, std::shared_ptr<SearchCache> cache = nullptr);
 
     static std::set<std::set<NodeID>>
-    getIntersectionCriticalGroups(stellar::QuorumTracker::QuorumMap const& qmap,
-                                  stellar::Config const& cfg,
-                                  std::atomic<bool>& interruptFlag);
+    getIntersectionCriticalGroups(
+        stellar::QuorumTracker::QuorumMap const& qmap,
+        stellar::Config const& cfg, std::atomic<bool>& interruptFlag,
+        stellar::stellar_default_random_engine::result_type seed);
 
     virtual ~QuorumIntersectionChecker(){};
     virtual bool networkEnjoysQuorumIntersection() const = 0;
@@ -5,9 +5,15 @@
 #include "QuorumIntersectionCheckerImpl.h"
 #include "QuorumIntersectionChecker.h"
 
+#include "crypto/SHA.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
 #include "util/Math.h"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <xdrpp/marshal.h>
 
 namespace
 {
@@ -83,7 +89,8 @@ MinQuorumEnumerator::pickSplitNode() const
                     // currDegree same as existing max: replace it
                     // only probabilistically.
                     maxCount++;
-                    if (rand_uniform<size_t>(0, maxCount) == 0)
+                    if (stellar::uniform_int_distribution<size_t>(
+                            0, maxCount)(mQic.mRandomEngine) == 0)
                     {
                         // Not switching max element with max degree.
                         continue;
@@ -122,11 +129,61 @@ MinQuorumEnumerator::MinQuorumEnumerator(
 
 bool
 MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
+{
+    auto res = checkWithoutRecursing();
+    if (res)
+    {
+        return *res;
+    }
+
+    // Phase two: recurse into subproblems.
+    size_t split = pickSplitNode();
+    if (mQic.mLogTrace)
+    {
+        CLOG_TRACE(SCP, "recursing into subproblems, split={}", split);
+    }
+    mRemaining.unset(split);
+    MinQuorumEnumerator childExcludingSplit(mCommitted, mRemaining, mScanSCC,
+                                            mQic);
+    mQic.mStats.mFirstRecursionsTaken++;
+    if (childExcludingSplit.anyMinQuorumHasDisjointQuorum())
+    {
+        if (mQic.mLogTrace)
+        {
+            CLOG_TRACE(SCP, "first subproblem returned true, missing split={}",
+                       split);
+        }
+        return true;
+    }
+    mCommitted.set(split);
+    MinQuorumEnumerator childIncludingSplit(mCommitted, mRemaining, mScanSCC,
+                                            mQic);
+    mQic.mStats.mSecondRecursionsTaken++;
+    return childIncludingSplit.anyMinQuorumHasDisjointQuorum();
+}
+
+void
+MinQuorumEnumerator::split(std::vector<SearchSubproblem>& out)
+{
+    size_t split = pickSplitNode();
+    mRemaining.unset(split);
+    out.emplace_back(mCommitted, mRemaining);
+    mCommitted.set(split);
+    out.emplace_back(mCommitted, mRemaining);
+}
+
+std::optional<bool>
+MinQuorumEnumerator::checkWithoutRecursing()
 {
     if (mQic.mInterruptFlag)
     {
         throw QuorumIntersectionChecker::InterruptedException();
     }
+    if (mQic.mSearchDone && *mQic.mSearchDone)
+    {
+        // Another thread of a parallel search already found disjoint quorums.
+        return false;
+    }
 
     mQic.mStats.mCallsStarted++;
 
@@ -234,31 +291,7 @@ MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
         }
         return false;
     }
-
-    // Phase two: recurse into subproblems.
-    size_t split = pickSplitNode();
-    if (mQic.mLogTrace)
-    {
-        CLOG_TRACE(SCP, "recursing into subproblems, split={}", split);
-    }
-    mRemaining.unset(split);
-    MinQuorumEnumerator childExcludingSplit(mCommitted, mRemaining, mScanSCC,
-                                            mQic);
-    mQic.mStats.mFirstRecursionsTaken++;
-    if (childExcludingSplit.anyMinQuorumHasDisjointQuorum())
-    {
-        if (mQic.mLogTrace)
-        {
-            CLOG_TRACE(SCP, "first subproblem returned true, missing split={}",
-                       split);
-        }
-        return true;
-    }
-    mCommitted.set(split);
-    MinQuorumEnumerator childIncludingSplit(mCommitted, mRemaining, mScanSCC,
-                                            mQic);
-    mQic.mStats.mSecondRecursionsTaken++;
-    return childIncludingSplit.anyMinQuorumHasDisjointQuorum();
+    return std::nullopt;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -267,12 +300,16 @@ MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
 
 QuorumIntersectionCheckerImpl::QuorumIntersectionCheckerImpl(
     QuorumTracker::QuorumMap const& qmap, Config const& cfg,
-    std::atomic<bool>& interruptFlag, bool quiet)
+    std::atomic<bool>& interruptFlag,
+    stellar_default_random_engine::result_type seed, bool quiet,
+    std::shared_ptr<SearchCache> cache)
     : mCfg(cfg)
     , mLogTrace(Logging::logTrace("SCP"))
     , mQuiet(quiet)
     , mTSC()
     , mInterruptFlag(interruptFlag)
+    , mSearchCache(std::move(cache))
+    , mRandomEngine(seed)
     , mCachedQuorums(MAX_CACHED_QUORUMS_SIZE)
 {
     buildGraph(qmap);
@@ -281,6 +318,26 @@ QuorumIntersectionCheckerImpl::QuorumIntersectionCheckerImpl(
     buildSCCs();
 }
 
+QuorumIntersectionCheckerImpl::QuorumIntersectionCheckerImpl(
+    QuorumIntersectionCheckerImpl const& parent,
+    std::atomic<bool> const& searchDone)
+    : mCfg(parent.mCfg)
+    , mLogTrace(parent.mLogTrace)
+    , mQuiet(parent.mQuiet)
+    , mBitNumPubKeys(parent.mBitNumPubKeys)
+    , mPubKeyBitNums(parent.mPubKeyBitNums)
+    , mGraph(parent.mGraph)
+    , mTSC()
+    , mInterruptFlag(parent.mInterruptFlag)
+    , mRandomEngine(parent.mRandomEngine())
+    , mSearchDone(&searchDone)
+    , mCachedQuorums(MAX_CACHED_QUORUMS_SIZE)
+{
+    mStats.mTotalNodes = parent.mStats.mTotalNodes;
+    mStats.mNumSCCs = parent.mStats.mNumSCCs;
+    mStats.mScanSCCSize = parent.mStats.mScanSCCSize;
+}
+
 std::pair<std::vector<NodeID>, std::vector<NodeID>>
 QuorumIntersectionCheckerImpl::getPotentialSplit() const
 {
@@ -584,6 +641,7 @@ QuorumIntersectionCheckerImpl::buildGraph(QuorumTracker::QuorumMap const& qmap)
 {
     mPubKeyBitNums.clear();
     mBitNumPubKeys.clear();
+    mQSets.clear();
     mGraph.clear();
 
     for (auto const& pair : qmap)
@@ -593,6 +651,7 @@ QuorumIntersectionCheckerImpl::buildGraph(QuorumTracker::QuorumMap const& qmap)
             size_t n = mBitNumPubKeys.size();
             mPubKeyBitNums.insert(std::make_pair(pair.first, n));
             mBitNumPubKeys.emplace_back(pair.first);
+            mQSets.emplace_back(pair.second.mQuorumSet);
         }
         else
         {
@@ -704,15 +763,194 @@ QuorumIntersectionCheckerImpl::networkEnjoysQuorumIntersection() const
     // Second stage: scan the scan-SCC powerset, potentially expensive.
     if (!foundDisjoint)
     {
-        BitSet committed;
-        BitSet remaining = scanSCC;
-        MinQuorumEnumerator mqe(committed, remaining, scanSCC, *this);
-        foundDisjoint = mqe.anyMinQuorumHasDisjointQuorum();
-        mStats.log();
+        // The result of the scan only depends on the members of the scan-SCC
+        // and their quorum sets, so it can be reused across checks of maps
+        // that only differ outside of it.
+        Hash key;
+        std::optional<SearchResult> cached;
+        if (mSearchCache)
+        {
+            key = getSCCKey(scanSCC);
+            cached = mSearchCache->get(key);
+        }
+        if (cached)
+        {
+            CLOG_DEBUG(SCP, "Reusing quorum intersection result for {}-node "
+                            "scan-SCC",
+                       mStats.mScanSCCSize);
+            foundDisjoint = cached->mFoundDisjoint;
+            mPotentialSplit = cached->mPotentialSplit;
+        }
+        else
+        {
+            foundDisjoint = anyMinQuorumHasDisjointQuorum(scanSCC);
+            mStats.log();
+            if (mSearchCache)
+            {
+                mSearchCache->put(key, {foundDisjoint, mPotentialSplit});
+            }
+        }
     }
     return !foundDisjoint;
 }
 
+Hash
+QuorumIntersectionCheckerImpl::getSCCKey(BitSet const& scc) const
+{
+    std::vector<std::pair<NodeID, SCPQuorumSetPtr>> members;
+    for (size_t i = 0; scc.nextSet(i); ++i)
+    {
+        members.emplace_back(mBitNumPubKeys.at(i), mQSets.at(i));
+    }
+    std::sort(members.begin(), members.end(),
+              [](auto const& a, auto const& b) { return a.first < b.first; });
+    SHA256 hasher;
+    for (auto const& m : members)
+    {
+        hasher.add(xdr::xdr_to_opaque(m.first));
+        hasher.add(xdr::xdr_to_opaque(*m.second));
+    }
+    return hasher.finish();
+}
+
+bool
+QuorumIntersectionCheckerImpl::anyMinQuorumHasDisjointQuorum(
+    BitSet const& scanSCC) const
+{
+    size_t nThreads = mCfg.QUORUM_INTERSECTION_CHECKER_THREADS;
+    if (nThreads > 1)
+    {
+        return anyMinQuorumHasDisjointQuorumParallel(scanSCC, nThreads);
+    }
+    BitSet committed;
+    BitSet remaining = scanSCC;
+    MinQuorumEnumerator mqe(committed, remaining, scanSCC, *this);
+    return mqe.anyMinQuorumHasDisjointQuorum();
+}
+
+bool
+QuorumIntersectionCheckerImpl::anyMinQuorumHasDisjointQuorumParallel(
+    BitSet const& scanSCC, size_t nThreads) const
+{
+    // Expand the top of the search tree breadth-first on this thread until
+    // there are enough independent subproblems to keep all the threads busy,
+    // then let the workers claim them one at a time. Subproblems vary wildly
+    // in size, so handing them out on demand balances the load much better
+    // than a static partition would.
+    std::deque<SearchSubproblem> frontier;
+    frontier.emplace_back(BitSet(), scanSCC);
+    std::vector<SearchSubproblem> subproblems;
+    size_t const target = nThreads * SUBPROBLEMS_PER_THREAD;
+    while (!frontier.empty() && frontier.size() + subproblems.size() < target)
+    {
+        auto sp = std::move(frontier.front());
+        frontier.pop_front();
+        MinQuorumEnumerator mqe(sp.first, sp.second, scanSCC, *this);
+        auto res = mqe.checkWithoutRecursing();
+        if (res)
+        {
+            if (*res)
+            {
+                return true;
+            }
+            continue;
+        }
+        std::vector<SearchSubproblem> children;
+        mqe.split(children);
+        mStats.mFirstRecursionsTaken++;
+        mStats.mSecondRecursionsTaken++;
+        for (auto& c : children)
+        {
+            frontier.emplace_back(std::move(c));
+        }
+    }
+    for (auto& sp : frontier)
+    {
+        subproblems.emplace_back(std::move(sp));
+    }
+    if (subproblems.empty())
+    {
+        return false;
+    }
+    nThreads = std::min(nThreads, subproblems.size());
+
+    std::atomic<bool> searchDone{false};
+    std::atomic<size_t> nextSubproblem{0};
+    std::mutex resultMutex;
+    bool interrupted = false;
+
+    // Workers get their own checkers: the enumeration keeps per-checker
+    // scratch state (in-degrees, quorum cache, stats, RNG) that can't be
+    // shared. They're cloned here since cloning reads this checker's RNG.
+    std::vector<std::unique_ptr<QuorumIntersectionCheckerImpl>> workers;
+    for (size_t i = 0; i < nThreads; ++i)
+    {
+        workers.emplace_back(
+            std::make_unique<QuorumIntersectionCheckerImpl>(*this, searchDone));
+    }
+
+    std::vector<std::thread> threads;
+    for (auto& worker : workers)
+    {
+        threads.emplace_back([&, qic = worker.get()]() {
+            try
+            {
+                while (!searchDone)
+                {
+                    size_t i = nextSubproblem++;
+                    if (i >= subproblems.size())
+                    {
+                        break;
+                    }
+                    BitSet committed = subproblems[i].first;
+                    BitSet remaining = subproblems[i].second;
+                    MinQuorumEnumerator mqe(committed, remaining, scanSCC,
+                                            *qic);
+                    if (mqe.anyMinQuorumHasDisjointQuorum())
+                    {
+                        std::lock_guard<std::mutex> lock(resultMutex);
+                        if (!searchDone)
+                        {
+                            mPotentialSplit = qic->mPotentialSplit;
+                            searchDone = true;
+                        }
+                    }
+                }
+            }
+            catch (QuorumIntersectionChecker::InterruptedException&)
+            {
+                std::lock_guard<std::mutex> lock(resultMutex);
+                interrupted = true;
+            }
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    for (auto const& worker : workers)
+    {
+        auto const& s = worker->mStats;
+        mStats.mCallsStarted += s.mCallsStarted;
+        mStats.mFirstRecursionsTaken += s.mFirstRecursionsTaken;
+        mStats.mSecondRecursionsTaken += s.mSecondRecursionsTaken;
+        mStats.mMaxQuorumsSeen += s.mMaxQuorumsSeen;
+        mStats.mMinQuorumsSeen += s.mMinQuorumsSeen;
+        mStats.mTerminations += s.mTerminations;
+        mStats.mEarlyExit1s += s.mEarlyExit1s;
+        mStats.mEarlyExit21s += s.mEarlyExit21s;
+        mStats.mEarlyExit22s += s.mEarlyExit22s;
+        mStats.mEarlyExit31s += s.mEarlyExit31s;
+        mStats.mEarlyExit32s += s.mEarlyExit32s;
+    }
+    if (interrupted)
+    {
+        throw QuorumIntersectionChecker::InterruptedException();
+    }
+    return searchDone;
+}
+
 bool
 pointsToCandidate(SCPQuorumSet const& p, NodeID const& candidate)
 {
@@ -786,18 +1024,41 @@ groupString(Config const& cfg, std::set<NodeID> const& group)
 namespace stellar
 {
 std::shared_ptr<QuorumIntersectionChecker>
-QuorumIntersectionChecker::create(QuorumTracker::QuorumMap const& qmap,
-                                  Config const& cfg,
-                                  std::atomic<bool>& interruptFlag, bool quiet)
+QuorumIntersectionChecker::create(
+    QuorumTracker::QuorumMap const& qmap, Config const& cfg,
+    std::atomic<bool>& interruptFlag,
+    stellar_default_random_engine::result_type seed, bool quiet,
+    std::shared_ptr<SearchCache> cache)
 {
     return std::make_shared<QuorumIntersectionCheckerImpl>(
-        qmap, cfg, interruptFlag, quiet);
+        qmap, cfg, interruptFlag, seed, quiet, std::move(cache));
+}
+
+std::optional<QuorumIntersectionChecker::SearchResult>
+QuorumIntersectionChecker::SearchCache::get(Hash const& key)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto res = mResults.maybeGet(key);
+    if (res)
+    {
+        return *res;
+    }
+    return std::nullopt;
+}
+
+void
+QuorumIntersectionChecker::SearchCache::put(Hash const& key,
+                                            SearchResult const& result)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mResults.put(key, result);
 }
 
 std::set<std::set<NodeID>>
 QuorumIntersectionChecker::getIntersectionCriticalGroups(
     stellar::QuorumTracker::QuorumMap const& qmap, stellar::Config const& cfg,
-    std::atomic<bool>& interruptFlag)
+    std::atomic<bool>& interruptFlag,
+    stellar_default_random_engine::result_type seed)
 {
     // We're going to search for "intersection-critical" groups, by considering
     // each SCPQuorumSet S that (a) has no innerSets of its own and (b) occurs
@@ -827,6 +1088,11 @@ QuorumIntersectionChecker::getIntersectionCriticalGroups(
     std::set<std::set<NodeID>> candidates;
     std::set<std::set<NodeID>> critical;
     QuorumTracker::QuorumMap test_qmap(qmap);
+    // Groups outside of the scan-SCC leave it unchanged, so share the scan
+    // results across all the candidate checks.
+    auto cache = std::make_shared<SearchCache>();
+    // Seeds the checker of every candidate group.
+    stellar_default_random_engine seeds(seed);
 
     for (auto const& k : qmap)
     {
@@ -885,7 +1151,7 @@ QuorumIntersectionChecker::getIntersectionCriticalGroups(
         // Check to see if this modified config is vulnerable to splitting.
         auto checker =
             QuorumIntersectionChecker::create(test_qmap, cfg, interruptFlag,
-                                              /*quiet=*/true);
+                                              seeds(), /*quiet=*/true, cache);
         if (checker->networkEnjoysQuorumIntersection())
         {
             CLOG_DEBUG(SCP,
@@ -353,11 +353,13 @@
 #include "QuorumIntersectionChecker.h"
 #include "main/Config.h"
 #include "util/BitSet.h"
+#include "util/Math.h"
 #include "util/RandomEvictionCache.h"
 #include "util/TarjanSCCCalculator.h"
 #include "xdr/Stellar-SCP.h"
 #include "xdr/Stellar-types.h"
 #include <functional>
+#include <optional>
 
 namespace
 {
@@ -366,6 +368,10 @@ struct QBitSet;
 using QGraph = std::vector<QBitSet>;
 class QuorumIntersectionCheckerImpl;
 
+// A (committed, remaining) pair describing the part of the powerset that a
+// MinQuorumEnumerator is responsible for.
+using SearchSubproblem = std::pair<BitSet, BitSet>;
+
 // A QBitSet is the "fast" representation of a SCPQuorumSet. It includes both a
 // BitSet of its own nodes and a set of innerSets, along with a "successors"
 // BitSet that contains the union of all the bits set in the own nodes or
@@ -438,6 +444,15 @@ class MinQuorumEnumerator
 
     bool hasDisjointQuorum(BitSet const& nodes) const;
     bool anyMinQuorumHasDisjointQuorum();
+
+    // Runs the checks and early exits of this step of the recursion. Returns
+    // a result if they settle it, nullopt if the search has to recurse.
+    std::optional<bool> checkWithoutRecursing();
+
+    // Appends the two subproblems this enumerator would recurse into to
+    // `out`. Must only be called when `checkWithoutRecursing` returned
+    // nullopt.
+    void split(std::vector<SearchSubproblem>& out);
 };
 
 // Quorum intersection checking is done by establishing a root
@@ -505,10 +520,32 @@ class QuorumIntersectionCheckerImpl : public stellar::QuorumIntersectionChecker
     // InterruptedException at the nearest convenient moment.
     std::atomic<bool>& mInterruptFlag;
 
+    // Quorum sets of the graph nodes, used to identify SCCs in mSearchCache.
+    std::vector<stellar::SCPQuorumSetPtr> mQSets;
+    std::shared_ptr<SearchCache> mSearchCache;
+
+    // Used for tie breaking when picking split nodes. Every checker has its
+    // own engine so that parallel searches don't share any mutable state.
+    mutable stellar::stellar_default_random_engine mRandomEngine;
+
+    // When running as one of the threads of a parallel search: set once any
+    // of the threads found disjoint quorums, so the other ones can stop.
+    std::atomic<bool> const* mSearchDone{nullptr};
+
+    // Subproblems handed out to each thread of a parallel search. Many more
+    // than threads are created so that threads finishing early pick up the
+    // remaining ones.
+    static constexpr size_t SUBPROBLEMS_PER_THREAD = 16;
+
     QBitSet convertSCPQuorumSet(stellar::SCPQuorumSet const& sqs);
     void buildGraph(stellar::QuorumTracker::QuorumMap const& qmap);
     void buildSCCs();
 
+    stellar::Hash getSCCKey(BitSet const& scc) const;
+    bool anyMinQuorumHasDisjointQuorum(BitSet const& scanSCC) const;
+    bool anyMinQuorumHasDisjointQuorumParallel(BitSet const& scanSCC,
+                                               size_t nThreads) const;
+
     bool containsQuorumSlice(BitSet const& bs, QBitSet const& qbs) const;
     bool containsQuorumSliceForNode(BitSet const& bs, size_t node) const;
     BitSet contractToMaximalQuorum(BitSet nodes) const;
@@ -525,10 +562,17 @@ class QuorumIntersectionCheckerImpl : public stellar::QuorumIntersectionChecker
     friend class MinQuorumEnumerator;
 
   public:
-    QuorumIntersectionCheckerImpl(stellar::QuorumTracker::QuorumMap const& qmap,
-                                  stellar::Config const& cfg,
-                                  std::atomic<bool>& interruptFlag,
-                                  bool quiet = false);
+    QuorumIntersectionCheckerImpl(
+        stellar::QuorumTracker::QuorumMap const& qmap,
+        stellar::Config const& cfg, std::atomic<bool>& interruptFlag,
+        stellar::stellar_default_random_engine::result_type seed,
+        bool quiet = false, std::shared_ptr<SearchCache> cache = nullptr);
+
+    // Copy of `parent`'s graph with its own search state, for one of the
+    // threads of a parallel search.
+    QuorumIntersectionCheckerImpl(QuorumIntersectionCheckerImpl const& parent,
+                                  std::atomic<bool> const& searchDone);
+
     bool networkEnjoysQuorumIntersection() const override;
 
     std::pair<std::vector<stellar::NodeID>, std::vector<stellar::NodeID>>
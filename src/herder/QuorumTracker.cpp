@@ -7,6 +7,8 @@
 #include "scp/LocalNode.h"
 #include "util/GlobalChecks.h"
 #include <Tracy.hpp>
+#include <map>
+#include <optional>
 
 namespace stellar
 {
@@ -69,6 +71,7 @@ QuorumTracker::expand(NodeID const& id, SCPQuorumSetPtr qSet)
     int newDist = nodeInfo.mDistance + 1;
 
     return LocalNode::forAllNodes(*qSet, [&](NodeID const& qNode) {
+        mDependents[qNode].emplace(id);
         auto qPair = mQuorum.emplace(qNode, NodeInfo{nullptr, newDist, {}});
 
         bool exists = !qPair.second;
@@ -132,12 +135,367 @@ QuorumTracker::expand(NodeID const& id, SCPQuorumSetPtr qSet)
     });
 }
 
+static std::set<NodeID>
+getQuorumSetNodes(SCPQuorumSetPtr const& qSet)
+{
+    std::set<NodeID> res;
+    if (qSet)
+    {
+        LocalNode::forAllNodes(*qSet, [&](NodeID const& id) {
+            res.emplace(id);
+            return true;
+        });
+    }
+    return res;
+}
+
+UnorderedSet<NodeID> const&
+QuorumTracker::getDependents(NodeID const& id) const
+{
+    static UnorderedSet<NodeID> const empty;
+    auto it = mDependents.find(id);
+    return it == mDependents.end() ? empty : it->second;
+}
+
+// `update` is a dynamic version of the BFS performed by `rebuild`, in three
+// steps:
+//   * edges that were removed can only increase distances. The nodes that lost
+//     all their shortest paths are found level by level, and their distances
+//     recomputed from the rest of the graph (see `reroute`).
+//   * edges that were added can only decrease distances, which is propagated
+//     with a BFS starting from the new edges; nodes reached for the first time
+//     are added and expanded with `lookup`.
+//   * closest validators are recomputed in order of distance for the nodes
+//     touched by the previous steps, stopping as soon as a node's set doesn't
+//     change (see `updateClosestValidators`).
+size_t
+QuorumTracker::update(NodeID const& id, SCPQuorumSetPtr qSet,
+                      QuorumSetLookup const& lookup)
+{
+    ZoneScoped;
+
+    auto it = mQuorum.find(id);
+    if (it == mQuorum.end())
+    {
+        // nothing in the quorum depends on the quorum set of a node outside of
+        // it
+        return 0;
+    }
+    auto oldQSet = it->second.mQuorumSet;
+    if (oldQSet == qSet || (oldQSet && qSet && *oldQSet == *qSet))
+    {
+        return 0;
+    }
+    it->second.mQuorumSet = qSet;
+    int const dist = it->second.mDistance;
+
+    auto oldNodes = getQuorumSetNodes(oldQSet);
+    auto newNodes = getQuorumSetNodes(qSet);
+    size_t cost = 1;
+
+    // nodes that need their closest validators recomputed
+    UnorderedSet<NodeID> changed;
+    // subset of `changed` that also had their distance changed
+    UnorderedSet<NodeID> distanceChanged;
+
+    // Step 1: removed edges
+    UnorderedSet<NodeID> affected;
+    std::vector<NodeID> level;
+    for (auto const& n : oldNodes)
+    {
+        if (newNodes.find(n) != newNodes.end())
+        {
+            continue;
+        }
+        mDependents[n].erase(id);
+        changed.emplace(n);
+        if (mQuorum.at(n).mDistance == dist + 1)
+        {
+            level.emplace_back(n);
+        }
+    }
+    // `level` only contains nodes at the same distance, and the successors of
+    // a node at distance `d` that may be affected are at distance `d + 1`: all
+    // the dependents of a node are decided by the time it is checked
+    while (!level.empty())
+    {
+        std::vector<NodeID> next;
+        for (auto const& n : level)
+        {
+            ++cost;
+            if (affected.find(n) != affected.end())
+            {
+                continue;
+            }
+            auto const& info = mQuorum.at(n);
+            bool supported = false;
+            for (auto const& p : getDependents(n))
+            {
+                if (affected.find(p) == affected.end() &&
+                    mQuorum.at(p).mDistance == info.mDistance - 1)
+                {
+                    supported = true;
+                    break;
+                }
+            }
+            if (supported)
+            {
+                continue;
+            }
+            affected.emplace(n);
+            for (auto const& m : getQuorumSetNodes(info.mQuorumSet))
+            {
+                if (mQuorum.at(m).mDistance == info.mDistance + 1)
+                {
+                    next.emplace_back(m);
+                }
+            }
+        }
+        level = std::move(next);
+    }
+    if (!affected.empty())
+    {
+        cost += reroute(affected, changed);
+        for (auto const& n : affected)
+        {
+            if (mQuorum.find(n) != mQuorum.end())
+            {
+                distanceChanged.emplace(n);
+            }
+        }
+    }
+
+    // Step 2: added edges. The distance of `id` itself can't have changed in
+    // step 1 as only nodes further away than `id` can be affected.
+    std::deque<NodeID> backlog;
+    auto relax = [&](NodeID const& from, NodeID const& to, int newDist) {
+        mDependents[to].emplace(from);
+        auto res = mQuorum.emplace(to, NodeInfo{nullptr, newDist, {}});
+        auto& info = res.first->second;
+        if (res.second)
+        {
+            info.mQuorumSet = lookup(to);
+        }
+        else if (newDist < info.mDistance)
+        {
+            info.mDistance = newDist;
+        }
+        else
+        {
+            if (newDist == info.mDistance)
+            {
+                changed.emplace(to);
+            }
+            return;
+        }
+        changed.emplace(to);
+        distanceChanged.emplace(to);
+        backlog.emplace_back(to);
+    };
+    for (auto const& n : newNodes)
+    {
+        if (oldNodes.find(n) == oldNodes.end())
+        {
+            relax(id, n, dist + 1);
+        }
+    }
+    // BFS: nodes are processed by increasing distance, so the first distance
+    // assigned to a node is its final one
+    while (!backlog.empty())
+    {
+        ++cost;
+        auto n = backlog.front();
+        backlog.pop_front();
+        auto const& info = mQuorum.at(n);
+        int newDist = info.mDistance + 1;
+        for (auto const& m : getQuorumSetNodes(info.mQuorumSet))
+        {
+            relax(n, m, newDist);
+        }
+    }
+
+    // Step 3: closest validators
+    cost += updateClosestValidators(changed, std::move(distanceChanged));
+    return cost;
+}
+
+size_t
+QuorumTracker::reroute(UnorderedSet<NodeID> const& affected,
+                       UnorderedSet<NodeID>& changed)
+{
+    ZoneScoped;
+
+    size_t cost = 0;
+    // Nodes outside of `affected` still have their correct distance, so the
+    // best paths for affected nodes are found by running Dijkstra over the
+    // affected nodes, starting from their unaffected dependents.
+    UnorderedMap<NodeID, int> tentative;
+    std::map<int, std::vector<NodeID>> buckets;
+    for (auto const& n : affected)
+    {
+        ++cost;
+        std::optional<int> best;
+        for (auto const& p : getDependents(n))
+        {
+            if (affected.find(p) == affected.end())
+            {
+                int d = mQuorum.at(p).mDistance + 1;
+                if (!best || d < *best)
+                {
+                    best = d;
+                }
+            }
+        }
+        if (best)
+        {
+            tentative.emplace(n, *best);
+            buckets[*best].emplace_back(n);
+        }
+    }
+
+    UnorderedSet<NodeID> done;
+    while (!buckets.empty())
+    {
+        auto bucket = buckets.begin();
+        int d = bucket->first;
+        auto nodes = std::move(bucket->second);
+        buckets.erase(bucket);
+        for (auto const& n : nodes)
+        {
+            if (tentative.at(n) != d || !done.emplace(n).second)
+            {
+                // stale entry
+                continue;
+            }
+            ++cost;
+            auto& info = mQuorum.at(n);
+            info.mDistance = d;
+            for (auto const& m : getQuorumSetNodes(info.mQuorumSet))
+            {
+                if (affected.find(m) == affected.end() ||
+                    done.find(m) != done.end())
+                {
+                    continue;
+                }
+                auto t = tentative.emplace(m, d + 1);
+                if (t.second || d + 1 < t.first->second)
+                {
+                    t.first->second = d + 1;
+                    buckets[d + 1].emplace_back(m);
+                }
+            }
+        }
+    }
+
+    // whatever could not be reached is not part of the quorum anymore
+    for (auto const& n : affected)
+    {
+        if (done.find(n) != done.end())
+        {
+            continue;
+        }
+        ++cost;
+        auto it = mQuorum.find(n);
+        for (auto const& m : getQuorumSetNodes(it->second.mQuorumSet))
+        {
+            auto dep = mDependents.find(m);
+            if (dep != mDependents.end())
+            {
+                dep->second.erase(n);
+            }
+            // nodes that stay in the quorum lost a dependent
+            if (affected.find(m) == affected.end())
+            {
+                changed.emplace(m);
+            }
+        }
+        mQuorum.erase(it);
+        mDependents.erase(n);
+        changed.erase(n);
+    }
+    for (auto const& n : done)
+    {
+        changed.emplace(n);
+    }
+    return cost;
+}
+
+size_t
+QuorumTracker::updateClosestValidators(UnorderedSet<NodeID> const& changed,
+                                       UnorderedSet<NodeID> distanceChanged)
+{
+    ZoneScoped;
+
+    size_t cost = 0;
+    // The closest validators of a node only depend on the ones of its
+    // dependents one step closer to the local node: processing nodes by
+    // increasing distance means a node's inputs are final when it's visited.
+    std::map<int, std::vector<NodeID>> buckets;
+    UnorderedSet<NodeID> queued;
+    auto enqueue = [&](NodeID const& n) {
+        auto it = mQuorum.find(n);
+        if (it != mQuorum.end() && queued.emplace(n).second)
+        {
+            buckets[it->second.mDistance].emplace_back(n);
+        }
+    };
+    for (auto const& n : changed)
+    {
+        enqueue(n);
+    }
+
+    while (!buckets.empty())
+    {
+        auto bucket = buckets.begin();
+        int d = bucket->first;
+        auto nodes = std::move(bucket->second);
+        buckets.erase(bucket);
+        for (auto const& n : nodes)
+        {
+            ++cost;
+            queued.erase(n);
+            auto& info = mQuorum.at(n);
+            std::set<NodeID> closest;
+            if (d == 1)
+            {
+                closest.emplace(n);
+            }
+            else if (d > 1)
+            {
+                for (auto const& p : getDependents(n))
+                {
+                    auto const& pInfo = mQuorum.at(p);
+                    if (pInfo.mDistance == d - 1)
+                    {
+                        closest.insert(pInfo.mClosestValidators.begin(),
+                                       pInfo.mClosestValidators.end());
+                    }
+                }
+            }
+            // nodes that moved also change which of their successors they
+            // are a shortest path to
+            bool moved = distanceChanged.erase(n) != 0;
+            if (closest == info.mClosestValidators && !moved)
+            {
+                continue;
+            }
+            info.mClosestValidators = std::move(closest);
+            for (auto const& m : getQuorumSetNodes(info.mQuorumSet))
+            {
+                enqueue(m);
+            }
+        }
+    }
+    return cost;
+}
+
 void
-QuorumTracker::rebuild(std::function<SCPQuorumSetPtr(NodeID const&)> lookup)
+QuorumTracker::rebuild(QuorumSetLookup lookup)
 {
     ZoneScoped;
 
     mQuorum.clear();
+    mDependents.clear();
 
     mQuorum.emplace(mLocalNodeID, NodeInfo{nullptr, 0, {}});
 
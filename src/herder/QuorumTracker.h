@@ -9,6 +9,7 @@
 #include "util/UnorderedMap.h"
 #include "util/UnorderedSet.h"
 #include <deque>
+#include <functional>
 #include <set>
 
 namespace stellar
@@ -19,8 +20,10 @@ namespace stellar
 // If its associated quorum set is empty (nullptr), it just means
 // that another node has that node in its quorum set
 // but could not explore the quorum further (as we're missing the quorum set)
-// Nodes can be added one by one (calling `expand`, most efficient)
-// or the quorum can be rebuilt from scratch by using a lookup function
+// Nodes can be added one by one (calling `expand`, most efficient),
+// updated in place when their quorum set changes (calling `update`, which only
+// touches the part of the quorum affected by the change) or the quorum can be
+// rebuilt from scratch by using a lookup function
 class QuorumTracker : public NonMovableOrCopyable
 {
   public:
@@ -41,10 +44,25 @@ class QuorumTracker : public NonMovableOrCopyable
     };
 
     using QuorumMap = UnorderedMap<NodeID, NodeInfo>;
+    using QuorumSetLookup = std::function<SCPQuorumSetPtr(NodeID const&)>;
 
   private:
     NodeID const mLocalNodeID;
     QuorumMap mQuorum;
+    // for every node in `mQuorum`, the nodes of `mQuorum` that have it in
+    // their quorum set (the reverse edges of the quorum graph)
+    UnorderedMap<NodeID, UnorderedSet<NodeID>> mDependents;
+
+    UnorderedSet<NodeID> const& getDependents(NodeID const& id) const;
+    // removes the nodes of `affected` that lost their shortest paths to the
+    // local node, recomputing their distances and dropping the ones that are
+    // not reachable anymore
+    size_t reroute(UnorderedSet<NodeID> const& affected,
+                   UnorderedSet<NodeID>& changed);
+    // recomputes `mClosestValidators` for `changed` and any node downstream of
+    // them that is impacted
+    size_t updateClosestValidators(UnorderedSet<NodeID> const& changed,
+                                   UnorderedSet<NodeID> distanceChanged);
 
   public:
     QuorumTracker(NodeID const& localNodeID);
@@ -69,8 +87,21 @@ class QuorumTracker : public NonMovableOrCopyable
     // the nodes in the qset, which are equally close to the external node
     bool expand(NodeID const& id, SCPQuorumSetPtr qSet);
 
+    // sets the quorum set of node `id` to `qSet` (which may be nullptr if it's
+    // not known anymore), adjusting distances and closest validators of the
+    // nodes impacted by the change:
+    //     nodes that become reachable are added, using `lookup` to find their
+    //     quorum set
+    //     nodes that are not reachable anymore are removed
+    // the resulting state is the same as the one `rebuild` would produce.
+    // Does nothing if `id` is not in the transitive quorum.
+    // returns the number of nodes that had to be visited, as a measure of the
+    // cost of the update
+    size_t update(NodeID const& id, SCPQuorumSetPtr qSet,
+                  QuorumSetLookup const& lookup);
+
     // rebuild the transitive quorum given a lookup function
-    void rebuild(std::function<SCPQuorumSetPtr(NodeID const&)> lookup);
+    void rebuild(QuorumSetLookup lookup);
 
     // returns the current known quorum
     QuorumMap const& getQuorum() const;
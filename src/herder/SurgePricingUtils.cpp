@@ -11,18 +11,6 @@
 
 namespace stellar
 {
-namespace
-{
-
-int
-feeRate3WayCompare(TransactionFrameBase const& l, TransactionFrameBase const& r)
-{
-    return stellar::feeRate3WayCompare(l.getFeeBid(), l.getNumOperations(),
-                                       r.getFeeBid(), r.getNumOperations());
-}
-
-} // namespace
-
 int
 feeRate3WayCompare(int64_t lFeeBid, uint32_t lNbOps, int64_t rFeeBid,
                    uint32_t rNbOps)
@@ -37,6 +25,14 @@ feeRate3WayCompare(int64_t lFeeBid, uint32_t lNbOps, int64_t rFeeBid,
     //               f1 / n1 < f2 / n2
     //  == f1 * n1 * n2 / n1 < f2 * n1 * n2 / n2
     //  == f1 *      n2      < f2 * n1
+    //
+    // When operation counts are equal (the most common case, e.g. for
+    // single-operation and Soroban transactions) this reduces to comparing the
+    // fee bids directly, which avoids the 128-bit multiplication.
+    if (lNbOps == rNbOps && lNbOps != 0)
+    {
+        return lFeeBid < rFeeBid ? -1 : (lFeeBid > rFeeBid ? 1 : 0);
+    }
     auto v1 = bigMultiply(lFeeBid, rNbOps);
     auto v2 = bigMultiply(rFeeBid, lNbOps);
     if (v1 < v2)
@@ -75,9 +71,16 @@ SurgePricingPriorityQueue::TxStackComparator::TxStackComparator(bool isGreater,
 
 bool
 SurgePricingPriorityQueue::TxStackComparator::operator()(
-    TxStackPtr const& txStack1, TxStackPtr const& txStack2) const
+    TxStackEntry const& entry1, TxStackEntry const& entry2) const
 {
-    return txStackLessThan(*txStack1, *txStack2) ^ mIsGreater;
+    auto cmp3 = feeRate3WayCompare(entry1.mFeeBid, entry1.mNumOps,
+                                   entry2.mFeeBid, entry2.mNumOps);
+    if (cmp3 != 0)
+    {
+        return (cmp3 < 0) ^ mIsGreater;
+    }
+    // break tie with pointer arithmetic
+    return (entry1.mTieBreaker < entry2.mTieBreaker) ^ mIsGreater;
 }
 
 bool
@@ -102,36 +105,21 @@ SurgePricingPriorityQueue::TxStackComparator::isGreater() const
     return mIsGreater;
 }
 
-bool
-SurgePricingPriorityQueue::TxStackComparator::txStackLessThan(
-    TxStack const& txStack1, TxStack const& txStack2) const
+size_t
+SurgePricingPriorityQueue::TxStackComparator::getSeed() const
 {
-    if (txStack1.empty())
-    {
-        return !txStack2.empty();
-    }
-    if (txStack2.empty())
-    {
-        return false;
-    }
-    return txLessThan(txStack1.getTopTx(), txStack2.getTopTx(), true);
+    return mSeed;
 }
 
-bool
-SurgePricingPriorityQueue::TxStackComparator::txLessThan(
-    TransactionFrameBaseConstPtr const& tx1,
-    TransactionFrameBaseConstPtr const& tx2, bool breakTiesWithHash) const
+SurgePricingPriorityQueue::TxStackEntry::TxStackEntry(TxStackPtr txStack,
+                                                      size_t seed)
+    : mTxStack(std::move(txStack))
 {
-    auto cmp3 = feeRate3WayCompare(*tx1, *tx2);
-
-    if (cmp3 != 0 || !breakTiesWithHash)
-    {
-        return cmp3 < 0;
-    }
-    // break tie with pointer arithmetic
-    auto lx = reinterpret_cast<size_t>(tx1.get()) ^ mSeed;
-    auto rx = reinterpret_cast<size_t>(tx2.get()) ^ mSeed;
-    return lx < rx;
+    releaseAssert(mTxStack != nullptr && !mTxStack->empty());
+    auto const& topTx = mTxStack->getTopTx();
+    mFeeBid = topTx->getFeeBid();
+    mNumOps = topTx->getNumOperations();
+    mTieBreaker = reinterpret_cast<size_t>(topTx.get()) ^ seed;
 }
 
 SurgePricingPriorityQueue::SurgePricingPriorityQueue(
@@ -192,7 +180,8 @@ SurgePricingPriorityQueue::add(TxStackPtr txStack)
 {
     releaseAssert(txStack != nullptr);
     auto lane = mLaneConfig->getLane(*txStack->getTopTx());
-    bool inserted = mTxStackSets[lane].insert(txStack).second;
+    bool inserted =
+        mTxStackSets[lane].emplace(txStack, mComparator.getSeed()).second;
     if (inserted)
     {
         mLaneCurrentCount[lane] += txStack->getResources();
@@ -204,7 +193,8 @@ SurgePricingPriorityQueue::erase(TxStackPtr txStack)
 {
     releaseAssert(txStack != nullptr);
     auto lane = mLaneConfig->getLane(*txStack->getTopTx());
-    auto it = mTxStackSets[lane].find(txStack);
+    auto it =
+        mTxStackSets[lane].find(TxStackEntry(txStack, mComparator.getSeed()));
     if (it != mTxStackSets[lane].end())
     {
         erase(lane, it);
@@ -222,7 +212,7 @@ void
 SurgePricingPriorityQueue::erase(
     size_t lane, SurgePricingPriorityQueue::TxStackSet::iterator iter)
 {
-    auto res = (*iter)->getResources();
+    auto res = iter->mTxStack->getResources();
     releaseAssert(res <= mLaneCurrentCount[lane]);
     mLaneCurrentCount[lane] -= res;
     mTxStackSets[lane].erase(iter);
@@ -555,10 +545,10 @@ SurgePricingPriorityQueue::Iterator::getMutableInnerIter() const
     return best;
 }
 
-TxStackPtr
+TxStackPtr const&
 SurgePricingPriorityQueue::Iterator::operator*() const
 {
-    return *getMutableInnerIter()->second;
+    return getMutableInnerIter()->second->mTxStack;
 }
 
 SurgePricingPriorityQueue::LaneIter
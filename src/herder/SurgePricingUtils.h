@@ -32,7 +32,7 @@ class TxStack
 {
   public:
     // Gets the transaction on top of the stack.
-    virtual TransactionFrameBasePtr getTopTx() const = 0;
+    virtual TransactionFrameBasePtr const& getTopTx() const = 0;
     // Pops the transaction from top of the stack.
     virtual void popTopTx() = 0;
     // Returns the total number of resources in the stack.
@@ -216,33 +216,46 @@ class SurgePricingPriorityQueue
         std::vector<std::pair<TxStackPtr, bool>>& txStacksToEvict) const;
 
   private:
+    // Element of the per-lane `TxStackSet`s. It caches the ordering key of the
+    // stack's top transaction at the time the stack is added to the queue, so
+    // that the set comparisons don't need to go through the virtual `TxStack`
+    // interface (and copy the top transaction `shared_ptr`) on every step of
+    // the tree traversal.
+    // The stacks must not be modified while they belong to the queue, so the
+    // cached key stays valid until the entry is erased.
+    struct TxStackEntry
+    {
+        TxStackEntry(TxStackPtr txStack, size_t seed);
+
+        TxStackPtr mTxStack;
+        int64_t mFeeBid;
+        uint32_t mNumOps;
+        // Address of the top transaction XORed with the comparison seed, used
+        // to break the fee rate ties.
+        size_t mTieBreaker;
+    };
+
     class TxStackComparator
     {
       public:
         TxStackComparator(bool isGreater, size_t seed);
 
-        bool operator()(TxStackPtr const& txStack1,
-                        TxStackPtr const& txStack2) const;
+        bool operator()(TxStackEntry const& entry1,
+                        TxStackEntry const& entry2) const;
 
         bool compareFeeOnly(TransactionFrameBase const& tx1,
                             TransactionFrameBase const& tx2) const;
         bool compareFeeOnly(int64_t tx1Bid, uint32_t tx1Ops, int64_t tx2Bid,
                             uint32_t tx2Ops) const;
         bool isGreater() const;
+        size_t getSeed() const;
 
       private:
-        bool txStackLessThan(TxStack const& txStack1,
-                             TxStack const& txStack2) const;
-
-        bool txLessThan(TransactionFrameBaseConstPtr const& tx1,
-                        TransactionFrameBaseConstPtr const& tx2,
-                        bool breakTiesWithHash) const;
-
         bool const mIsGreater;
         size_t mSeed;
     };
 
-    using TxStackSet = std::set<TxStackPtr, TxStackComparator>;
+    using TxStackSet = std::set<TxStackEntry, TxStackComparator>;
     using LaneIter = std::pair<size_t, TxStackSet::iterator>;
 
     // Iterator for walking the queue from top to bottom, possibly restricted
@@ -254,7 +267,7 @@ class SurgePricingPriorityQueue
         Iterator(SurgePricingPriorityQueue const& parent,
                  std::vector<LaneIter> const& iters);
 
-        TxStackPtr operator*() const;
+        TxStackPtr const& operator*() const;
         // Gets the iterator of the `TxStackSet` corresponding to the current
         // value.
         LaneIter getInnerIter() const;
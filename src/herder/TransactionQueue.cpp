@@ -66,6 +66,10 @@ TransactionQueue::TransactionQueue(Application& app, uint32 pendingDepth,
           app.getMetrics().NewTimer({"herder", "pending-txs", "delay"}))
     , mTransactionsSelfDelay(
           app.getMetrics().NewTimer({"herder", "pending-txs", "self-delay"}))
+    , mFeeSourceBalanceCacheHit(app.getMetrics().NewMeter(
+          {"herder", "pending-txs", "fee-source-cache-hit"}, "transaction"))
+    , mFeeSourceBalanceCacheMiss(app.getMetrics().NewMeter(
+          {"herder", "pending-txs", "fee-source-cache-miss"}, "transaction"))
     , mBroadcastTimer(app)
 {
     mTxQueueLimiter =
@@ -101,8 +105,8 @@ TransactionQueue::~TransactionQueue()
 // `minFee` is set when returning false, and is the smallest fee
 // that would allow replace by fee to succeed in this situation
 static bool
-canReplaceByFee(TransactionFrameBasePtr tx, TransactionFrameBasePtr oldTx,
-                int64_t& minFee)
+canReplaceByFee(TransactionFrameBasePtr const& tx,
+                TransactionFrameBasePtr const& oldTx, int64_t& minFee)
 {
     int64_t newFee = tx->getFeeBid();
     uint32_t newNumOps = std::max<uint32_t>(1, tx->getNumOperations());
@@ -178,7 +182,7 @@ findBySeq(int64_t seq, std::optional<SequenceNumber const> minSeqNum,
 }
 
 static bool
-findBySeq(TransactionFrameBasePtr tx,
+findBySeq(TransactionFrameBasePtr const& tx,
           TransactionQueue::TimestampedTransactions& transactions,
           TransactionQueue::TimestampedTransactions::iterator& iter)
 {
@@ -186,7 +190,8 @@ findBySeq(TransactionFrameBasePtr tx,
 }
 
 static bool
-isDuplicateTx(TransactionFrameBasePtr oldTx, TransactionFrameBasePtr newTx)
+isDuplicateTx(TransactionFrameBasePtr const& oldTx,
+              TransactionFrameBasePtr const& newTx)
 {
     auto const& oldEnv = oldTx->getEnvelope();
     auto const& newEnv = newTx->getEnvelope();
@@ -211,7 +216,7 @@ TransactionQueue::sourceAccountPending(AccountID const& accountID) const
 }
 
 TransactionQueue::AddResult
-TransactionQueue::canAdd(TransactionFrameBasePtr tx,
+TransactionQueue::canAdd(TransactionFrameBasePtr const& tx,
                          AccountStates::iterator& stateIter,
                          TimestampedTransactions::iterator& txToReplaceIter,
                          std::vector<std::pair<TxStackPtr, bool>>& txsToEvict)
@@ -397,12 +402,12 @@ TransactionQueue::canAdd(TransactionFrameBasePtr tx,
 
     // Note: stateIter corresponds to getSourceID() which is not necessarily
     // the same as getFeeSourceID()
-    auto feeSource = stellar::loadAccount(ltx, tx->getFeeSourceID());
     auto feeStateIter = mAccountStates.find(tx->getFeeSourceID());
     int64_t totalFees = feeStateIter == mAccountStates.end()
                             ? 0
                             : feeStateIter->second.mTotalFees;
-    if (getAvailableBalance(ltx.loadHeader(), feeSource) - netFee < totalFees)
+    if (getFeeSourceAvailableBalance(tx->getFeeSourceID(), ltx) - netFee <
+        totalFees)
     {
         tx->getResult().result.code(txINSUFFICIENT_BALANCE);
         return TransactionQueue::AddResult::ADD_STATUS_ERROR;
@@ -411,8 +416,38 @@ TransactionQueue::canAdd(TransactionFrameBasePtr tx,
     return TransactionQueue::AddResult::ADD_STATUS_PENDING;
 }
 
+int64_t
+TransactionQueue::getFeeSourceAvailableBalance(AccountID const& feeSourceID,
+                                               AbstractLedgerTxn& ltx)
+{
+    // The queue validates against the last closed ledger state, so the
+    // balances can only change when a new ledger is closed.
+    auto lclSeq = mApp.getLedgerManager().getLastClosedLedgerNum();
+    if (lclSeq != mFeeSourceBalancesLedgerSeq)
+    {
+        mFeeSourceBalances.clear();
+        mFeeSourceBalancesLedgerSeq = lclSeq;
+    }
+
+    auto it = mFeeSourceBalances.find(feeSourceID);
+    if (it != mFeeSourceBalances.end())
+    {
+        mFeeSourceBalanceCacheHit.Mark();
+        return it->second;
+    }
+    mFeeSourceBalanceCacheMiss.Mark();
+    int64_t balance;
+    {
+        auto feeSource = stellar::loadAccount(ltx, feeSourceID);
+        balance = getAvailableBalance(ltx.loadHeader(), feeSource);
+    }
+    mFeeSourceBalances.emplace(feeSourceID, balance);
+    return balance;
+}
+
 void
-TransactionQueue::releaseFeeMaybeEraseAccountState(TransactionFrameBasePtr tx)
+TransactionQueue::releaseFeeMaybeEraseAccountState(
+    TransactionFrameBasePtr const& tx)
 {
     auto iter = mAccountStates.find(tx->getFeeSourceID());
     releaseAssert(iter != mAccountStates.end() &&
@@ -465,7 +500,7 @@ TransactionQueue::prepareDropTransaction(AccountState& as, TimestampedTx& tstx)
 // attempts, which users are (at the time of writing) flooding the network with.
 std::vector<AssetPair>
 TransactionQueue::findAllAssetPairsInvolvedInPaymentLoops(
-    TransactionFrameBasePtr tx)
+    TransactionFrameBasePtr const& tx)
 {
     std::map<Asset, size_t> assetToNum;
     std::vector<Asset> numToAsset;
@@ -554,7 +589,8 @@ TransactionQueue::findAllAssetPairsInvolvedInPaymentLoops(
 }
 
 TransactionQueue::AddResult
-TransactionQueue::tryAdd(TransactionFrameBasePtr tx, bool submittedFromSelf)
+TransactionQueue::tryAdd(TransactionFrameBasePtr const& tx,
+                         bool submittedFromSelf)
 {
     ZoneScoped;
     AccountStates::iterator stateIter;
@@ -745,7 +781,7 @@ TransactionQueue::removeApplied(Transactions const& appliedTxs)
 }
 
 static void
-findTx(TransactionFrameBasePtr tx,
+findTx(TransactionFrameBasePtr const& tx,
        TransactionQueue::TimestampedTransactions& transactions,
        TransactionQueue::TimestampedTransactions::iterator& txIter)
 {
@@ -976,6 +1012,17 @@ TransactionQueue::getTx(Hash const& hash) const
     }
 }
 
+void
+TransactionQueue::forEachKnownTx(
+    std::function<void(TransactionFrameBaseConstPtr const&)> const& f) const
+{
+    ZoneScoped;
+    for (auto const& [hash, tx] : mKnownTxHashes)
+    {
+        f(tx);
+    }
+}
+
 void
 TransactionQueue::clearAll()
 {
@@ -1172,7 +1219,7 @@ class TxQueueTracker : public TxStack
         releaseAssert(!empty());
     }
 
-    TransactionFrameBasePtr
+    TransactionFrameBasePtr const&
     getTopTx() const override
     {
         releaseAssert(!empty());
@@ -1496,7 +1543,7 @@ containsFilteredOperation(std::vector<Operation> const& ops,
 }
 
 bool
-TransactionQueue::isFiltered(TransactionFrameBasePtr tx) const
+TransactionQueue::isFiltered(TransactionFrameBasePtr const& tx) const
 {
     // Avoid cost of checking if filtering is not in use
     if (mFilteredTypes.empty())
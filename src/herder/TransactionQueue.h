@@ -18,12 +18,14 @@
 #include "util/UnorderedSet.h"
 #include <chrono>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <vector>
 
 namespace medida
 {
 class Counter;
+class Meter;
 class Timer;
 }
 
@@ -125,9 +127,9 @@ class TransactionQueue
     virtual ~TransactionQueue();
 
     static std::vector<AssetPair>
-    findAllAssetPairsInvolvedInPaymentLoops(TransactionFrameBasePtr tx);
+    findAllAssetPairsInvolvedInPaymentLoops(TransactionFrameBasePtr const& tx);
 
-    AddResult tryAdd(TransactionFrameBasePtr tx, bool submittedFromSelf);
+    AddResult tryAdd(TransactionFrameBasePtr const& tx, bool submittedFromSelf);
     void removeApplied(Transactions const& txs);
     void ban(Transactions const& txs);
 
@@ -144,6 +146,9 @@ class TransactionQueue
     size_t countBanned(int index) const;
     bool isBanned(Hash const& hash) const;
     TransactionFrameBaseConstPtr getTx(Hash const& hash) const;
+    void forEachKnownTx(
+        std::function<void(TransactionFrameBaseConstPtr const&)> const& f)
+        const;
 
     TxSetFrame::Transactions getTransactions(LedgerHeader const& lcl) const;
 
@@ -190,6 +195,15 @@ class TransactionQueue
     medida::Counter& mArbTxDroppedCounter;
     medida::Timer& mTransactionsDelay;
     medida::Timer& mTransactionsSelfDelay;
+    medida::Meter& mFeeSourceBalanceCacheHit;
+    medida::Meter& mFeeSourceBalanceCacheMiss;
+
+    // Available balances of the fee-source accounts that have been validated
+    // since the ledger `mFeeSourceBalancesLedgerSeq` has been closed. This
+    // allows validating repeated submissions from the same fee-source account
+    // without loading it from the ledger every time.
+    UnorderedMap<AccountID, int64_t> mFeeSourceBalances;
+    uint32_t mFeeSourceBalancesLedgerSeq{0};
 
     UnorderedSet<OperationType> mFilteredTypes;
 
@@ -212,12 +226,17 @@ class TransactionQueue
         BROADCAST_STATUS_SKIPPED
     };
     BroadcastStatus broadcastTx(AccountState& state, TimestampedTx& tx);
-    AddResult canAdd(TransactionFrameBasePtr tx,
+    AddResult canAdd(TransactionFrameBasePtr const& tx,
                      AccountStates::iterator& stateIter,
                      TimestampedTransactions::iterator& oldTxIter,
                      std::vector<std::pair<TxStackPtr, bool>>& txsToEvict);
 
-    void releaseFeeMaybeEraseAccountState(TransactionFrameBasePtr tx);
+    void releaseFeeMaybeEraseAccountState(TransactionFrameBasePtr const& tx);
+
+    // Returns the available balance of the fee-source account as of the last
+    // closed ledger, using the per-ledger cache when possible.
+    int64_t getFeeSourceAvailableBalance(AccountID const& feeSourceID,
+                                         AbstractLedgerTxn& ltx);
 
     void prepareDropTransaction(AccountState& as, TimestampedTx& tstx);
     void dropTransactions(AccountStates::iterator stateIter,
@@ -226,7 +245,7 @@ class TransactionQueue
 
     void clearAll();
 
-    bool isFiltered(TransactionFrameBasePtr tx) const;
+    bool isFiltered(TransactionFrameBasePtr const& tx) const;
 
     std::unique_ptr<TxQueueLimiter> mTxQueueLimiter;
     UnorderedMap<AssetPair, uint32_t, AssetPairHash> mArbitrageFloodDamping;
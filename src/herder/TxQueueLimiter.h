@@ -16,11 +16,11 @@ namespace stellar
 class SingleTxStack : public TxStack
 {
   public:
-    SingleTxStack(TransactionFrameBasePtr tx) : mTx(tx)
+    SingleTxStack(TransactionFrameBasePtr const& tx) : mTx(tx)
     {
     }
 
-    TransactionFrameBasePtr
+    TransactionFrameBasePtr const&
     getTopTx() const override
     {
         releaseAssert(mTx);
@@ -9,6 +9,7 @@
 #include "crypto/Random.h"
 #include "crypto/SHA.h"
 #include "database/Database.h"
+#include "herder/CompactTxSet.h"
 #include "herder/SurgePricingUtils.h"
 #include "ledger/LedgerManager.h"
 #include "ledger/LedgerTxn.h"
@@ -19,6 +20,7 @@
 #include "transactions/TransactionUtils.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
+#include "util/Math.h"
 #include "util/ProtocolVersion.h"
 #include "util/XDRCereal.h"
 #include "util/XDROperators.h"
@@ -770,6 +772,9 @@ TxSetFrame::encodedSize() const
         return *mEncodedSize;
     }
     ZoneScoped;
+    // Don't build the shared message just for its size: most tx sets are
+    // never requested by the peers, the message would be a second copy of
+    // their XDR kept as long as the frame.
     if (isGeneralizedTxSet())
     {
         GeneralizedTransactionSet encoded;
@@ -785,6 +790,72 @@ TxSetFrame::encodedSize() const
     return *mEncodedSize;
 }
 
+std::shared_ptr<StellarMessage const>
+TxSetFrame::toStellarMessage() const
+{
+    if (mStellarMessage)
+    {
+        return mStellarMessage;
+    }
+    ZoneScoped;
+    auto msg = std::make_shared<StellarMessage>();
+    if (isGeneralizedTxSet())
+    {
+        msg->type(GENERALIZED_TX_SET);
+        toXDR(msg->generalizedTxSet());
+    }
+    else
+    {
+        msg->type(TX_SET);
+        toXDR(msg->txSet());
+    }
+    mStellarMessage = msg;
+    return mStellarMessage;
+}
+
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+std::shared_ptr<StellarMessage const>
+TxSetFrame::toCompactStellarMessage() const
+{
+    if (mCompactStellarMessage)
+    {
+        return mCompactStellarMessage;
+    }
+    ZoneScoped;
+    releaseAssert(isGeneralizedTxSet());
+    auto msg = std::make_shared<StellarMessage>();
+    msg->type(COMPACT_TX_SET);
+    auto& compact = msg->compactTxSet();
+    compact.txSetHash = getContentsHash();
+    compact.shortIDSalt = rand_uniform<uint64_t>(
+        0, std::numeric_limits<uint64_t>::max());
+    CompactTxSetShortIDs shortIDs(compact.txSetHash, compact.shortIDSalt);
+
+    // Build the compact set from the XDR (rather than from the transaction
+    // frames) so that it mirrors exactly what the full message would contain.
+    auto const& xdrTxSet = toStellarMessage()->generalizedTxSet().v1TxSet();
+    compact.previousLedgerHash = xdrTxSet.previousLedgerHash;
+    for (auto const& phase : xdrTxSet.phases)
+    {
+        auto& compactPhase = compact.phases.emplace_back();
+        for (auto const& component : phase.v0Components())
+        {
+            auto const& txs = component.txsMaybeDiscountedFee();
+            auto& compactComponent = compactPhase.components.emplace_back();
+            compactComponent.baseFee = txs.baseFee;
+            compactComponent.shortTxIDs.reserve(txs.txs.size());
+            for (auto const& tx : txs.txs)
+            {
+                compactComponent.shortTxIDs.push_back(
+                    shortIDs(xdrSha256(tx)));
+            }
+        }
+    }
+    mCompactStellarMessage = msg;
+    return mCompactStellarMessage;
+}
+#endif
+
 void
 TxSetFrame::computeTxFeesForNonGeneralizedSet(
     LedgerHeader const& lclHeader) const
@@ -1046,6 +1117,11 @@ TxSetFrame::toXDR(TransactionSet& txSet) const
 {
     ZoneScoped;
     releaseAssert(!isGeneralizedTxSet());
+    if (mStellarMessage)
+    {
+        txSet = mStellarMessage->txSet();
+        return;
+    }
     releaseAssert(mTxPhases.size() == 1);
     auto& txs = mTxPhases[0];
     txSet.txs.resize(xdr::size32(txs.size()));
@@ -1062,6 +1138,11 @@ TxSetFrame::toXDR(GeneralizedTransactionSet& generalizedTxSet) const
 {
     ZoneScoped;
     releaseAssert(isGeneralizedTxSet());
+    if (mStellarMessage)
+    {
+        generalizedTxSet = mStellarMessage->generalizedTxSet();
+        return;
+    }
     releaseAssert(std::all_of(mFeesComputed.begin(), mFeesComputed.end(),
                               [](bool comp) { return comp; }));
     releaseAssert(mTxPhases.size() <= static_cast<size_t>(Phase::PHASE_COUNT));
@@ -156,6 +156,22 @@ class TxSetFrame : public NonMovableOrCopyable
     virtual void toXDR(TransactionSet& set) const;
     virtual void toXDR(GeneralizedTransactionSet& generalizedTxSet) const;
 
+    // Returns the `TX_SET` or `GENERALIZED_TX_SET` message containing this
+    // transaction set. The message is built on the first call and then kept
+    // for the subsequent responses to the peers and conversions to XDR, so
+    // that large tx sets requested by many peers don't get rebuilt from the
+    // transaction frames every time. Only call it to send the tx set.
+    std::shared_ptr<StellarMessage const> toStellarMessage() const;
+
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    // Returns the `COMPACT_TX_SET` message announcing this generalized
+    // transaction set by the short ids of its transactions. Just like
+    // `toStellarMessage`, the message is built once and then shared.
+    // The compact tx set messages are only defined in the current protocol
+    // XDR for now.
+    std::shared_ptr<StellarMessage const> toCompactStellarMessage() const;
+#endif
+
 #ifdef BUILD_TESTS
     // Test helper that only checks the XDR structure validitiy without
     // validating internal transactions.
@@ -189,6 +205,10 @@ class TxSetFrame : public NonMovableOrCopyable
 
     std::optional<Hash> mHash;
     std::optional<size_t> mutable mEncodedSize;
+    std::shared_ptr<StellarMessage const> mutable mStellarMessage;
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    std::shared_ptr<StellarMessage const> mutable mCompactStellarMessage;
+#endif
 
   private:
     bool addTxsFromXdr(Application& app,
@@ -85,7 +85,7 @@ AccountTransactionQueue::AccountTransactionQueue(
     }
 }
 
-TransactionFrameBasePtr
+TransactionFrameBasePtr const&
 AccountTransactionQueue::getTopTx() const
 {
     releaseAssert(!mTxs.empty());
@@ -19,7 +19,7 @@ class AccountTransactionQueue : public TxStack
     AccountTransactionQueue(
         std::vector<TransactionFrameBasePtr> const& accountTxs);
 
-    TransactionFrameBasePtr getTopTx() const override;
+    TransactionFrameBasePtr const& getTopTx() const override;
     bool empty() const override;
     void popTopTx() override;
     Resource getResources() const override;
@@ -7,6 +7,9 @@
 #include "herder/test/TestTxSetUtils.h"
 #include "main/Application.h"
 #include "main/Config.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
+#include "medida/timer.h"
 #include "scp/SCP.h"
 #include "simulation/Simulation.h"
 #include "simulation/Topologies.h"
@@ -45,6 +48,7 @@
 #include "xdrpp/marshal.h"
 #include <algorithm>
 #include <fmt/format.h>
+#include <future>
 #include <optional>
 
 using namespace stellar;
@@ -2549,6 +2553,24 @@ testSCPDriver(uint32 protocolVersion, uint32_t maxTxSetSize, size_t expectedOps)
             REQUIRE(scp.validateValue(seq, balV.first, false) ==
                     SCPDriver::kFullyValidatedValue);
         }
+        SECTION("cached")
+        {
+            auto& cached = app->getMetrics().NewMeter(
+                {"scp", "value", "cached"}, "value");
+            auto v = makeTxPair(herder, txSet0, ct + 1);
+            auto hits = cached.count();
+            REQUIRE(scp.validateValue(seq, v.first, true) ==
+                    SCPDriver::kFullyValidatedValue);
+            REQUIRE(cached.count() == hits);
+            REQUIRE(scp.validateValue(seq, v.first, false) ==
+                    SCPDriver::kFullyValidatedValue);
+            REQUIRE(cached.count() == hits + 1);
+
+            // results are not shared across slots
+            REQUIRE(scp.validateValue(seq + 1, v.first, true) !=
+                    SCPDriver::kFullyValidatedValue);
+            REQUIRE(cached.count() == hits + 1);
+        }
         SECTION("invalid")
         {
             auto checkInvalid = [&](StellarValue const& sv, bool nomination) {
@@ -2910,6 +2932,129 @@ TEST_CASE("SCP Driver", "[herder][acceptance]")
     }
 }
 
+TEST_CASE("background SCP envelope verification", "[herder]")
+{
+    Hash networkID = sha256(getTestConfig().NETWORK_PASSPHRASE);
+    auto s = Topologies::core(3, 1.0f, Simulation::OVER_LOOPBACK, networkID,
+                              [](int i) {
+                                  auto cfg = getTestConfig(i);
+                                  cfg.BACKGROUND_SCP_SIGNATURE_VERIFICATION =
+                                      true;
+                                  return cfg;
+                              });
+    s->startAllNodes();
+    s->crankUntil([&]() { return s->haveAllExternalized(4, 1); },
+                  5 * Herder::EXP_LEDGER_TIMESPAN_SECONDS, false);
+
+    for (auto const& node : s->getNodes())
+    {
+        auto& delay = node->getMetrics().NewTimer(
+            {"scp", "envelope", "verify-delay"});
+        auto& validSig = node->getMetrics().NewMeter(
+            {"scp", "envelope", "validsig"}, "envelope");
+        REQUIRE(delay.count() > 0);
+        REQUIRE(validSig.count() >= delay.count());
+    }
+    s->stopAllNodes();
+}
+
+TEST_CASE("background SCP envelope verification results", "[herder]")
+{
+    auto ska = SecretKey::pseudoRandomForTesting();
+    auto skb = SecretKey::pseudoRandomForTesting();
+    Config cfg(getTestConfig());
+    cfg.MANUAL_CLOSE = false;
+    cfg.BACKGROUND_SCP_SIGNATURE_VERIFICATION = true;
+    cfg.QUORUM_SET.validators.emplace_back(ska.getPublicKey());
+    cfg.QUORUM_SET.validators.emplace_back(skb.getPublicKey());
+
+    VirtualClock clock;
+    auto app = createTestApplication(clock, cfg);
+    auto& herder = static_cast<HerderImpl&>(app->getHerder());
+    auto const& lcl = app->getLedgerManager().getLastClosedLedgerHeader();
+
+    auto makeEnvelope = [&](SecretKey const& sk) {
+        auto txSet = TxSetFrame::makeEmpty(lcl);
+        StellarValue sv = herder.makeStellarValue(
+            txSet->getContentsHash(), lcl.header.scpValue.closeTime + 1,
+            emptyUpgradeSteps, sk);
+        SCPEnvelope envelope;
+        envelope.statement.slotIndex =
+            herder.trackingConsensusLedgerIndex() + 1;
+        envelope.statement.pledges.type(SCP_ST_NOMINATE);
+        envelope.statement.pledges.nominate().votes.emplace_back(
+            xdr::xdr_to_opaque(sv));
+        envelope.statement.nodeID = sk.getPublicKey();
+        herder.signEnvelope(sk, envelope);
+        return envelope;
+    };
+
+    std::optional<Herder::EnvelopeStatus> statusA;
+    std::optional<Herder::EnvelopeStatus> statusB;
+    auto recvA = [&](SCPEnvelope const& envelope) {
+        herder.recvSCPEnvelopeAsync(
+            envelope, [&](Herder::EnvelopeStatus res) { statusA = res; });
+    };
+    auto recvB = [&](SCPEnvelope const& envelope) {
+        herder.recvSCPEnvelopeAsync(
+            envelope, [&](Herder::EnvelopeStatus res) { statusB = res; });
+    };
+    auto crankUntilDone = [&]() {
+        auto timeout = clock.now() + std::chrono::seconds(10);
+        while ((!statusA || !statusB) && clock.now() < timeout)
+        {
+            clock.crank(true);
+        }
+        REQUIRE(statusA);
+        REQUIRE(statusB);
+    };
+
+    SECTION("invalid signatures are rejected")
+    {
+        auto& validSig = app->getMetrics().NewMeter(
+            {"scp", "envelope", "validsig"}, "envelope");
+        auto& invalidSig = app->getMetrics().NewMeter(
+            {"scp", "envelope", "invalidsig"}, "envelope");
+        auto validBefore = validSig.count();
+        auto invalidBefore = invalidSig.count();
+
+        auto badEnvelope = makeEnvelope(skb);
+        badEnvelope.signature[0] ^= 1;
+        recvA(makeEnvelope(ska));
+        recvB(badEnvelope);
+        REQUIRE(!statusA);
+        REQUIRE(!statusB);
+        crankUntilDone();
+
+        REQUIRE(*statusA != Herder::ENVELOPE_STATUS_DISCARDED);
+        REQUIRE(*statusB == Herder::ENVELOPE_STATUS_DISCARDED);
+        REQUIRE(validSig.count() == validBefore + 1);
+        REQUIRE(invalidSig.count() == invalidBefore + 1);
+    }
+    SECTION("envelopes are processed as soon as they are verified")
+    {
+        // Hold the verification thread, and let only one envelope wait for
+        // it: the second one is verified on the main thread, and processed
+        // before the first one.
+        std::promise<void> unblock;
+        auto blocked = unblock.get_future().share();
+        REQUIRE(herder.getSignatureVerifierForTesting());
+        herder.getSignatureVerifierForTesting()->post(
+            0, [blocked]() { blocked.wait(); });
+        herder.setMaxPendingSignatureChecksForTesting(1);
+
+        recvA(makeEnvelope(ska));
+        recvB(makeEnvelope(skb));
+        REQUIRE(!statusA);
+        REQUIRE(statusB);
+        REQUIRE(*statusB != Herder::ENVELOPE_STATUS_DISCARDED);
+
+        unblock.set_value();
+        crankUntilDone();
+        REQUIRE(*statusA != Herder::ENVELOPE_STATUS_DISCARDED);
+    }
+}
+
 TEST_CASE("SCP State", "[herder][acceptance]")
 {
     SecretKey nodeKeys[3];
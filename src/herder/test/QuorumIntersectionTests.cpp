@@ -44,7 +44,8 @@ TEST_CASE("quorum intersection basic 4-node", "[herder][quorumintersection]")
 
     Config cfg(getTestConfig());
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(qic->networkEnjoysQuorumIntersection());
 }
 
@@ -69,7 +70,8 @@ TEST_CASE("quorum non intersection basic 4-node",
 
     Config cfg(getTestConfig());
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(!qic->networkEnjoysQuorumIntersection());
 }
 
@@ -99,7 +101,8 @@ TEST_CASE("quorum non intersection 6-node", "[herder][quorumintersection]")
 
     Config cfg(getTestConfig());
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(!qic->networkEnjoysQuorumIntersection());
 }
 
@@ -146,7 +149,8 @@ TEST_CASE("quorum intersection 6-node with subquorums",
 
     Config cfg(getTestConfig());
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(qic->networkEnjoysQuorumIntersection());
 }
 
@@ -177,7 +181,8 @@ TEST_CASE("quorum non intersection basic 6-node",
 
     Config cfg(getTestConfig());
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(!qic->networkEnjoysQuorumIntersection());
 }
 
@@ -227,7 +232,8 @@ TEST_CASE("quorum non intersection 6-node with subquorums",
 
     Config cfg(getTestConfig());
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(!qic->networkEnjoysQuorumIntersection());
 }
 
@@ -303,7 +309,8 @@ TEST_CASE("quorum plausible non intersection", "[herder][quorumintersection]")
     qm[pkCOINQVEST2] = QuorumTracker::NodeInfo{qsCOINQVEST, 0};
 
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(!qic->networkEnjoysQuorumIntersection());
 }
 
@@ -441,7 +448,8 @@ TEST_CASE("quorum intersection 4-org fully-connected - elide all minquorums",
     Config cfg(getTestConfig());
     cfg = configureShortNames(cfg, orgs);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(qic->networkEnjoysQuorumIntersection());
 }
 
@@ -459,7 +467,8 @@ TEST_CASE("quorum intersection 3-org 3-node open line",
     Config cfg(getTestConfig());
     cfg = configureShortNames(cfg, orgs);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(!qic->networkEnjoysQuorumIntersection());
 }
 
@@ -476,7 +485,8 @@ TEST_CASE("quorum intersection 3-org 2-node open line",
     Config cfg(getTestConfig());
     cfg = configureShortNames(cfg, orgs);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(qic->networkEnjoysQuorumIntersection());
 }
 
@@ -496,7 +506,8 @@ TEST_CASE("quorum intersection 3-org 3-node closed ring",
     Config cfg(getTestConfig());
     cfg = configureShortNames(cfg, orgs);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(qic->networkEnjoysQuorumIntersection());
 }
 
@@ -521,7 +532,8 @@ TEST_CASE("quorum intersection 3-org 3-node closed one-way ring",
     Config cfg(getTestConfig());
     cfg = configureShortNames(cfg, orgs);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(!qic->networkEnjoysQuorumIntersection());
 }
 
@@ -546,7 +558,8 @@ TEST_CASE("quorum intersection 3-org 2-node closed one-way ring",
     Config cfg(getTestConfig());
     cfg = configureShortNames(cfg, orgs);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(qic->networkEnjoysQuorumIntersection());
 }
 
@@ -576,7 +589,8 @@ TEST_CASE("quorum intersection 3-org 2-node 2-of-3 asymmetric",
     Config cfg(getTestConfig());
     cfg = configureShortNames(cfg, orgs);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(qic->networkEnjoysQuorumIntersection());
 }
 
@@ -623,7 +637,8 @@ TEST_CASE("quorum intersection 8-org core-and-periphery dangling",
     Config cfg(getTestConfig());
     cfg = configureShortNames(cfg, orgs);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(!qic->networkEnjoysQuorumIntersection());
 }
 
@@ -676,7 +691,8 @@ TEST_CASE("quorum intersection 8-org core-and-periphery balanced",
     Config cfg(getTestConfig());
     cfg = configureShortNames(cfg, orgs);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(qic->networkEnjoysQuorumIntersection());
 }
 
@@ -724,7 +740,8 @@ TEST_CASE("quorum intersection 8-org core-and-periphery unbalanced",
     Config cfg(getTestConfig());
     cfg = configureShortNames(cfg, orgs);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(!qic->networkEnjoysQuorumIntersection());
 }
 
@@ -777,7 +794,8 @@ TEST_CASE("quorum intersection 6-org 1-node 4-null qsets",
     Config cfg(getTestConfig());
     cfg = configureShortNames(cfg, orgs);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(qic->networkEnjoysQuorumIntersection());
     REQUIRE(qic->getMaxQuorumsFound() == 0);
 }
@@ -823,7 +841,8 @@ TEST_CASE("quorum intersection 4-org 1-node 4-null qsets",
     Config cfg(getTestConfig());
     cfg = configureShortNames(cfg, orgs);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(qic->networkEnjoysQuorumIntersection());
     REQUIRE(qic->getMaxQuorumsFound() == 0);
 }
@@ -836,10 +855,92 @@ TEST_CASE("quorum intersection 6-org 3-node fully-connected",
     Config cfg(getTestConfig());
     cfg = configureShortNames(cfg, orgs);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(qic->networkEnjoysQuorumIntersection());
 }
 
+TEST_CASE("quorum intersection parallel search",
+          "[herder][quorumintersection]")
+{
+    Config cfg(getTestConfig());
+    cfg.QUORUM_INTERSECTION_CHECKER_THREADS = 4;
+    std::atomic<bool> flag{false};
+
+    SECTION("intersecting")
+    {
+        auto orgs = generateOrgs(6, {3});
+        auto qm =
+            interconnectOrgs(orgs, [](size_t i, size_t j) { return true; });
+        cfg = configureShortNames(cfg, orgs);
+        auto qic =
+            QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
+        REQUIRE(qic->networkEnjoysQuorumIntersection());
+    }
+    SECTION("split")
+    {
+        // Same as "8-org core-and-periphery dangling".
+        auto orgs = generateOrgs(8, {3, 3, 3, 3, 2, 2, 2, 2});
+        auto qm = interconnectOrgsBidir(orgs, {{0, 1},
+                                               {0, 2},
+                                               {0, 3},
+                                               {1, 2},
+                                               {1, 3},
+                                               {2, 3},
+                                               {0, 4},
+                                               {1, 5},
+                                               {2, 6},
+                                               {3, 7}});
+        cfg = configureShortNames(cfg, orgs);
+        auto qic =
+            QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
+        REQUIRE(!qic->networkEnjoysQuorumIntersection());
+        auto split = qic->getPotentialSplit();
+        REQUIRE(!split.first.empty());
+        REQUIRE(!split.second.empty());
+    }
+}
+
+TEST_CASE("quorum intersection reuses search results",
+          "[herder][quorumintersection]")
+{
+    auto orgs = generateOrgs(8, {3, 3, 3, 3, 2, 2, 2, 2});
+    auto qm = interconnectOrgsBidir(orgs, {{0, 1},
+                                           {0, 2},
+                                           {0, 3},
+                                           {1, 2},
+                                           {1, 3},
+                                           {2, 3},
+                                           {0, 4},
+                                           {1, 5},
+                                           {2, 6},
+                                           {3, 7}});
+    Config cfg(getTestConfig());
+    cfg = configureShortNames(cfg, orgs);
+    std::atomic<bool> flag{false};
+    auto cache = std::make_shared<QuorumIntersectionChecker::SearchCache>();
+    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag,
+                                                 gRandomEngine(), false, cache);
+    REQUIRE(!qic->networkEnjoysQuorumIntersection());
+
+    // A watcher outside of the SCC with quorums doesn't change the search, so
+    // the previous result is reused: the (interrupted) search isn't run again.
+    PublicKey watcher = SecretKey::pseudoRandomForTesting().getPublicKey();
+    qm[watcher] = QuorumTracker::NodeInfo{
+        make_shared<QS>(1, VK({orgs[0][0]}), VQ{}), 0};
+    flag = true;
+    auto qic2 = QuorumIntersectionChecker::create(
+        qm, cfg, flag, gRandomEngine(), false, cache);
+    REQUIRE(!qic2->networkEnjoysQuorumIntersection());
+    REQUIRE(qic2->getPotentialSplit() == qic->getPotentialSplit());
+
+    // Without the cache the search is interrupted.
+    auto qic3 =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
+    REQUIRE_THROWS_AS(qic3->networkEnjoysQuorumIntersection(),
+                      QuorumIntersectionChecker::InterruptedException);
+}
+
 TEST_CASE("quorum intersection scaling test",
           "[herder][quorumintersectionbench][!hide]")
 {
@@ -850,7 +951,8 @@ TEST_CASE("quorum intersection scaling test",
     Config cfg(getTestConfig());
     cfg = configureShortNames(cfg, orgs);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(qic->networkEnjoysQuorumIntersection());
 }
 
@@ -861,7 +963,8 @@ TEST_CASE("quorum intersection interruption", "[herder][quorumintersection]")
     Config cfg(getTestConfig());
     cfg = configureShortNames(cfg, orgs);
     std::atomic<bool> interruptFlag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, interruptFlag);
+    auto qic = QuorumIntersectionChecker::create(
+        qm, cfg, interruptFlag, gRandomEngine());
     std::thread canceller([&interruptFlag]() {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
         interruptFlag = true;
@@ -876,7 +979,8 @@ TEST_CASE("quorum intersection interruption", "[herder][quorumintersection]")
         interruptFlag = true;
     });
     REQUIRE_THROWS_AS(
-        qic->getIntersectionCriticalGroups(qm, cfg, interruptFlag),
+        qic->getIntersectionCriticalGroups(qm, cfg, interruptFlag,
+                                           gRandomEngine()),
         QuorumIntersectionChecker::InterruptedException);
     canceller2.join();
 }
@@ -960,11 +1064,12 @@ TEST_CASE("quorum intersection criticality",
     cfg = configureShortNames(cfg, orgs);
     debugQmap(cfg, qm);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(qic->networkEnjoysQuorumIntersection());
 
-    auto groups =
-        QuorumIntersectionChecker::getIntersectionCriticalGroups(qm, cfg, flag);
+    auto groups = QuorumIntersectionChecker::getIntersectionCriticalGroups(
+        qm, cfg, flag, gRandomEngine());
     REQUIRE(groups.size() == 1);
     REQUIRE(groups == std::set<std::set<PublicKey>>{{orgs[3][0]}});
 }
@@ -1023,7 +1128,8 @@ TEST_CASE("quorum intersection finds smaller SCC with quorums",
     cfg = configureShortNames(cfg, orgs);
     debugQmap(cfg, qm);
     std::atomic<bool> flag{false};
-    auto qic = QuorumIntersectionChecker::create(qm, cfg, flag);
+    auto qic =
+        QuorumIntersectionChecker::create(qm, cfg, flag, gRandomEngine());
     REQUIRE(qic->networkEnjoysQuorumIntersection());
     REQUIRE(qic->getMaxQuorumsFound() != 0);
 }
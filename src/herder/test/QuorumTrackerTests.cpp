@@ -10,6 +10,7 @@
 #include "scp/SCP.h"
 #include "test/TestUtils.h"
 #include "test/test.h"
+#include "util/Math.h"
 #include "xdr/Stellar-ledger.h"
 
 using namespace stellar;
@@ -352,3 +353,159 @@ TEST_CASE("quorum tracker closest validators", "[quorum][herder]")
         }
     }
 }
+
+TEST_CASE("quorum tracker incremental updates", "[quorum][herder]")
+{
+    std::vector<NodeID> nodes;
+    int const kNodesCount = 30;
+    for (int i = 0; i < kNodesCount; i++)
+    {
+        nodes.emplace_back(SecretKey::pseudoRandomForTesting().getPublicKey());
+    }
+    auto const& localNodeID = nodes[0];
+
+    // quorum sets known for each node, used by both the tracker under test and
+    // the reference one
+    UnorderedMap<NodeID, SCPQuorumSetPtr> qSets;
+    auto lookup = [&](NodeID const& node) -> SCPQuorumSetPtr {
+        auto it = qSets.find(node);
+        return it == qSets.end() ? nullptr : it->second;
+    };
+    auto makeQSet = [&](std::vector<int> const& validators) {
+        auto q = std::make_shared<SCPQuorumSet>();
+        for (auto i : validators)
+        {
+            q->validators.emplace_back(nodes[i]);
+        }
+        q->threshold = static_cast<uint32>(q->validators.size());
+        return q;
+    };
+    auto randomQSet = [&]() {
+        std::vector<int> validators;
+        auto count = rand_uniform<int>(0, 3);
+        for (int i = 0; i < count; i++)
+        {
+            validators.emplace_back(rand_uniform<int>(0, kNodesCount - 1));
+        }
+        return makeQSet(validators);
+    };
+
+    QuorumTracker qt(localNodeID);
+
+    auto checkMatchesRebuild = [&]() {
+        QuorumTracker ref(localNodeID);
+        ref.rebuild(lookup);
+        auto const& expected = ref.getQuorum();
+        auto const& actual = qt.getQuorum();
+        REQUIRE(actual.size() == expected.size());
+        for (auto const& kv : expected)
+        {
+            auto it = actual.find(kv.first);
+            REQUIRE(it != actual.end());
+            // `update` keeps the existing pointer for identical quorum sets
+            if (kv.second.mQuorumSet)
+            {
+                REQUIRE(it->second.mQuorumSet);
+                REQUIRE(*it->second.mQuorumSet == *kv.second.mQuorumSet);
+            }
+            else
+            {
+                REQUIRE(!it->second.mQuorumSet);
+            }
+            REQUIRE(it->second.mDistance == kv.second.mDistance);
+            REQUIRE(it->second.mClosestValidators ==
+                    kv.second.mClosestValidators);
+        }
+    };
+
+    auto setQSet = [&](int i, SCPQuorumSetPtr q) {
+        qSets[nodes[i]] = q;
+        return qt.update(nodes[i], q, lookup);
+    };
+
+    SECTION("chain")
+    {
+        // 0 -> 1 -> 2 -> 3 -> 4
+        for (int i = 0; i < 4; i++)
+        {
+            qSets[nodes[i]] = makeQSet({i + 1});
+        }
+        qt.rebuild(lookup);
+        REQUIRE(qt.getQuorum().size() == 5);
+
+        SECTION("shortcut decreases distances")
+        {
+            // 0 -> {1, 3}
+            REQUIRE(setQSet(0, makeQSet({1, 3})) != 0);
+            checkMatchesRebuild();
+            REQUIRE(qt.getQuorum().at(nodes[4]).mDistance == 2);
+            REQUIRE(qt.findClosestValidators(nodes[4]) ==
+                    std::set<NodeID>{nodes[3]});
+        }
+        SECTION("cut removes nodes")
+        {
+            // 1 -> {}
+            REQUIRE(setQSet(1, makeQSet({})) != 0);
+            checkMatchesRebuild();
+            REQUIRE(qt.getQuorum().size() == 2);
+            REQUIRE(!qt.isNodeDefinitelyInQuorum(nodes[3]));
+
+            // reconnecting uses `lookup` for the nodes coming back
+            REQUIRE(setQSet(1, makeQSet({2})) != 0);
+            checkMatchesRebuild();
+            REQUIRE(qt.getQuorum().size() == 5);
+        }
+        SECTION("alternate path increases distances")
+        {
+            // 0 -> {1, 5}, 5 -> 6 -> 3
+            qSets[nodes[5]] = makeQSet({6});
+            qSets[nodes[6]] = makeQSet({3});
+            REQUIRE(setQSet(0, makeQSet({1, 5})) != 0);
+            checkMatchesRebuild();
+            REQUIRE(qt.findClosestValidators(nodes[4]) ==
+                    std::set<NodeID>{nodes[1], nodes[5]});
+
+            // 1 -> {}: 3 and 4 are now only reachable through 5
+            REQUIRE(setQSet(1, makeQSet({})) != 0);
+            checkMatchesRebuild();
+            REQUIRE(qt.getQuorum().at(nodes[4]).mDistance == 4);
+            REQUIRE(qt.findClosestValidators(nodes[4]) ==
+                    std::set<NodeID>{nodes[5]});
+        }
+        SECTION("unchanged quorum set is free")
+        {
+            REQUIRE(setQSet(2, makeQSet({3})) == 0);
+            // nodes outside of the quorum don't impact it
+            REQUIRE(setQSet(10, makeQSet({0})) == 0);
+            checkMatchesRebuild();
+        }
+    }
+    SECTION("random updates")
+    {
+        for (int i = 0; i < kNodesCount; i++)
+        {
+            if (rand_flip())
+            {
+                qSets[nodes[i]] = randomQSet();
+            }
+        }
+        qSets[localNodeID] = makeQSet({1, 2, 3});
+        qt.rebuild(lookup);
+        checkMatchesRebuild();
+
+        for (int iter = 0; iter < 500; iter++)
+        {
+            // pick nodes in the quorum most of the time, as other updates
+            // are ignored
+            auto const& quorum = qt.getQuorum();
+            int i;
+            do
+            {
+                i = rand_uniform<int>(0, kNodesCount - 1);
+            } while (quorum.find(nodes[i]) == quorum.end() &&
+                     rand_uniform<int>(0, 9) != 0);
+            setQSet(i, rand_uniform<int>(0, 9) == 0 ? nullptr : randomQSet());
+            checkMatchesRebuild();
+        }
+    }
+}
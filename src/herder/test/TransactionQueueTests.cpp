@@ -2,6 +2,7 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "crypto/SHA.h"
 #include "crypto/SecretKey.h"
 #include "herder/Herder.h"
 #include "herder/HerderImpl.h"
@@ -17,10 +18,13 @@
 #include "test/test.h"
 #include "transactions/SignatureUtils.h"
 #include "transactions/TransactionUtils.h"
+#include "util/Math.h"
 #include "util/Timer.h"
 #include "util/numeric128.h"
 #include "xdr/Stellar-transaction.h"
 #include "xdrpp/autocheck.h"
+#include <medida/meter.h>
+#include <medida/metrics_registry.h>
 
 #include <chrono>
 #include <fmt/chrono.h>
@@ -858,6 +862,66 @@ TEST_CASE("TransactionQueue hitting the rate limit",
     }
 }
 
+TEST_CASE("TransactionQueue fee-source balance cache",
+          "[herder][transactionqueue]")
+{
+    VirtualClock clock;
+    auto cfg = getTestConfig();
+    auto app = createTestApplication(clock, cfg);
+
+    auto root = TestAccount::createRoot(*app);
+    // Leave the account an available balance of exactly 3 fees
+    int64_t const fee = 100;
+    auto account1 =
+        root.create("a1", app->getLedgerManager().getLastMinBalance(0) +
+                              3 * fee);
+
+    auto& hits = app->getMetrics().NewMeter(
+        {"herder", "pending-txs", "fee-source-cache-hit"}, "transaction");
+    auto& misses = app->getMetrics().NewMeter(
+        {"herder", "pending-txs", "fee-source-cache-miss"}, "transaction");
+    auto hitsBefore = hits.count();
+    auto missesBefore = misses.count();
+
+    TransactionQueueTest testQueue{*app};
+    testQueue.add(transaction(*app, account1, 1, 1, fee),
+                  TransactionQueue::AddResult::ADD_STATUS_PENDING);
+    REQUIRE(misses.count() == missesBefore + 1);
+    REQUIRE(hits.count() == hitsBefore);
+
+    SECTION("repeated fee source within a ledger")
+    {
+        testQueue.add(transaction(*app, account1, 2, 1, fee),
+                      TransactionQueue::AddResult::ADD_STATUS_PENDING);
+        testQueue.add(transaction(*app, account1, 3, 1, fee),
+                      TransactionQueue::AddResult::ADD_STATUS_PENDING);
+        REQUIRE(misses.count() == missesBefore + 1);
+        REQUIRE(hits.count() == hitsBefore + 2);
+
+        // The cached balance still accounts for the queued fees
+        auto tx = transaction(*app, account1, 4, 1, fee);
+        testQueue.add(tx, TransactionQueue::AddResult::ADD_STATUS_ERROR);
+        REQUIRE(tx->getResult().result.code() == txINSUFFICIENT_BALANCE);
+        REQUIRE(hits.count() == hitsBefore + 3);
+    }
+    SECTION("invalidated by a ledger close changing the balance")
+    {
+        // Spend 2 of the 3 fees (1 in fee, 1 in payment) in the next ledger
+        auto payTx = account1.tx({payment(root, fee)});
+        auto r = closeLedger(*app, {payTx});
+        checkTx(0, r, txSUCCESS);
+        REQUIRE(account1.getAvailableBalance() == fee);
+
+        // With the balance cached before the close, the queued transaction
+        // and this one would still be affordable
+        auto tx = transaction(*app, account1, 1, 1, fee);
+        testQueue.add(tx, TransactionQueue::AddResult::ADD_STATUS_ERROR);
+        REQUIRE(tx->getResult().result.code() == txINSUFFICIENT_BALANCE);
+        REQUIRE(misses.count() == missesBefore + 2);
+        REQUIRE(hits.count() == hitsBefore);
+    }
+}
+
 TEST_CASE_VERSIONS("TransactionQueue with PreconditionsV2",
                    "[herder][transactionqueue]")
 {
@@ -3037,3 +3101,157 @@ TEST_CASE("arbitrage tx identification benchmark",
     LOG_INFO(DEFAULT_LOG, "executed 100 loop-checks of 600-op tx loop in {}",
              ch::duration_cast<ch::milliseconds>(end - start));
 }
+
+TEST_CASE("surge pricing queue benchmark",
+          "[herder][transactionqueue][surgepricing][bench][!hide]")
+{
+    // This test benchmarks the `SurgePricingPriorityQueue` operations that are
+    // performed for every transaction admitted to the queue (add, erase,
+    // eviction checks) and during the tx set building (popping the top
+    // transactions within the lane limits) at various queue sizes.
+    // Most of the generated transactions bid the base fee or close to it, with
+    // a long tail of higher bids, roughly matching the fee distribution
+    // observed during surge pricing. About 10% of transactions contain DEX
+    // operations and the DEX lane is sized to fit exactly those.
+    namespace ch = std::chrono;
+    using clock = ch::high_resolution_clock;
+
+    Asset xlm = makeNativeAsset();
+    Asset usd = makeAsset(getAccount("issuer"), "USD");
+    PublicKey dest = getAccount("dest").getPublicKey();
+
+    size_t sourceIndex = 0;
+    auto generateTxs = [&](size_t count, int64_t& totalOps, int64_t& dexOps) {
+        std::vector<TransactionFrameBasePtr> txs;
+        txs.reserve(count);
+        totalOps = 0;
+        dexOps = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            TransactionEnvelope env;
+            env.type(ENVELOPE_TYPE_TX);
+            auto& tx = env.v1().tx;
+            PublicKey source;
+            source.ed25519() = sha256(fmt::format("source{}", sourceIndex++));
+            tx.sourceAccount = toMuxedAccount(source);
+            tx.seqNum = 1;
+
+            uint32_t nbOps = rand_flip() ? 1 : rand_uniform<uint32_t>(1, 10);
+            bool isDex = rand_uniform<int>(0, 9) == 0;
+            for (uint32_t j = 0; j < nbOps; ++j)
+            {
+                tx.operations.emplace_back(
+                    isDex ? pathPayment(dest, xlm, 100, usd, 100, {})
+                          : payment(dest, 100));
+            }
+            // Half of the transactions bid the base fee, and every following
+            // fee rate bracket is half as likely as the previous one.
+            uint32_t feeRateBracket = 0;
+            while (feeRateBracket < 10 && rand_flip())
+            {
+                ++feeRateBracket;
+            }
+            uint32_t feeRate = 100 << feeRateBracket;
+            if (feeRateBracket > 0)
+            {
+                feeRate += rand_uniform<uint32_t>(0, feeRate - 1);
+            }
+            tx.fee = feeRate * nbOps;
+
+            totalOps += nbOps;
+            if (isDex)
+            {
+                dexOps += nbOps;
+            }
+            txs.emplace_back(std::make_shared<TransactionFrame>(Hash(), env));
+        }
+        return txs;
+    };
+    auto toStacks = [](std::vector<TransactionFrameBasePtr> const& txs) {
+        std::vector<TxStackPtr> stacks;
+        stacks.reserve(txs.size());
+        for (auto const& tx : txs)
+        {
+            stacks.emplace_back(std::make_shared<SingleTxStack>(tx));
+        }
+        return stacks;
+    };
+    auto perOp = [](clock::duration d, size_t count) {
+        return ch::duration_cast<ch::nanoseconds>(d) /
+               std::max<size_t>(count, 1);
+    };
+
+    for (size_t queueSize : std::vector<size_t>{1'000, 10'000, 100'000,
+                                                1'000'000})
+    {
+        int64_t totalOps = 0;
+        int64_t dexOps = 0;
+        auto txs = generateTxs(queueSize, totalOps, dexOps);
+        int64_t candidateOps = 0;
+        int64_t candidateDexOps = 0;
+        auto candidates = generateTxs(std::min<size_t>(queueSize, 10'000),
+                                      candidateOps, candidateDexOps);
+
+        // Queue that is filled exactly up to the limits, as in
+        // `TxQueueLimiter`.
+        auto laneConfig = std::make_shared<DexLimitingLaneConfig>(
+            Resource(totalOps), std::make_optional<Resource>(dexOps));
+        SurgePricingPriorityQueue queue(
+            /* isHighestPriority */ false, laneConfig,
+            rand_uniform<size_t>(0, std::numeric_limits<size_t>::max()));
+        auto stacks = toStacks(txs);
+
+        auto start = clock::now();
+        for (auto const& stack : stacks)
+        {
+            queue.add(stack);
+        }
+        auto addTime = clock::now() - start;
+        REQUIRE(queue.totalResources() == Resource(totalOps));
+
+        size_t fitCount = 0;
+        start = clock::now();
+        for (auto const& tx : candidates)
+        {
+            std::vector<std::pair<TxStackPtr, bool>> txsToEvict;
+            if (queue.canFitWithEviction(*tx, std::nullopt, txsToEvict).first)
+            {
+                ++fitCount;
+            }
+        }
+        auto canFitTime = clock::now() - start;
+
+        stellar::shuffle(stacks.begin(), stacks.end(), gRandomEngine);
+        start = clock::now();
+        for (auto const& stack : stacks)
+        {
+            queue.erase(stack);
+        }
+        auto eraseTime = clock::now() - start;
+        REQUIRE(queue.totalResources() == Resource(0));
+
+        // Select the top half of the operations, as during the tx set
+        // building.
+        auto popStacks = toStacks(txs);
+        auto popConfig = std::make_shared<DexLimitingLaneConfig>(
+            Resource(totalOps / 2), std::make_optional<Resource>(dexOps / 2));
+        std::vector<bool> hadTxNotFittingLane;
+        start = clock::now();
+        auto selected = SurgePricingPriorityQueue::getMostTopTxsWithinLimits(
+            popStacks, popConfig, hadTxNotFittingLane);
+        auto popTime = clock::now() - start;
+
+        LOG_INFO(DEFAULT_LOG,
+                 "queue size {} ({} ops): add {} ({}/tx), "
+                 "canFitWithEviction {} ({}/tx, {} fit), erase {} ({}/tx), "
+                 "popTopTxs {} ({} txs selected)",
+                 queueSize, totalOps,
+                 ch::duration_cast<ch::milliseconds>(addTime),
+                 perOp(addTime, stacks.size()),
+                 ch::duration_cast<ch::milliseconds>(canFitTime),
+                 perOp(canFitTime, candidates.size()), fitCount,
+                 ch::duration_cast<ch::milliseconds>(eraseTime),
+                 perOp(eraseTime, stacks.size()),
+                 ch::duration_cast<ch::milliseconds>(popTime), selected.size());
+    }
+}
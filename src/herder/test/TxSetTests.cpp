@@ -2,6 +2,9 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "crypto/SHA.h"
+#include "herder/CompactTxSet.h"
+#include "herder/Herder.h"
 #include "herder/TxSetFrame.h"
 #include "herder/test/TestTxSetUtils.h"
 #include "ledger/LedgerManager.h"
@@ -438,12 +441,7 @@ TEST_CASE("generalized tx set XDR validation", "[txset]")
 TEST_CASE("generalized tx set XDR conversion", "[txset]")
 {
     VirtualClock clock;
-    auto cfg = getTestConfig();
-    cfg.LEDGER_PROTOCOL_VERSION =
-        static_cast<uint32_t>(GENERALIZED_TX_SET_PROTOCOL_VERSION);
-    cfg.TESTING_UPGRADE_LEDGER_PROTOCOL_VERSION =
-        static_cast<uint32_t>(GENERALIZED_TX_SET_PROTOCOL_VERSION);
-    Application::pointer app = createTestApplication(clock, cfg);
+    Application::pointer app = createTestApplication(clock, getTestConfig());
     auto root = TestAccount::createRoot(*app);
     auto createTxs = [&](int cnt, int fee) {
         std::vector<TransactionFrameBasePtr> txs;
@@ -464,6 +462,17 @@ TEST_CASE("generalized tx set XDR conversion", "[txset]")
         GeneralizedTransactionSet newXdr;
         frame->toXDR(newXdr);
         REQUIRE(newXdr == txSetXdr);
+
+        // The size doesn't need the wire message, which is built once when
+        // sending the tx set and then shared.
+        REQUIRE(frame->encodedSize() == xdr::xdr_argpack_size(txSetXdr));
+        auto msg = frame->toStellarMessage();
+        REQUIRE(msg->type() == GENERALIZED_TX_SET);
+        REQUIRE(msg->generalizedTxSet() == txSetXdr);
+        REQUIRE(frame->toStellarMessage() == msg);
+        GeneralizedTransactionSet cachedXdr;
+        frame->toXDR(cachedXdr);
+        REQUIRE(cachedXdr == txSetXdr);
     };
 
     SECTION("empty set")
@@ -553,7 +562,11 @@ TEST_CASE("generalized tx set XDR conversion", "[txset]")
             txs.push_back(root.tx({createAccount(
                 getAccount(std::to_string(i)).getPublicKey(), 1)}));
         }
-        auto txSet = TxSetFrame::makeFromTransactions(txs, *app, 0, 0);
+        // Generalized tx sets can't be built for the current protocol yet, so
+    // build a single phase one directly from the XDR.
+    auto txSet = testtxset::makeNonValidatedGeneralizedTxSet(
+        {{std::make_pair(std::nullopt, txs)}}, *app,
+        app->getLedgerManager().getLastClosedLedgerHeader().hash);
 
         GeneralizedTransactionSet txSetXdr;
         txSet->toXDR(txSetXdr);
@@ -639,12 +652,7 @@ TEST_CASE("generalized tx set with multiple txs per source account", "[txset]")
 TEST_CASE("generalized tx set fees", "[txset]")
 {
     VirtualClock clock;
-    auto cfg = getTestConfig();
-    cfg.LEDGER_PROTOCOL_VERSION =
-        static_cast<uint32_t>(GENERALIZED_TX_SET_PROTOCOL_VERSION);
-    cfg.TESTING_UPGRADE_LEDGER_PROTOCOL_VERSION =
-        static_cast<uint32_t>(GENERALIZED_TX_SET_PROTOCOL_VERSION);
-    Application::pointer app = createTestApplication(clock, cfg);
+    Application::pointer app = createTestApplication(clock, getTestConfig());
     auto root = TestAccount::createRoot(*app);
     int accountId = 1;
 
@@ -713,5 +721,95 @@ TEST_CASE("generalized tx set fees", "[txset]")
 }
 #endif
 
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+TEST_CASE("compact tx set reconstruction", "[txset]")
+{
+    VirtualClock clock;
+    Application::pointer app = createTestApplication(clock, getTestConfig());
+    auto root = TestAccount::createRoot(*app);
+
+    std::vector<TransactionFrameBasePtr> txs;
+    for (int i = 0; i < 6; ++i)
+    {
+        auto account =
+            root.create("compact " + std::to_string(i),
+                        app->getLedgerManager().getLastMinBalance(2));
+        txs.push_back(account.tx({payment(root, 1)}));
+    }
+    // Generalized tx sets can't be built for the current protocol yet, so
+    // build a single phase one directly from the XDR.
+    auto txSet = testtxset::makeNonValidatedGeneralizedTxSet(
+        {{std::make_pair(std::nullopt, txs)}}, *app,
+        app->getLedgerManager().getLastClosedLedgerHeader().hash);
+    REQUIRE(txSet->sizeTxTotal() == txs.size());
+
+    auto compactMsg = txSet->toCompactStellarMessage();
+    REQUIRE(compactMsg == txSet->toCompactStellarMessage());
+    auto const& compact = compactMsg->compactTxSet();
+    REQUIRE(compact.txSetHash == txSet->getContentsHash());
+
+    std::vector<TransactionEnvelope> envelopes;
+    GeneralizedTransactionSet txSetXdr;
+    txSet->toXDR(txSetXdr);
+    for (auto const& phase : txSetXdr.v1TxSet().phases)
+    {
+        for (auto const& component : phase.v0Components())
+        {
+            for (auto const& tx : component.txsMaybeDiscountedFee().txs)
+            {
+                envelopes.push_back(tx);
+            }
+        }
+    }
+
+    auto checkReconstructed = [&](CompactTxSetReconstructor& reconstructor) {
+        REQUIRE(reconstructor.isComplete());
+        auto reconstructed =
+            TxSetFrame::makeFromWire(*app, reconstructor.finish());
+        REQUIRE(reconstructed->getContentsHash() == txSet->getContentsHash());
+    };
+
+    SECTION("all transactions known")
+    {
+        for (auto const& tx : txs)
+        {
+            REQUIRE(app->getHerder().recvTransaction(tx, false) ==
+                    TransactionQueue::AddResult::ADD_STATUS_PENDING);
+        }
+        CompactTxSetReconstructor reconstructor(compact, app->getHerder());
+        checkReconstructed(reconstructor);
+    }
+    SECTION("missing transactions")
+    {
+        for (size_t i = 0; i < txs.size(); i += 2)
+        {
+            REQUIRE(app->getHerder().recvTransaction(txs[i], false) ==
+                    TransactionQueue::AddResult::ADD_STATUS_PENDING);
+        }
+        CompactTxSetReconstructor reconstructor(compact, app->getHerder());
+        auto const& missing = reconstructor.getMissingIndices();
+        REQUIRE(missing.size() == txs.size() / 2);
+
+        xdr::xvector<TransactionEnvelope> missingTxs;
+        for (auto index : missing)
+        {
+            REQUIRE(!app->getHerder().getTx(xdrSha256(envelopes[index])));
+            missingTxs.push_back(envelopes[index]);
+        }
+        SECTION("fetched transactions match")
+        {
+            REQUIRE(reconstructor.addMissingTransactions(missingTxs));
+            checkReconstructed(reconstructor);
+        }
+        SECTION("fetched transactions don't match")
+        {
+            missingTxs.pop_back();
+            REQUIRE(!reconstructor.addMissingTransactions(missingTxs));
+            REQUIRE(!reconstructor.isComplete());
+        }
+    }
+}
+#endif
+
 } // namespace
 } // namespace stellar
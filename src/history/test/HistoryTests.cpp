@@ -4,7 +4,9 @@
 
 #include "bucket/BucketManager.h"
 #include "bucket/test/BucketTestUtils.h"
+#include "catchup/ApplyCheckpointWork.h"
 #include "catchup/test/CatchupWorkTests.h"
+#include "crypto/SecretKey.h"
 #include "history/FileTransferInfo.h"
 #include "history/HistoryArchiveManager.h"
 #include "history/HistoryManager.h"
@@ -22,6 +24,7 @@
 #include "test/TxTests.h"
 #include "test/test.h"
 #include "util/Fs.h"
+#include "util/Gzip.h"
 #include "util/Logging.h"
 #include "work/WorkScheduler.h"
 
@@ -101,6 +104,17 @@ TEST_CASE("HistoryManager compress", "[history]")
     REQUIRE(u->getState() == BasicWork::State::WORK_SUCCESS);
     REQUIRE(fs::exists(fname));
     REQUIRE(!fs::exists(compressed));
+    {
+        std::ifstream in(fname, std::ifstream::binary);
+        std::string content((std::istreambuf_iterator<char>(in)),
+                            std::istreambuf_iterator<char>());
+        REQUIRE(content == s);
+    }
+
+    // uncompressed data is rejected
+    REQUIRE(std::rename(fname.c_str(), compressed.c_str()) == 0);
+    auto u2 = wm.executeWork<GunzipFileWork>(compressed);
+    REQUIRE(u2->getState() == BasicWork::State::WORK_FAILURE);
 }
 
 TEST_CASE("HistoryArchiveState get_put", "[history]")
@@ -314,7 +328,7 @@ TEST_CASE("Ledger chain verification", "[ledgerheaderverification]")
             HistoryManager::VERIFY_STATUS_OK);
         FileTransferInfo ft(tmpDir, HISTORY_FILE_TYPE_LEDGER,
                             last.header.ledgerSeq);
-        std::remove(ft.localPath_nogz().c_str());
+        std::remove(ft.localPath_gz().c_str());
 
         // No crash
         checkExpectedBehavior(BasicWork::State::WORK_FAILURE, lcl, last);
@@ -345,7 +359,7 @@ TEST_CASE("Tx results verification", "[batching][resultsverification]")
     SECTION("header file missing")
     {
         FileTransferInfo ft(tmpDir, HISTORY_FILE_TYPE_LEDGER, range.last());
-        std::remove(ft.localPath_nogz().c_str());
+        std::remove(ft.localPath_gz().c_str());
         auto verify =
             wm.executeWork<DownloadVerifyTxResultsWork>(range, tmpDir);
         REQUIRE(verify->getState() == BasicWork::State::WORK_FAILURE);
@@ -354,7 +368,7 @@ TEST_CASE("Tx results verification", "[batching][resultsverification]")
     {
         FileTransferInfo ft(tmpDir, HISTORY_FILE_TYPE_LEDGER, range.last());
         XDRInputFileStream res;
-        res.open(ft.localPath_nogz());
+        res.open(ft.localPath_gz());
         std::vector<LedgerHeaderHistoryEntry> entries;
         LedgerHeaderHistoryEntry curr;
         while (res && res.readOne(curr))
@@ -365,7 +379,7 @@ TEST_CASE("Tx results verification", "[batching][resultsverification]")
         REQUIRE_FALSE(entries.empty());
         auto& lastEntry = entries.at(entries.size() - 1);
         lastEntry.header.txSetResultHash = HashUtils::random();
-        std::remove(ft.localPath_nogz().c_str());
+        std::remove(ft.localPath_gz().c_str());
 
         XDROutputFileStream out(
             catchupSimulation.getApp().getClock().getIOContext(), true);
@@ -375,6 +389,7 @@ TEST_CASE("Tx results verification", "[batching][resultsverification]")
             out.writeOne(item);
         }
         out.close();
+        gzipFile(ft.localPath_nogz(), ft.localPath_gz());
 
         auto verify =
             wm.executeWork<DownloadVerifyTxResultsWork>(range, tmpDir);
@@ -388,7 +403,7 @@ TEST_CASE("Tx results verification", "[batching][resultsverification]")
 
         FileTransferInfo ft(tmpDir, HISTORY_FILE_TYPE_RESULTS, range.last());
         XDRInputFileStream res;
-        res.open(ft.localPath_nogz());
+        res.open(ft.localPath_gz());
         std::vector<TransactionHistoryResultEntry> entries;
         TransactionHistoryResultEntry curr;
         while (res && res.readOne(curr))
@@ -397,7 +412,7 @@ TEST_CASE("Tx results verification", "[batching][resultsverification]")
         }
         res.close();
         REQUIRE_FALSE(entries.empty());
-        std::remove(ft.localPath_nogz().c_str());
+        std::remove(ft.localPath_gz().c_str());
 
         XDROutputFileStream out(
             catchupSimulation.getApp().getClock().getIOContext(), true);
@@ -408,6 +423,7 @@ TEST_CASE("Tx results verification", "[batching][resultsverification]")
             out.writeOne(entries[0]);
         }
         out.close();
+        gzipFile(ft.localPath_nogz(), ft.localPath_gz());
 
         auto verify = wm.executeWork<VerifyTxResultsWork>(tmpDir, range.last());
         REQUIRE(verify->getState() == BasicWork::State::WORK_FAILURE);
@@ -1351,6 +1367,47 @@ TEST_CASE("Catchup manual", "[history][catchup][acceptance]")
     }
 }
 
+TEST_CASE("Catchup verifies signatures ahead", "[history][catchup]")
+{
+    REQUIRE(ApplyCheckpointWork::REPLAY_LOOKAHEAD_LEDGERS > 0);
+    CatchupSimulation catchupSimulation{};
+    auto checkpointLedger = catchupSimulation.getLastCheckpointLedger(2);
+    catchupSimulation.ensureOfflineCatchupPossible(checkpointLedger);
+    auto app = catchupSimulation.createCatchupApplication(
+        std::numeric_limits<uint32_t>::max(), Config::TESTDB_IN_MEMORY_SQLITE,
+        "app");
+
+    // The signatures were already verified when the ledgers were generated,
+    // and the verification cache is shared by all the applications
+    PubKeyUtils::clearVerifySigCache();
+    uint64_t hits = 0, misses = 0;
+    PubKeyUtils::flushVerifySigCacheCounts(hits, misses);
+
+    // The cache counts are flushed into the metrics of any application
+    auto hitCount = [&]() {
+        return app->getMetrics()
+                   .NewMeter({"crypto", "verify", "hit"}, "signature")
+                   .count() +
+               catchupSimulation.getApp()
+                   .getMetrics()
+                   .NewMeter({"crypto", "verify", "hit"}, "signature")
+                   .count();
+    };
+    auto& txApply =
+        app->getMetrics().NewTimer({"ledger", "transaction", "apply"});
+    auto hitsBefore = hitCount();
+    auto appliedBefore = txApply.count();
+
+    REQUIRE(catchupSimulation.catchupOffline(app, checkpointLedger));
+    PubKeyUtils::flushVerifySigCacheCounts(hits, misses);
+
+    // Signatures verified ahead are found in the cache when applying. The
+    // lookahead of the last ledgers may still be running, don't count them.
+    auto applied = txApply.count() - appliedBefore;
+    REQUIRE(applied > 0);
+    REQUIRE(hitCount() - hitsBefore + hits >= applied / 2);
+}
+
 // Check that initializing a history store that already exists, fails.
 TEST_CASE("initialize existing history store fails", "[history]")
 {
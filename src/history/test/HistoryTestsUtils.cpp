@@ -20,6 +20,7 @@
 #include "test/TestUtils.h"
 #include "test/TxTests.h"
 #include "test/test.h"
+#include "util/Gzip.h"
 #include "util/Math.h"
 #include "util/XDROperators.h"
 #include "work/WorkScheduler.h"
@@ -249,6 +250,9 @@ TestLedgerChainGenerator::createHistoryFiles(
         last = ledger;
     }
     ledgerOut.close();
+    // checkpoint files are consumed compressed
+    gzipFile(ft.localPath_nogz(), ft.localPath_gz());
+    std::remove(ft.localPath_nogz().c_str());
 }
 
 TestLedgerChainGenerator::CheckpointEnds
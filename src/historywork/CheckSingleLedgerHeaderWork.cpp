@@ -93,7 +93,7 @@ CheckSingleLedgerHeaderWork::doWork()
     // transitions, but a ledger header file is 30kb: reading it synchronously
     // is nearly instant.
     XDRInputFileStream in;
-    in.open(mFt->localPath_nogz());
+    in.open(mFt->localPath_gz());
     LedgerHeaderHistoryEntry lhhe;
     size_t headersToRead = mApp.getHistoryManager().getCheckpointFrequency();
     try
@@ -104,7 +104,7 @@ CheckSingleLedgerHeaderWork::doWork()
             {
                 CLOG_ERROR(History,
                            "Read too many headers from file {} from archive {}",
-                           mFt->localPath_nogz(), mArchive->getName());
+                           mFt->localPath_gz(), mArchive->getName());
                 return State::WORK_FAILURE;
             }
             --headersToRead;
@@ -143,13 +143,13 @@ CheckSingleLedgerHeaderWork::doWork()
     catch (xdr::xdr_runtime_error& e)
     {
         CLOG_ERROR(History, "XDR error decoding {} from archive {}: {}",
-                   mFt->localPath_nogz(), mArchive->getName(), e.what());
+                   mFt->localPath_gz(), mArchive->getName(), e.what());
         return State::WORK_FAILURE;
     }
     catch (FileSystemException& e)
     {
         CLOG_ERROR(History, "Error opening {} from archive {}: {}",
-                   mFt->localPath_nogz(), mArchive->getName(), e.what());
+                   mFt->localPath_gz(), mArchive->getName(), e.what());
         return State::WORK_FAILURE;
     }
     CLOG_ERROR(History, "Failed to find ledger header {} in archive {}",
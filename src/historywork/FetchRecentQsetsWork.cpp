@@ -78,7 +78,7 @@ FetchRecentQsetsWork::doWork()
         FileTransferInfo fi(*mDownloadDir, HISTORY_FILE_TYPE_SCP, i);
         try
         {
-            in.open(fi.localPath_nogz());
+            in.open(fi.localPath_gz());
         }
         catch (FileSystemException&)
         {
@@ -22,6 +22,7 @@ GetAndUnzipRemoteFileWork::GetAndUnzipRemoteFileWork(
            retry)
     , mFt(std::move(ft))
     , mArchive(archive)
+    , mUnzip(mFt.getType() == HISTORY_FILE_TYPE_BUCKET)
 {
 }
 
@@ -97,6 +98,12 @@ GetAndUnzipRemoteFileWork::doWork()
             {
                 return State::WORK_FAILURE;
             }
+            if (!mUnzip)
+            {
+                // Read compressed by XDRInputFileStream, which throws on
+                // corrupt or truncated data: no need to inflate it twice.
+                return State::WORK_SUCCESS;
+            }
             mGunzipFileWork = addWork<GunzipFileWork>(mFt.localPath_gz(), false,
                                                       BasicWork::RETRY_NEVER);
             return State::WORK_RUNNING;
@@ -13,6 +13,10 @@ namespace stellar
 class HistoryArchive;
 class GetRemoteFileWork;
 
+// Downloads `ft` to its `localPath_gz`. Buckets are then decompressed to
+// `localPath_nogz` as they get adopted as is by the bucket manager, while
+// other files (checkpoint files) are consumed compressed, their integrity
+// being checked as they are read.
 class GetAndUnzipRemoteFileWork : public Work
 {
     std::shared_ptr<GetRemoteFileWork> mGetRemoteFileWork;
@@ -20,6 +24,7 @@ class GetAndUnzipRemoteFileWork : public Work
 
     FileTransferInfo mFt;
     std::shared_ptr<HistoryArchive> const mArchive;
+    bool const mUnzip;
 
     bool validateFile();
 
@@ -4,31 +4,31 @@
 
 #include "historywork/GunzipFileWork.h"
 #include "util/Fs.h"
+#include "util/Gzip.h"
 
 namespace stellar
 {
 
 GunzipFileWork::GunzipFileWork(Application& app, std::string const& filenameGz,
                                bool keepExisting, size_t maxRetries)
-    : RunCommandWork(app, std::string("gunzip-file ") + filenameGz, maxRetries)
+    : RunInBackgroundWork(app, std::string("gunzip-file ") + filenameGz,
+                          maxRetries)
     , mFilenameGz(filenameGz)
     , mKeepExisting(keepExisting)
 {
     fs::checkGzipSuffix(mFilenameGz);
 }
 
-CommandInfo
-GunzipFileWork::getCommand()
+std::function<void()>
+GunzipFileWork::getTask()
 {
-    std::string cmdLine, outFile;
-    cmdLine = "gzip -d ";
-    if (mKeepExisting)
-    {
-        cmdLine += "-c ";
-        outFile = mFilenameGz.substr(0, mFilenameGz.size() - 3);
-    }
-    cmdLine += mFilenameGz;
-    return CommandInfo{cmdLine, outFile};
+    return [filenameGz = mFilenameGz, keepExisting = mKeepExisting]() {
+        gunzipFile(filenameGz, filenameGz.substr(0, filenameGz.size() - 3));
+        if (!keepExisting)
+        {
+            std::remove(filenameGz.c_str());
+        }
+    };
 }
 
 void
@@ -36,5 +36,6 @@ GunzipFileWork::onReset()
 {
     std::string filenameNoGz = mFilenameGz.substr(0, mFilenameGz.size() - 3);
     std::remove(filenameNoGz.c_str());
+    RunInBackgroundWork::onReset();
 }
 }
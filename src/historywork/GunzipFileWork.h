@@ -4,16 +4,16 @@
 
 #pragma once
 
-#include "historywork/RunCommandWork.h"
+#include "historywork/RunInBackgroundWork.h"
 
 namespace stellar
 {
 
-class GunzipFileWork : public RunCommandWork
+class GunzipFileWork : public RunInBackgroundWork
 {
     std::string const mFilenameGz;
     bool const mKeepExisting;
-    CommandInfo getCommand() override;
+    std::function<void()> getTask() override;
 
   public:
     GunzipFileWork(Application& app, std::string const& filenameGz,
@@ -3,15 +3,19 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "historywork/GzipFileWork.h"
+#include "main/Application.h"
+#include "main/Config.h"
 #include "util/Fs.h"
+#include "util/Gzip.h"
+#include <algorithm>
 
 namespace stellar
 {
 
 GzipFileWork::GzipFileWork(Application& app, std::string const& filenameNoGz,
                            bool keepExisting)
-    : RunCommandWork(app, std::string("gzip-file ") + filenameNoGz,
-                     BasicWork::RETRY_A_LOT)
+    : RunInBackgroundWork(app, std::string("gzip-file ") + filenameNoGz,
+                          BasicWork::RETRY_A_LOT)
     , mFilenameNoGz(filenameNoGz)
     , mKeepExisting(keepExisting)
 {
@@ -23,20 +27,22 @@ GzipFileWork::onReset()
 {
     std::string filenameGz = mFilenameNoGz + ".gz";
     std::remove(filenameGz.c_str());
+    RunInBackgroundWork::onReset();
 }
 
-CommandInfo
-GzipFileWork::getCommand()
+std::function<void()>
+GzipFileWork::getTask()
 {
-    std::string cmdLine = "gzip ";
-    std::string outFile;
-    if (mKeepExisting)
-    {
-        cmdLine += "-c ";
-        outFile = mFilenameNoGz + ".gz";
-    }
-    cmdLine += mFilenameNoGz;
-
-    return CommandInfo{cmdLine, outFile};
+    // large files (buckets) get compressed with several threads
+    auto threads = static_cast<size_t>(
+        std::max(1, mApp.getConfig().WORKER_THREADS));
+    return [filenameNoGz = mFilenameNoGz, keepExisting = mKeepExisting,
+            threads]() {
+        gzipFile(filenameNoGz, filenameNoGz + ".gz", threads);
+        if (!keepExisting)
+        {
+            std::remove(filenameNoGz.c_str());
+        }
+    };
 }
 }
@@ -4,16 +4,16 @@
 
 #pragma once
 
-#include "historywork/RunCommandWork.h"
+#include "historywork/RunInBackgroundWork.h"
 
 namespace stellar
 {
 
-class GzipFileWork : public RunCommandWork
+class GzipFileWork : public RunInBackgroundWork
 {
     std::string const mFilenameNoGz;
     bool const mKeepExisting;
-    CommandInfo getCommand() override;
+    std::function<void()> getTask() override;
 
   public:
     GzipFileWork(Application& app, std::string const& filenameNoGz,
@@ -0,0 +1,82 @@
+// Copyright 2023 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "historywork/RunInBackgroundWork.h"
+#include "main/Application.h"
+#include "util/Logging.h"
+#include <Tracy.hpp>
+
+namespace stellar
+{
+
+RunInBackgroundWork::RunInBackgroundWork(Application& app,
+                                         std::string const& name,
+                                         size_t maxRetries)
+    : BasicWork(app, name, maxRetries)
+{
+}
+
+BasicWork::State
+RunInBackgroundWork::onRun()
+{
+    ZoneScoped;
+    if (mDone)
+    {
+        return mFailed ? State::WORK_FAILURE : State::WORK_SUCCESS;
+    }
+    if (mRunning)
+    {
+        return State::WORK_WAITING;
+    }
+
+    mRunning = true;
+    auto task = getTask();
+    auto name = getName();
+    Application& app = mApp;
+    std::weak_ptr<RunInBackgroundWork> weak(
+        std::static_pointer_cast<RunInBackgroundWork>(shared_from_this()));
+    app.postOnBackgroundThread(
+        [&app, task, name, weak]() {
+            bool failed = false;
+            try
+            {
+                task();
+            }
+            catch (std::exception const& e)
+            {
+                CLOG_WARNING(History, "{} failed: {}", name, e.what());
+                failed = true;
+            }
+            app.postOnMainThread(
+                [weak, failed]() {
+                    auto self = weak.lock();
+                    if (self)
+                    {
+                        self->mRunning = false;
+                        self->mDone = true;
+                        self->mFailed = failed;
+                        self->wakeUp();
+                    }
+                },
+                name + ": finish");
+        },
+        name);
+    return State::WORK_WAITING;
+}
+
+void
+RunInBackgroundWork::onReset()
+{
+    mDone = false;
+    mFailed = false;
+}
+
+bool
+RunInBackgroundWork::onAbort()
+{
+    // The task can't be interrupted: wait for it to complete so that it
+    // doesn't race with the cleanup of its output in `onReset`
+    return !mRunning;
+}
+}
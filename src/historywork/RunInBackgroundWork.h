@@ -0,0 +1,37 @@
+#pragma once
+
+// Copyright 2023 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "work/Work.h"
+#include <functional>
+
+namespace stellar
+{
+
+/**
+ * This class helps run self-contained tasks (typically file processing) on a
+ * background thread, as an in-process alternative to `RunCommandWork`. The
+ * task returned by `getTask` fails by throwing. This work is not scheduled
+ * while the task runs, and wakes up when it's ready to be scheduled again.
+ */
+class RunInBackgroundWork : public BasicWork
+{
+    bool mRunning{false};
+    bool mDone{false};
+    bool mFailed{false};
+    // Called on the main thread, the task must not reference the work.
+    virtual std::function<void()> getTask() = 0;
+
+  public:
+    RunInBackgroundWork(Application& app, std::string const& name,
+                        size_t maxRetries = BasicWork::RETRY_A_FEW);
+    ~RunInBackgroundWork() = default;
+
+  protected:
+    void onReset() override;
+    BasicWork::State onRun() override;
+    bool onAbort() override;
+};
+}
@@ -93,8 +93,8 @@ VerifyTxResultsWork::verifyTxResultsOfCheckpoint()
                             mCheckpoint);
         FileTransferInfo ri(mDownloadDir, HISTORY_FILE_TYPE_RESULTS,
                             mCheckpoint);
-        mHdrIn.open(hi.localPath_nogz());
-        mResIn.open(ri.localPath_nogz());
+        mHdrIn.open(hi.localPath_gz());
+        mResIn.open(ri.localPath_gz());
 
         LedgerHeaderHistoryEntry curr;
         while (mHdrIn && mHdrIn.readOne(curr))
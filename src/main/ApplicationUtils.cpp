@@ -7,13 +7,18 @@
 #include "bucket/BucketManager.h"
 #include "catchup/ApplyBucketsWork.h"
 #include "catchup/CatchupConfiguration.h"
+#include "catchup/CatchupRange.h"
 #include "crypto/Hex.h"
 #include "database/Database.h"
 #include "herder/Herder.h"
+#include "herder/TransactionQueue.h"
+#include "herder/TxSetUtils.h"
 #include "history/HistoryArchive.h"
 #include "history/HistoryArchiveManager.h"
 #include "history/HistoryArchiveReportWork.h"
+#include "history/HistoryManager.h"
 #include "historywork/GetHistoryArchiveStateWork.h"
+#include "historywork/WriteVerifiedCheckpointHashesWork.h"
 #include "invariant/BucketListIsConsistentWithDatabase.h"
 #include "ledger/LedgerHeaderUtils.h"
 #include "ledger/LedgerManager.h"
@@ -22,13 +27,21 @@
 #include "main/Maintainer.h"
 #include "main/PersistentState.h"
 #include "main/StellarCoreVersion.h"
+#include "overlay/FloodedTxRecorder.h"
 #include "overlay/OverlayManager.h"
+#include "process/ProcessManager.h"
+#include "transactions/TransactionUtils.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
+#include "util/ProtocolVersion.h"
+#include "util/TmpDir.h"
 #include "util/XDRCereal.h"
 #include "util/xdrquery/XDRQuery.h"
 #include "work/WorkScheduler.h"
+#include <medida/metrics_registry.h>
+#include <medida/timer.h>
 
+#include <algorithm>
 #include <charconv>
 #include <filesystem>
 #include <lib/http/HttpClient.h>
@@ -746,6 +759,165 @@ rebuildLedgerFromBuckets(Config cfg)
         ;
     return 1;
 }
+
+void
+simulateTxQueue(Config cfg, std::string const& recordFile,
+                std::chrono::milliseconds ledgerPeriod)
+{
+    VirtualClock clock(VirtualClock::REAL_TIME);
+    cfg.setNoListen();
+    cfg.AUTOMATIC_MAINTENANCE_PERIOD = std::chrono::seconds(0);
+    cfg.AUTOMATIC_SELF_CHECK_PERIOD = std::chrono::seconds(0);
+    cfg.FLOODED_TX_RECORD_PATH = "";
+    Application::pointer app = Application::create(clock, cfg, false);
+    app->start();
+
+    auto& lm = app->getLedgerManager();
+    ClassicTransactionQueue queue(
+        *app, Herder::TRANSACTION_QUEUE_TIMEOUT_LEDGERS,
+        Herder::TRANSACTION_QUEUE_BAN_LEDGERS,
+        Herder::TRANSACTION_QUEUE_SIZE_MULTIPLIER);
+
+    auto& admissionTimer = app->getMetrics().NewTimer(
+        {"simulation", "tx-queue", "admission"});
+    auto& txSetBuildTimer = app->getMetrics().NewTimer(
+        {"simulation", "tx-queue", "tx-set-build"});
+    std::array<uint64_t, static_cast<size_t>(
+                             TransactionQueue::AddResult::ADD_STATUS_COUNT)>
+        addResults{};
+    uint64_t evicted = 0;
+    uint64_t invalidated = 0;
+    uint64_t ledgersClosed = 0;
+    uint64_t txsApplied = 0;
+
+    // Mirrors what the herder does when nominating and externalizing a
+    // ledger, using the recorded time as the close time.
+    auto closeLedger = [&](uint64_t closeTimeMicros) {
+        auto const& lcl = lm.getLastClosedLedgerHeader();
+        uint32_t nextSeq = lcl.header.ledgerSeq + 1;
+        uint64_t closeTime =
+            std::max<uint64_t>(closeTimeMicros / 1000000,
+                               lcl.header.scpValue.closeTime + 1);
+        uint64_t closeTimeOffset = closeTime - lcl.header.scpValue.closeTime;
+
+        TxSetFrame::TxPhases txPhases;
+        txPhases.emplace_back(queue.getTransactions(lcl.header));
+#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+        if (protocolVersionStartsFrom(lcl.header.ledgerVersion,
+                                      ProtocolVersion::V_20))
+        {
+            txPhases.emplace_back();
+        }
+#endif
+        TxSetFrame::TxPhases invalidTxPhases(txPhases.size());
+        TxSetFrameConstPtr txSet;
+        {
+            auto timeScope = txSetBuildTimer.TimeScope();
+            txSet = TxSetFrame::makeFromTransactions(
+                txPhases, *app, closeTimeOffset, closeTimeOffset,
+                invalidTxPhases);
+        }
+        auto const& invalidTxs =
+            invalidTxPhases[static_cast<size_t>(TxSetFrame::Phase::CLASSIC)];
+        invalidated += invalidTxs.size();
+        queue.ban(invalidTxs);
+
+        auto sv = app->getHerder().makeStellarValue(
+            txSet->getContentsHash(), closeTime, {}, cfg.NODE_SEED);
+        LedgerCloseData lcd{nextSeq, txSet, sv};
+        lm.closeLedger(lcd);
+        while (!app->isStopping() &&
+               (lm.getLastClosedLedgerNum() < nextSeq ||
+                !app->getWorkScheduler().allChildrenDone()))
+        {
+            clock.crank(false);
+        }
+        ++ledgersClosed;
+
+        auto const& applied =
+            txSet->getTxsForPhase(TxSetFrame::Phase::CLASSIC);
+        txsApplied += applied.size();
+        queue.removeApplied(applied);
+        queue.shift();
+        queue.maybeVersionUpgraded();
+
+        auto const& newLcl = lm.getLastClosedLedgerHeader();
+        auto stillInvalid = TxSetUtils::getInvalidTxList(
+            queue.getTransactions(newLcl.header), *app, 0,
+            getUpperBoundCloseTimeOffset(*app,
+                                         newLcl.header.scpValue.closeTime),
+            false);
+        invalidated += stillInvalid.size();
+        queue.ban(stillInvalid);
+    };
+
+    XDRInputFileStream in;
+    in.open(recordFile);
+    uint64_t arrivalTime = 0;
+    TransactionEnvelope env;
+    std::optional<uint64_t> nextCloseTime;
+    uint64_t const ledgerPeriodMicros =
+        std::chrono::duration_cast<std::chrono::microseconds>(ledgerPeriod)
+            .count();
+    while (!app->isStopping() &&
+           FloodedTxRecorder::readNext(in, arrivalTime, env))
+    {
+        if (!nextCloseTime)
+        {
+            nextCloseTime = arrivalTime + ledgerPeriodMicros;
+        }
+        while (arrivalTime >= *nextCloseTime)
+        {
+            closeLedger(*nextCloseTime);
+            *nextCloseTime += ledgerPeriodMicros;
+        }
+
+        auto tx = TransactionFrameBase::makeTransactionFromWire(
+            app->getNetworkID(), env);
+        if (!tx)
+        {
+            continue;
+        }
+        auto bannedBefore = queue.countBanned(0);
+        TransactionQueue::AddResult res;
+        {
+            auto timeScope = admissionTimer.TimeScope();
+            res = queue.tryAdd(tx, false);
+        }
+        ++addResults[static_cast<size_t>(res)];
+        // `tryAdd` only ever bans the transactions it evicts
+        evicted += queue.countBanned(0) - bannedBefore;
+    }
+    if (nextCloseTime)
+    {
+        closeLedger(*nextCloseTime);
+    }
+
+    LOG_INFO(DEFAULT_LOG, "Replayed {} transactions over {} ledgers",
+             admissionTimer.count(), ledgersClosed);
+    for (size_t i = 0; i < addResults.size(); ++i)
+    {
+        LOG_INFO(DEFAULT_LOG, "  {}: {}", TX_STATUS_STRING[i], addResults[i]);
+    }
+    LOG_INFO(DEFAULT_LOG,
+             "Evicted {} transactions, banned {} invalid transactions, "
+             "applied {} transactions",
+             evicted, invalidated, txsApplied);
+    LOG_INFO(DEFAULT_LOG,
+             "Admission latency (ms): mean {:.4f}, p99 {:.4f}, max {:.4f}",
+             admissionTimer.mean(),
+             admissionTimer.GetSnapshot().get99thPercentile(),
+             admissionTimer.max());
+    LOG_INFO(DEFAULT_LOG,
+             "Tx set build time (ms): mean {:.4f}, p99 {:.4f}, max {:.4f}",
+             txSetBuildTimer.mean(),
+             txSetBuildTimer.GetSnapshot().get99thPercentile(),
+             txSetBuildTimer.max());
+    LOG_WARNING(DEFAULT_LOG,
+                "Closed {} ledgers offline, database is no longer in "
+                "consensus with any other validators",
+                ledgersClosed);
+}
 #endif
 
 int
@@ -846,12 +1018,12 @@ writeCatchupInfo(Json::Value const& catchupInfo, std::string const& outputFile)
     }
 }
 
+namespace
+{
 int
-catchup(Application::pointer app, CatchupConfiguration cc,
-        Json::Value& catchupInfo, std::shared_ptr<HistoryArchive> archive)
+runCatchup(Application::pointer app, CatchupConfiguration cc,
+           Json::Value& catchupInfo, std::shared_ptr<HistoryArchive> archive)
 {
-    app->start();
-
     try
     {
         app->getLedgerManager().startCatchup(cc, archive, {});
@@ -918,6 +1090,182 @@ catchup(Application::pointer app, CatchupConfiguration cc,
     return synced ? 0 : 3;
 }
 
+// Checks the outcome of a catchup segment run by a child process, against the
+// trusted hash of its destination ledger.
+bool
+checkCatchupSegment(CatchupConfiguration const& segment, bool exitedOk,
+                    std::string const& infoFile,
+                    std::string const& trustedCheckpointHashesFile)
+{
+    if (!exitedOk)
+    {
+        LOG_ERROR(DEFAULT_LOG, "Catchup segment to ledger {} failed",
+                  segment.toLedger());
+        return false;
+    }
+    Json::Value root;
+    {
+        std::ifstream in(infoFile);
+        Json::Reader rdr;
+        if (!in || !rdr.parse(in, root))
+        {
+            LOG_ERROR(DEFAULT_LOG, "Could not read catchup segment info {}",
+                      infoFile);
+            return false;
+        }
+    }
+    auto const& ledger = root["info"]["ledger"];
+    auto trusted = WriteVerifiedCheckpointHashesWork::loadHashFromJsonOutput(
+        segment.toLedger(), trustedCheckpointHashesFile);
+    if (ledger["num"].asUInt() != segment.toLedger() ||
+        ledger["hash"].asString() != binToHex(trusted))
+    {
+        LOG_ERROR(DEFAULT_LOG,
+                  "Catchup segment ended on ledger {} with hash {}, "
+                  "expected ledger {} with hash {}",
+                  ledger["num"].asUInt(), ledger["hash"].asString(),
+                  segment.toLedger(), binToHex(trusted));
+        return false;
+    }
+    return true;
+}
+}
+
+int
+catchup(Application::pointer app, CatchupConfiguration cc,
+        Json::Value& catchupInfo, std::shared_ptr<HistoryArchive> archive)
+{
+    app->start();
+    return runCatchup(app, cc, catchupInfo, archive);
+}
+
+std::vector<CatchupConfiguration>
+splitCatchupConfiguration(CatchupConfiguration const& cc, uint32_t segments,
+                          HistoryManager const& hm)
+{
+    releaseAssert(segments > 0);
+    CatchupRange range(LedgerManager::GENESIS_LEDGER_SEQ, cc, hm);
+    // Ledger whose state the first segment starts from
+    uint32_t from = range.applyBuckets() ? range.getBucketApplyLedger()
+                                         : LedgerManager::GENESIS_LEDGER_SEQ;
+    uint32_t to = cc.toLedger();
+
+    std::vector<CatchupConfiguration> res;
+    uint32_t start = from;
+    for (uint32_t i = 1; i < segments; ++i)
+    {
+        auto target = static_cast<uint32_t>(
+            from + static_cast<uint64_t>(to - from) * i / segments);
+        auto end = hm.checkpointContainingLedger(target);
+        if (end <= start || end >= to)
+        {
+            continue;
+        }
+        // Segments after the first one start from the bucket state at the
+        // end of the previous one
+        auto count = (start == from && !range.applyBuckets()) ? cc.count()
+                                                              : end - start;
+        res.emplace_back(end, count, cc.mode());
+        start = end;
+    }
+    auto count =
+        (start == from && !range.applyBuckets()) ? cc.count() : to - start;
+    res.emplace_back(LedgerNumHashPair(to, cc.hash()), count, cc.mode());
+    return res;
+}
+
+int
+catchupVerifyingInParallel(
+    Application::pointer app, std::vector<CatchupConfiguration> const& segments,
+    std::function<std::string(CatchupConfiguration const&,
+                              std::string const&)> const& segmentCommand,
+    std::string const& trustedCheckpointHashesFile, Json::Value& catchupInfo,
+    std::shared_ptr<HistoryArchive> archive)
+{
+    releaseAssert(!segments.empty());
+    app->start();
+    auto& lm = app->getLedgerManager();
+    if (lm.getLastClosedLedgerNum() != LedgerManager::GENESIS_LEDGER_SEQ)
+    {
+        throw std::runtime_error(
+            "parallel catchup requires a new database, run new-db first");
+    }
+    if (segments.size() > 1)
+    {
+        // The child processes use their own databases, deleted once done
+        LOG_WARNING(DEFAULT_LOG,
+                    "Parallel catchup: ledgers up to {} are only verified, the "
+                    "database of this node will only contain the history (and "
+                    "metadata) of ledgers {} to {}",
+                    segments[segments.size() - 2].toLedger(),
+                    segments[segments.size() - 2].toLedger() + 1,
+                    segments.back().toLedger());
+    }
+
+    // All segments but the last one are caught up by child processes, each
+    // in its own directory, while this process catches up the last one
+    std::vector<TmpDir> dirs;
+    std::vector<std::string> logs;
+    auto exits =
+        std::make_shared<std::vector<std::optional<bool>>>(segments.size() - 1);
+    for (size_t i = 0; i + 1 < segments.size(); ++i)
+    {
+        dirs.emplace_back(app->getTmpDirManager().tmpDir(
+            fmt::format(FMT_STRING("catchup-segment-{:d}"), i)));
+        logs.emplace_back(fmt::format(FMT_STRING("catchup-segment-{:d}.log"),
+                                      segments[i].toLedger()));
+        auto cmd = segmentCommand(segments[i], dirs.back().getName());
+        LOG_INFO(DEFAULT_LOG,
+                 "Starting catchup segment to ledger {}, logging to {}: {}",
+                 segments[i].toLedger(), logs.back(), cmd);
+        auto exit =
+            app->getProcessManager().runProcess(cmd, logs.back()).lock();
+        if (!exit)
+        {
+            throw std::runtime_error("failed to start " + cmd);
+        }
+        exit->async_wait(
+            [exits, i](asio::error_code const& ec) { (*exits)[i] = !ec; });
+    }
+
+    int result = runCatchup(app, segments.back(), catchupInfo, archive);
+    if (result != 0)
+    {
+        // Child processes get terminated with the application
+        return result;
+    }
+
+    auto& clock = app->getClock();
+    asio::io_context::work mainWork(clock.getIOContext());
+    auto running = [&]() {
+        return std::any_of(exits->begin(), exits->end(),
+                           [](auto const& e) { return !e.has_value(); });
+    };
+    while (running() && clock.crank(true))
+    {
+    }
+
+    // Each segment checked its replay against the ledger chain ending at its
+    // destination, and the next segment started from the bucket state of that
+    // same ledger: they knit up as long as the chains agree on that ledger,
+    // which they do if they both match the trusted checkpoint hashes.
+    for (size_t i = 0; i + 1 < segments.size(); ++i)
+    {
+        if (!checkCatchupSegment(segments[i], exits->at(i).value_or(false),
+                                 dirs[i].getName() + "/info.json",
+                                 trustedCheckpointHashesFile))
+        {
+            LOG_ERROR(DEFAULT_LOG, "See {} for details", logs[i]);
+            result = 3;
+        }
+    }
+    LOG_INFO(DEFAULT_LOG, "*");
+    LOG_INFO(DEFAULT_LOG, "* Parallel catchup of {} segments {}.",
+             segments.size(), result == 0 ? "finished" : "failed");
+    LOG_INFO(DEFAULT_LOG, "*");
+    return result;
+}
+
 int
 publish(Application::pointer app)
 {
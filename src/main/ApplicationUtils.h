@@ -7,12 +7,15 @@
 #include "history/HistoryArchive.h"
 #include "ledger/LedgerRange.h"
 #include "main/Application.h"
+#include <functional>
 #include <optional>
+#include <vector>
 
 namespace stellar
 {
 
 class CatchupConfiguration;
+class HistoryManager;
 
 // Create application and validate its configuration
 Application::pointer setupApp(Config& cfg, VirtualClock& clock,
@@ -36,6 +39,12 @@ int reportLastHistoryCheckpoint(Config cfg, std::string const& outputFile);
 #ifdef BUILD_TESTS
 void loadXdr(Config cfg, std::string const& bucketFile);
 int rebuildLedgerFromBuckets(Config cfg);
+// Replays transactions recorded with FLOODED_TX_RECORD_PATH against the
+// current ledger state, closing a ledger every `ledgerPeriod` of recorded
+// time, and reports the transaction queue admission latency, evictions and
+// transaction set building time.
+void simulateTxQueue(Config cfg, std::string const& recordFile,
+                     std::chrono::milliseconds ledgerPeriod);
 #endif
 void genSeed();
 int initializeHistories(Config cfg,
@@ -44,6 +53,24 @@ void writeCatchupInfo(Json::Value const& catchupInfo,
                       std::string const& outputFile);
 int catchup(Application::pointer app, CatchupConfiguration cc,
             Json::Value& catchupInfo, std::shared_ptr<HistoryArchive> archive);
+// Splits a catchup from a new database into at most `segments` consecutive
+// catchups. All but the last one end on a checkpoint, from the bucket state of
+// which the next one starts.
+std::vector<CatchupConfiguration>
+splitCatchupConfiguration(CatchupConfiguration const& cc, uint32_t segments,
+                          HistoryManager const& hm);
+// Catches up the last of `segments` in `app`, while the earlier ones are only
+// verified: they are caught up concurrently, in memory, by child processes
+// started with `segmentCommand(segment, dir)`, which must write their catchup
+// info to "<dir>/info.json", and their final ledgers are then checked against
+// `trustedCheckpointHashesFile`. Nothing else is kept of the earlier segments:
+// `app` ends up with the history and metadata of the last one only.
+int catchupVerifyingInParallel(
+    Application::pointer app, std::vector<CatchupConfiguration> const& segments,
+    std::function<std::string(CatchupConfiguration const&,
+                              std::string const&)> const& segmentCommand,
+    std::string const& trustedCheckpointHashesFile, Json::Value& catchupInfo,
+    std::shared_ptr<HistoryArchive> archive);
 // Reduild ledger state based on the buckets. Ensure ledger state is properly
 // reset before calling this function.
 bool applyBucketsForLCL(Application& app);
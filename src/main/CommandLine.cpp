@@ -316,6 +316,18 @@ maybeSetMetadataOutputStream(Config& cfg, std::string const& stream)
     }
 }
 
+// Quotes `arg` for a command line run by the ProcessManager
+std::string
+quoteCommandArgument(std::string const& arg)
+{
+    if (arg.find('"') != std::string::npos)
+    {
+        throw std::runtime_error("unsupported double quote in argument: " +
+                                 arg);
+    }
+    return "\"" + arg + "\"";
+}
+
 void
 maybeEnableInMemoryMode(Config& config, bool inMemory, uint32_t startAtLedger,
                         std::string const& startAtHash, bool persistMinimalData)
@@ -727,6 +739,8 @@ runCatchup(CommandLineArgs const& args)
     bool forceUntrusted = false;
     std::string hash;
     std::string stream;
+    uint32_t verifySegments = 1;
+    std::string segmentDir;
 
     auto validateCatchupString = [&] {
         try
@@ -777,6 +791,19 @@ runCatchup(CommandLineArgs const& args)
             "historical data");
     };
 
+    auto parallelVerifyParser = [](uint32_t& segments) {
+        return clara::Opt{segments, "N"}["--parallel-verify"](
+            "split the catchup into N segments and only keep the last one, "
+            "the earlier ones being verified in parallel against "
+            "--trusted-checkpoint-hashes, which is required");
+    };
+
+    auto segmentDirParser = [](std::string& dir) {
+        return clara::Opt{dir, "DIR-NAME"}["--catchup-segment-dir"](
+            "internal: verify a segment of a --parallel-verify catchup in "
+            "memory, with state and temporary files in DIR-NAME");
+    };
+
     return runWithHelp(
         args,
         {configurationParser(configOption), catchupStringParser,
@@ -785,9 +812,11 @@ runCatchup(CommandLineArgs const& args)
          outputFileParser(outputFile), disableBucketGCParser(disableBucketGC),
          validationParser(completeValidation), inMemoryParser(inMemory),
          ledgerHashParser(hash), forceUntrustedCatchup(forceUntrusted),
-         metadataOutputStreamParser(stream), forceBackParser(forceBack)},
+         metadataOutputStreamParser(stream), forceBackParser(forceBack),
+         parallelVerifyParser(verifySegments), segmentDirParser(segmentDir)},
         [&] {
-            auto config = configOption.getConfig();
+            // Verified segments log to their standard output
+            auto config = configOption.getConfig(segmentDir.empty());
             // Don't call config.setNoListen() here as we might want to
             // access the /info HTTP endpoint during catchup.
             config.RUN_STANDALONE = true;
@@ -805,6 +834,50 @@ runCatchup(CommandLineArgs const& args)
                 config.AUTOMATIC_MAINTENANCE_COUNT = MAINTENANCE_LEDGER_COUNT;
             }
 
+            if (!segmentDir.empty())
+            {
+                // Isolate the segment from the other segments and from the
+                // node the configuration is for
+                inMemory = true;
+                config.setNoListen();
+                config.BUCKET_DIR_PATH = segmentDir + "/buckets";
+                config.TMP_DIR_PATH = segmentDir + "/tmp";
+                // Only the node itself streams metadata (the configuration
+                // may point to the pipe of a captive core)
+                stream.clear();
+                config.METADATA_OUTPUT_STREAM.clear();
+            }
+            if (verifySegments == 0)
+            {
+                throw std::runtime_error(
+                    "--parallel-verify must be at least 1");
+            }
+            if (verifySegments > 1)
+            {
+                if (trustedCheckpointHashesFile.empty())
+                {
+                    throw std::runtime_error("--parallel-verify requires "
+                                             "--trusted-checkpoint-hashes");
+                }
+                if (forceBack || !segmentDir.empty() ||
+                    configOption.mConfigFile == Config::STDIN_SPECIAL_NAME)
+                {
+                    throw std::runtime_error(
+                        "--parallel-verify can't be used with --force-back, "
+                        "--catchup-segment-dir or a configuration from STDIN");
+                }
+                // The metadata of the verified segments is not emitted
+                if (!stream.empty() || !config.METADATA_OUTPUT_STREAM.empty())
+                {
+                    throw std::runtime_error(
+                        "--parallel-verify can't be used with a metadata "
+                        "output stream");
+                }
+                // Segments run as subprocesses, on top of the ones used to
+                // download files
+                config.MAX_CONCURRENT_SUBPROCESSES += verifySegments - 1;
+            }
+
             // --start-at-ledger and --start-at-hash aren't allowed in catchup,
             // so pass defaults values
             maybeEnableInMemoryMode(config, inMemory, 0, "",
@@ -910,7 +983,45 @@ runCatchup(CommandLineArgs const& args)
                 }
 
                 Json::Value catchupInfo;
-                result = catchup(app, cc, catchupInfo, archivePtr);
+                if (verifySegments > 1)
+                {
+                    auto segments = splitCatchupConfiguration(
+                        cc, verifySegments, app->getHistoryManager());
+                    auto segmentCommand = [&](CatchupConfiguration const& seg,
+                                              std::string const& dir) {
+                        auto cmd = fmt::format(
+                            FMT_STRING("{} catchup {:d}/{:d} --conf {} "
+                                       "--trusted-checkpoint-hashes {} "
+                                       "--output-file {} "
+                                       "--catchup-segment-dir {}"),
+                            quoteCommandArgument(args.mExeName),
+                            seg.toLedger(), seg.count(),
+                            quoteCommandArgument(
+                                configOption.mConfigFile.empty()
+                                    ? std::string{"stellar-core.cfg"}
+                                    : configOption.mConfigFile),
+                            quoteCommandArgument(trustedCheckpointHashesFile),
+                            quoteCommandArgument(dir + "/info.json"),
+                            quoteCommandArgument(dir));
+                        if (!archive.empty())
+                        {
+                            cmd +=
+                                " --archive " + quoteCommandArgument(archive);
+                        }
+                        if (completeValidation)
+                        {
+                            cmd += " --extra-verification";
+                        }
+                        return cmd;
+                    };
+                    result = catchupVerifyingInParallel(
+                        app, segments, segmentCommand,
+                        trustedCheckpointHashesFile, catchupInfo, archivePtr);
+                }
+                else
+                {
+                    result = catchup(app, cc, catchupInfo, archivePtr);
+                }
                 if (!catchupInfo.isNull())
                 {
                     writeCatchupInfo(catchupInfo, outputFile);
@@ -1505,6 +1616,31 @@ runRebuildLedgerFromBuckets(CommandLineArgs const& args)
     });
 }
 
+int
+runSimulateTxQueue(CommandLineArgs const& args)
+{
+    CommandLine::ConfigOption configOption;
+    std::string recordFile;
+    uint32_t ledgerPeriodMs = 5000;
+
+    ParserWithValidation periodParser{
+        clara::Opt{ledgerPeriodMs, "MILLISECONDS"}["--ledger-period"](
+            "recorded time between simulated ledger closes (default 5000)"),
+        [&] {
+            return ledgerPeriodMs > 0 ? "" : "Ledger period must be non-zero";
+        }};
+
+    return runWithHelp(
+        args,
+        {configurationParser(configOption), fileNameParser(recordFile),
+         periodParser},
+        [&] {
+            simulateTxQueue(configOption.getConfig(), recordFile,
+                            std::chrono::milliseconds(ledgerPeriodMs));
+            return 0;
+        });
+}
+
 int
 runGenerateOrSimulateTxs(CommandLineArgs const& args, bool generate)
 {
@@ -1709,7 +1845,7 @@ runSimulateBuckets(CommandLineArgs const& args)
                 // the bucketlist
                 FileTransferInfo ft(dir, HISTORY_FILE_TYPE_LEDGER, checkpoint);
                 XDRInputFileStream hdrIn;
-                hdrIn.open(ft.localPath_nogz());
+                hdrIn.open(ft.localPath_gz());
                 LedgerHeaderHistoryEntry curr;
                 // Read the last LedgerHeaderHistoryEntry to use as LCL
                 try
@@ -1886,6 +2022,10 @@ handleCommandLine(int argc, char* const* argv)
           "caught up)",
           runSimulateTxs},
          {"simulate-bucketlist", "simulate bucketlist", runSimulateBuckets},
+         {"simulate-tx-queue",
+          "replay flooded transactions recorded with FLOODED_TX_RECORD_PATH "
+          "against the transaction queue (modifies the database)",
+          runSimulateTxQueue},
          {"test", "execute test suite", runTest},
 #endif
          {"version", "print version information", runVersion}}};
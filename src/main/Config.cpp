@@ -128,7 +128,7 @@ Config::Config() : NODE_SEED(SecretKey::random())
     LEDGER_PROTOCOL_MIN_VERSION_INTERNAL_ERROR_REPORT = 18;
 
     OVERLAY_PROTOCOL_MIN_VERSION = 27;
-    OVERLAY_PROTOCOL_VERSION = 28;
+    OVERLAY_PROTOCOL_VERSION = 29;
 
     VERSION_STR = STELLAR_CORE_VERSION;
 
@@ -187,6 +187,7 @@ Config::Config() : NODE_SEED(SecretKey::random())
                            CLOSETIME_DRIFT_LIMIT);
     METADATA_OUTPUT_STREAM = "";
     METADATA_DEBUG_LEDGERS = 0;
+    FLOODED_TX_RECORD_PATH = "";
 
     LOG_FILE_PATH = "stellar-core-{datetime:%Y-%m-%d_%H-%M-%S}.log";
     BUCKET_DIR_PATH = "buckets";
@@ -250,6 +251,9 @@ Config::Config() : NODE_SEED(SecretKey::random())
     FLOW_CONTROL_SEND_MORE_BATCH_SIZE_BYTES = 100000;
     OUTBOUND_TX_QUEUE_BYTE_LIMIT = 1024 * 1024 * 3;
     ENABLE_FLOW_CONTROL_BYTES = true;
+    FLOW_CONTROL_AUTO_TUNE = false;
+    PEER_FLOOD_READING_CAPACITY_MIN = 40;
+    PEER_FLOOD_READING_CAPACITY_MAX = 2000;
 
     // WORKER_THREADS: setting this too low risks a form of priority inversion
     // where a long-running background task occupies all worker threads and
@@ -262,9 +266,13 @@ Config::Config() : NODE_SEED(SecretKey::random())
     //
     // Worst case = 10 concurrent merges + 1 quorum intersection calculation.
     WORKER_THREADS = 11;
+    OVERLAY_DECODE_THREADS = 0;
+    BACKGROUND_SCP_SIGNATURE_VERIFICATION = false;
+    COMPACT_TX_SET_RELAY = false;
     MAX_CONCURRENT_SUBPROCESSES = 16;
     NODE_IS_VALIDATOR = false;
     QUORUM_INTERSECTION_CHECKER = true;
+    QUORUM_INTERSECTION_CHECKER_THREADS = 1;
     DATABASE = SecretValue{"sqlite3://:memory:"};
 
     ENTRY_CACHE_SIZE = 100000;
@@ -1000,6 +1008,18 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
             {
                 ENABLE_FLOW_CONTROL_BYTES = readBool(item);
             }
+            else if (item.first == "FLOW_CONTROL_AUTO_TUNE")
+            {
+                FLOW_CONTROL_AUTO_TUNE = readBool(item);
+            }
+            else if (item.first == "PEER_FLOOD_READING_CAPACITY_MIN")
+            {
+                PEER_FLOOD_READING_CAPACITY_MIN = readInt<uint32_t>(item, 1);
+            }
+            else if (item.first == "PEER_FLOOD_READING_CAPACITY_MAX")
+            {
+                PEER_FLOOD_READING_CAPACITY_MAX = readInt<uint32_t>(item, 1);
+            }
             else if (item.first == "OUTBOUND_TX_QUEUE_BYTE_LIMIT")
             {
                 OUTBOUND_TX_QUEUE_BYTE_LIMIT = readInt<uint32_t>(item, 1);
@@ -1040,6 +1060,10 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
             {
                 METADATA_OUTPUT_STREAM = readString(item);
             }
+            else if (item.first == "FLOODED_TX_RECORD_PATH")
+            {
+                FLOODED_TX_RECORD_PATH = readString(item);
+            }
             else if (item.first == "EXPERIMENTAL_PRECAUTION_DELAY_META")
             {
                 EXPERIMENTAL_PRECAUTION_DELAY_META = readBool(item);
@@ -1299,6 +1323,18 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
             {
                 WORKER_THREADS = readInt<int>(item, 1, 1000);
             }
+            else if (item.first == "OVERLAY_DECODE_THREADS")
+            {
+                OVERLAY_DECODE_THREADS = readInt<int>(item, 0, 64);
+            }
+            else if (item.first == "BACKGROUND_SCP_SIGNATURE_VERIFICATION")
+            {
+                BACKGROUND_SCP_SIGNATURE_VERIFICATION = readBool(item);
+            }
+            else if (item.first == "COMPACT_TX_SET_RELAY")
+            {
+                COMPACT_TX_SET_RELAY = readBool(item);
+            }
             else if (item.first == "MAX_CONCURRENT_SUBPROCESSES")
             {
                 MAX_CONCURRENT_SUBPROCESSES = readInt<size_t>(item, 1);
@@ -1307,6 +1343,11 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
             {
                 QUORUM_INTERSECTION_CHECKER = readBool(item);
             }
+            else if (item.first == "QUORUM_INTERSECTION_CHECKER_THREADS")
+            {
+                QUORUM_INTERSECTION_CHECKER_THREADS =
+                    readInt<uint32_t>(item, 1, 64);
+            }
             else if (item.first == "HISTORY")
             {
                 auto hist = item.second->as_table();
@@ -1503,6 +1544,21 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
             throw std::runtime_error(msg);
         }
 
+        if (FLOW_CONTROL_AUTO_TUNE &&
+            !(FLOW_CONTROL_SEND_MORE_BATCH_SIZE <=
+                  PEER_FLOOD_READING_CAPACITY_MIN &&
+              PEER_FLOOD_READING_CAPACITY_MIN <= PEER_FLOOD_READING_CAPACITY &&
+              PEER_FLOOD_READING_CAPACITY <= PEER_FLOOD_READING_CAPACITY_MAX))
+        {
+            std::string msg =
+                "Invalid configuration: FLOW_CONTROL_AUTO_TUNE requires "
+                "FLOW_CONTROL_SEND_MORE_BATCH_SIZE <= "
+                "PEER_FLOOD_READING_CAPACITY_MIN <= "
+                "PEER_FLOOD_READING_CAPACITY <= "
+                "PEER_FLOOD_READING_CAPACITY_MAX";
+            throw std::runtime_error(msg);
+        }
+
 #ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
         if (!LIMIT_TX_QUEUE_SOURCE_ACCOUNT)
         {
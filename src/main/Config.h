@@ -261,6 +261,15 @@ class Config : public std::enable_shared_from_this<Config>
     // needed.
     bool ENABLE_FLOW_CONTROL_BYTES;
 
+    // Adjust the flood capacity granted to each peer based on the measured
+    // SEND_MORE round-trip time and on how fast its messages are processed.
+    // The capacity starts at `PEER_FLOOD_READING_CAPACITY` and stays within
+    // [`PEER_FLOOD_READING_CAPACITY_MIN`, `PEER_FLOOD_READING_CAPACITY_MAX`];
+    // the byte capacity is scaled proportionally.
+    bool FLOW_CONTROL_AUTO_TUNE;
+    uint32_t PEER_FLOOD_READING_CAPACITY_MIN;
+    uint32_t PEER_FLOOD_READING_CAPACITY_MAX;
+
     // Byte limit for outbound transaction queue.
     uint32_t OUTBOUND_TX_QUEUE_BYTE_LIMIT;
 
@@ -389,6 +398,13 @@ class Config : public std::enable_shared_from_this<Config>
     // at a premium.
     uint32_t METADATA_DEBUG_LEDGERS;
 
+    // Path of a file to record all the transactions received via flooding to,
+    // together with their arrival time. The recording can be replayed against
+    // a snapshot ledger with the `simulate-tx-queue` command to evaluate
+    // transaction queue and nomination changes against real traffic. Empty
+    // (the default) disables the recording.
+    std::string FLOODED_TX_RECORD_PATH;
+
     // Set of cursors added at each startup with value '1'.
     std::vector<std::string> KNOWN_CURSORS;
 
@@ -493,6 +509,16 @@ class Config : public std::enable_shared_from_this<Config>
 
     // thread-management config
     int WORKER_THREADS;
+    // Number of threads decoding and authenticating the messages received
+    // from authenticated peers off the main thread. 0 disables the offloading.
+    int OVERLAY_DECODE_THREADS;
+    // Whether to verify the signatures of the SCP envelopes received from
+    // peers on a dedicated thread.
+    bool BACKGROUND_SCP_SIGNATURE_VERIFICATION;
+
+    // Whether to request tx sets from peers in compact form (short
+    // transaction ids) and rebuild them from the transaction queue.
+    bool COMPACT_TX_SET_RELAY;
 
     // process-management config
     size_t MAX_CONCURRENT_SUBPROCESSES;
@@ -507,6 +533,10 @@ class Config : public std::enable_shared_from_this<Config>
     // Whether to run online quorum intersection checks.
     bool QUORUM_INTERSECTION_CHECKER;
 
+    // Number of threads the quorum intersection checker splits its search
+    // across.
+    uint32_t QUORUM_INTERSECTION_CHECKER_THREADS;
+
     // Invariants
     std::vector<std::string> INVARIANT_CHECKS;
 
@@ -2,10 +2,16 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "catchup/CatchupConfiguration.h"
+#include "catchup/CatchupRange.h"
 #include "crypto/Random.h"
+#include "crypto/Hex.h"
+#include "crypto/SHA.h"
 #include "history/HistoryArchiveManager.h"
+#include "history/HistoryManager.h"
 #include "history/test/HistoryTestsUtils.h"
 #include "invariant/BucketListIsConsistentWithDatabase.h"
+#include "ledger/LedgerManager.h"
 #include "ledger/LedgerTxn.h"
 #include "lib/catch.hpp"
 #include "main/Application.h"
@@ -19,8 +25,10 @@
 #include "test/test.h"
 #include "transactions/TransactionUtils.h"
 #include "util/Logging.h"
+#include "util/TmpDir.h"
 #include <filesystem>
 #include <fstream>
+#include <map>
 
 using namespace stellar;
 using namespace stellar::historytestutils;
@@ -646,4 +654,167 @@ TEST_CASE("application major version numbers", "[applicationutils]")
     CHECK(getStellarCoreMajorReleaseVersion("v19.1.2-10") == std::nullopt);
     CHECK(getStellarCoreMajorReleaseVersion("v19.9.0-30-g726eabdea-dirty") ==
           std::nullopt);
-}
\ No newline at end of file
+}
+
+TEST_CASE("split catchup configuration", "[applicationutils]")
+{
+    VirtualClock clock;
+    auto app = createTestApplication(clock, getTestConfig());
+    auto const& hm = app->getHistoryManager();
+    auto freq = hm.getCheckpointFrequency();
+    auto mode = CatchupConfiguration::Mode::OFFLINE_BASIC;
+    auto genesis = LedgerManager::GENESIS_LEDGER_SEQ;
+
+    auto split = [&](CatchupConfiguration const& cc, uint32_t n) {
+        auto segments = splitCatchupConfiguration(cc, n, hm);
+        REQUIRE(!segments.empty());
+        REQUIRE(segments.size() <= n);
+        REQUIRE(segments.back().toLedger() == cc.toLedger());
+        REQUIRE(segments.back().hash() == cc.hash());
+
+        // The first segment starts like the whole catchup
+        CatchupRange full(genesis, cc, hm);
+        CatchupRange first(genesis, segments.front(), hm);
+        REQUIRE(first.applyBuckets() == full.applyBuckets());
+        if (full.applyBuckets())
+        {
+            REQUIRE(first.getBucketApplyLedger() ==
+                    full.getBucketApplyLedger());
+        }
+        // The others start from the end of the previous one
+        for (size_t i = 1; i < segments.size(); ++i)
+        {
+            auto prev = segments[i - 1].toLedger();
+            REQUIRE(hm.isLastLedgerInCheckpoint(prev));
+            CatchupRange range(genesis, segments[i], hm);
+            REQUIRE(range.applyBuckets());
+            REQUIRE(range.getBucketApplyLedger() == prev);
+            REQUIRE(range.getReplayLast() == segments[i].toLedger());
+        }
+        return segments;
+    };
+
+    SECTION("complete")
+    {
+        auto segments = split(
+            CatchupConfiguration(10 * freq - 1, UINT32_MAX, mode), 4);
+        REQUIRE(segments.size() == 4);
+    }
+    SECTION("recent")
+    {
+        auto segments =
+            split(CatchupConfiguration(20 * freq - 1, 8 * freq, mode), 4);
+        REQUIRE(segments.size() == 4);
+    }
+    SECTION("more segments than checkpoints")
+    {
+        auto segments =
+            split(CatchupConfiguration(3 * freq - 1, UINT32_MAX, mode), 10);
+        REQUIRE(segments.size() == 3);
+    }
+    SECTION("single segment")
+    {
+        CatchupConfiguration cc(10 * freq - 1, 4 * freq, mode);
+        auto segments = split(cc, 1);
+        REQUIRE(segments.size() == 1);
+        REQUIRE(segments[0].count() == cc.count());
+    }
+    SECTION("trusted hash is kept")
+    {
+        LedgerNumHashPair pair(10 * freq - 1,
+                               std::make_optional<Hash>(sha256("trusted")));
+        split(CatchupConfiguration(pair, UINT32_MAX, mode), 3);
+    }
+}
+
+TEST_CASE("catchup verifying earlier segments in parallel",
+          "[applicationutils][catchup]")
+{
+    CatchupSimulation catchupSimulation{};
+    auto checkpointLedger = catchupSimulation.getLastCheckpointLedger(3);
+    catchupSimulation.ensureOfflineCatchupPossible(checkpointLedger);
+    auto app = catchupSimulation.createCatchupApplication(
+        std::numeric_limits<uint32_t>::max(), Config::TESTDB_IN_MEMORY_SQLITE,
+        "app");
+    auto segments = splitCatchupConfiguration(
+        CatchupConfiguration(checkpointLedger, UINT32_MAX,
+                             CatchupConfiguration::Mode::OFFLINE_BASIC),
+        3, app->getHistoryManager());
+    REQUIRE(segments.size() == 3);
+
+    // Paths with spaces must survive the child command line
+    TmpDir dir = app->getTmpDirManager().tmpDir("parallel catchup");
+    auto trustedFile = dir.getName() + "/trusted.json";
+    std::map<uint32_t, Hash> trusted;
+    {
+        Json::Value root(Json::arrayValue);
+        for (auto const& checkpoint :
+             catchupSimulation.getAllPublishedCheckpoints())
+        {
+            trusted[checkpoint.first] = *checkpoint.second;
+            Json::Value pair(Json::arrayValue);
+            pair.append(Json::UInt(checkpoint.first));
+            pair.append(binToHex(*checkpoint.second));
+            root.append(pair);
+        }
+        std::ofstream out(trustedFile);
+        out << root;
+    }
+
+    // Instead of catching up, the segment processes only copy the catchup
+    // info of their destination ledger
+    auto writeInfo = [&](uint32_t ledger, Hash const& hash) {
+        Json::Value root;
+        root["info"]["ledger"]["num"] = ledger;
+        root["info"]["ledger"]["hash"] = binToHex(hash);
+        auto file =
+            fmt::format(FMT_STRING("{}/info-{:d}.json"), dir.getName(), ledger);
+        std::ofstream out(file);
+        out << root;
+        return file;
+    };
+    std::map<uint32_t, std::string> infoFiles;
+    for (size_t i = 0; i + 1 < segments.size(); ++i)
+    {
+        auto ledger = segments[i].toLedger();
+        infoFiles[ledger] = writeInfo(ledger, trusted.at(ledger));
+    }
+    auto segmentCommand = [&](CatchupConfiguration const& segment,
+                              std::string const& segmentDir) {
+        return fmt::format(FMT_STRING("cp \"{}\" \"{}/info.json\""),
+                           infoFiles.at(segment.toLedger()), segmentDir);
+    };
+
+    int expected = 0;
+    SECTION("segments match")
+    {
+    }
+    SECTION("segment hash mismatch")
+    {
+        auto ledger = segments[0].toLedger();
+        infoFiles[ledger] = writeInfo(ledger, HashUtils::random());
+        expected = 3;
+    }
+    SECTION("segment ends on the wrong ledger")
+    {
+        auto ledger = segments[1].toLedger();
+        infoFiles[ledger] = writeInfo(segments[0].toLedger(),
+                                      trusted.at(segments[0].toLedger()));
+        expected = 3;
+    }
+
+    Json::Value catchupInfo;
+    REQUIRE(catchupVerifyingInParallel(app, segments, segmentCommand,
+                                       trustedFile, catchupInfo,
+                                       nullptr) == expected);
+    // This process catches up the last segment in any case
+    REQUIRE(app->getLedgerManager().getLastClosedLedgerNum() ==
+            checkpointLedger);
+    REQUIRE(!catchupInfo.isNull());
+
+    for (size_t i = 0; i + 1 < segments.size(); ++i)
+    {
+        std::filesystem::remove(fmt::format(
+            FMT_STRING("catchup-segment-{:d}.log"), segments[i].toLedger()));
+    }
+}
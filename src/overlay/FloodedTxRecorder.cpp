@@ -0,0 +1,45 @@
+// Copyright 2023 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "overlay/FloodedTxRecorder.h"
+#include "main/Application.h"
+#include "util/Logging.h"
+#include <Tracy.hpp>
+
+namespace stellar
+{
+
+FloodedTxRecorder::FloodedTxRecorder(Application& app, std::string const& path)
+    : mOut(app.getClock().getIOContext(), /*fsyncOnClose=*/false)
+{
+    mOut.open(path);
+    CLOG_INFO(Overlay, "Recording flooded transactions to {}", path);
+}
+
+void
+FloodedTxRecorder::record(TransactionEnvelope const& tx,
+                          uint64_t arrivalTimeMicros)
+{
+    ZoneScoped;
+    mOut.writeOne(arrivalTimeMicros);
+    mOut.writeOne(tx);
+}
+
+bool
+FloodedTxRecorder::readNext(XDRInputFileStream& in,
+                            uint64_t& arrivalTimeMicros,
+                            TransactionEnvelope& tx)
+{
+    if (!in.readOne(arrivalTimeMicros))
+    {
+        return false;
+    }
+    if (!in.readOne(tx))
+    {
+        throw std::runtime_error(
+            "malformed flooded transaction stream: missing envelope");
+    }
+    return true;
+}
+}
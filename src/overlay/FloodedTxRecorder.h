@@ -0,0 +1,43 @@
+#pragma once
+
+// Copyright 2023 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+#include "util/XDRStream.h"
+#include "xdr/Stellar-transaction.h"
+
+#include <string>
+
+namespace stellar
+{
+
+class Application;
+
+// FloodedTxRecorder writes every new transaction received from the network via
+// flooding and accepted in the transaction queue to an XDR stream, together
+// with the time it arrived at this node. The file is overwritten when the
+// recorder is created.
+// The resulting file captures the real distribution of sources, fees and
+// operations seen by the transaction queue and can be replayed offline with
+// the `simulate-tx-queue` command.
+//
+// Each transaction is stored as two consecutive XDR records: the arrival time
+// as a `uint64` number of microseconds since the epoch, followed by the
+// `TransactionEnvelope` itself.
+class FloodedTxRecorder : public NonMovableOrCopyable
+{
+    XDROutputFileStream mOut;
+
+  public:
+    FloodedTxRecorder(Application& app, std::string const& path);
+
+    void record(TransactionEnvelope const& tx, uint64_t arrivalTimeMicros);
+
+    // Reads the next recorded transaction from `in`. Returns `false` when the
+    // end of the stream is reached.
+    static bool readNext(XDRInputFileStream& in, uint64_t& arrivalTimeMicros,
+                         TransactionEnvelope& tx);
+};
+}
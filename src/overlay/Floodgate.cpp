@@ -15,15 +15,72 @@
 #include "util/XDROperators.h"
 #include "xdrpp/marshal.h"
 #include <Tracy.hpp>
+#include <algorithm>
 #include <fmt/format.h>
 
 namespace stellar
 {
-Floodgate::FloodRecord::FloodRecord(uint32_t ledger, Peer::pointer peer)
-    : mLedgerSeq(ledger)
+uint64_t const*
+Floodgate::PeerSlotSet::findWord(size_t slot) const
+{
+    size_t word = slot / 64;
+    if (word < INLINE_WORDS)
+    {
+        return &mInline[word];
+    }
+    word -= INLINE_WORDS;
+    return word < mOverflow.size() ? &mOverflow[word] : nullptr;
+}
+
+bool
+Floodgate::PeerSlotSet::insert(size_t slot)
+{
+    size_t word = slot / 64;
+    uint64_t* w;
+    if (word < INLINE_WORDS)
+    {
+        w = &mInline[word];
+    }
+    else
+    {
+        word -= INLINE_WORDS;
+        if (word >= mOverflow.size())
+        {
+            mOverflow.resize(word + 1, 0);
+        }
+        w = &mOverflow[word];
+    }
+    uint64_t bit = uint64_t(1) << (slot % 64);
+    if (*w & bit)
+    {
+        return false;
+    }
+    *w |= bit;
+    ++mSize;
+    return true;
+}
+
+void
+Floodgate::PeerSlotSet::erase(size_t slot)
+{
+    auto w = const_cast<uint64_t*>(findWord(slot));
+    uint64_t bit = uint64_t(1) << (slot % 64);
+    if (w && (*w & bit))
+    {
+        *w &= ~bit;
+        --mSize;
+    }
+}
+
+bool
+Floodgate::PeerSlotSet::contains(size_t slot) const
+{
+    auto w = findWord(slot);
+    return w && (*w & (uint64_t(1) << (slot % 64)));
+}
+
+Floodgate::FloodRecord::FloodRecord(uint32_t ledger) : mLedgerSeq(ledger)
 {
-    if (peer)
-        mPeersTold.insert(peer->toString());
 }
 
 Floodgate::Floodgate(Application& app)
@@ -45,7 +102,7 @@ Floodgate::clearBelow(uint32_t maxLedger)
     ZoneScoped;
     for (auto it = mFloodMap.cbegin(); it != mFloodMap.cend();)
     {
-        if (it->second->mLedgerSeq < maxLedger)
+        if (it->second.mLedgerSeq < maxLedger)
         {
             it = mFloodMap.erase(it);
         }
@@ -55,6 +112,14 @@ Floodgate::clearBelow(uint32_t maxLedger)
         }
     }
     mFloodMapSize.set_count(mFloodMap.size());
+
+    // No record refers to these slots anymore, they can be reused
+    while (!mRetiredPeerSlots.empty() &&
+           mRetiredPeerSlots.front().first < maxLedger)
+    {
+        mFreePeerSlots.emplace_back(mRetiredPeerSlots.front().second);
+        mRetiredPeerSlots.pop_front();
+    }
 }
 
 bool
@@ -66,21 +131,51 @@ Floodgate::addRecord(StellarMessage const& msg, Peer::pointer peer, Hash& index)
     {
         return false;
     }
-    auto result = mFloodMap.find(index);
-    if (result == mFloodMap.end())
+    auto ledger = mApp.getHerder().trackingConsensusLedgerIndex();
+    auto res = mFloodMap.try_emplace(index, ledger);
+    if (peer)
+    {
+        if (auto slot = getPeerSlot(*peer))
+        {
+            res.first->second.mPeersTold.insert(*slot);
+        }
+    }
+    if (res.second)
     { // we have never seen this message
-        mFloodMap[index] = std::make_shared<FloodRecord>(
-            mApp.getHerder().trackingConsensusLedgerIndex(), peer);
+        mMaxRecordLedger = std::max(mMaxRecordLedger, ledger);
         mFloodMapSize.set_count(mFloodMap.size());
         TracyPlot("overlay.memory.flood-known",
                   static_cast<int64_t>(mFloodMap.size()));
-        return true;
+    }
+    return res.second;
+}
+
+std::optional<size_t>
+Floodgate::getPeerSlot(Peer const& peer)
+{
+    // only authenticated peers get a slot: they are guaranteed to go through
+    // `OverlayManager::removePeer` (and hence `forgetPeer`) when dropped
+    if (!peer.isAuthenticated())
+    {
+        return std::nullopt;
+    }
+    auto it = mPeerSlots.find(&peer);
+    if (it != mPeerSlots.end())
+    {
+        return it->second;
+    }
+    size_t slot;
+    if (mFreePeerSlots.empty())
+    {
+        slot = mPeerSlotCount++;
     }
     else
     {
-        result->second->mPeersTold.insert(peer->toString());
-        return false;
+        slot = mFreePeerSlots.back();
+        mFreePeerSlots.pop_back();
     }
+    mPeerSlots.emplace(&peer, slot);
+    return slot;
 }
 
 // send message to anyone you haven't gotten it from
@@ -100,21 +195,20 @@ Floodgate::broadcast(StellarMessage const& msg, bool force,
     }
     Hash index = xdrBlake2(msg);
 
-    FloodRecord::pointer fr;
-    auto result = mFloodMap.find(index);
-    if (result == mFloodMap.end() || force)
-    { // no one has sent us this message / start from scratch
-        fr = std::make_shared<FloodRecord>(
-            mApp.getHerder().trackingConsensusLedgerIndex(), Peer::pointer());
-        mFloodMap[index] = fr;
+    auto ledger = mApp.getHerder().trackingConsensusLedgerIndex();
+    auto res = mFloodMap.try_emplace(index, ledger);
+    if (res.second)
+    {
+        mMaxRecordLedger = std::max(mMaxRecordLedger, ledger);
         mFloodMapSize.set_count(mFloodMap.size());
     }
-    else
-    {
-        fr = result->second;
+    else if (force)
+    { // start from scratch
+        mMaxRecordLedger = std::max(mMaxRecordLedger, ledger);
+        res.first->second = FloodRecord(ledger);
     }
     // send it to people that haven't sent it to us
-    auto& peersTold = fr->mPeersTold;
+    auto& peersTold = res.first->second.mPeersTold;
 
     // make a copy, in case peers gets modified
     auto peers = mApp.getOverlayManager().getAuthenticatedPeers();
@@ -127,7 +221,10 @@ Floodgate::broadcast(StellarMessage const& msg, bool force,
         bool pullMode = msg.type() == TRANSACTION;
         bool hasAdvert = pullMode && peer.second->peerKnowsHash(hash.value());
 
-        if (peersTold.insert(peer.second->toString()).second && !hasAdvert)
+        auto slot = getPeerSlot(*peer.second);
+        releaseAssert(slot);
+
+        if (peersTold.insert(*slot) && !hasAdvert)
         {
             if (pullMode)
             {
@@ -165,15 +262,20 @@ Floodgate::getPeersKnows(Hash const& h)
     auto record = mFloodMap.find(h);
     if (record != mFloodMap.end())
     {
-        auto& ids = record->second->mPeersTold;
-        auto const& peers = mApp.getOverlayManager().getAuthenticatedPeers();
-        for (auto& p : peers)
-        {
-            if (ids.find(p.second->toString()) != ids.end())
+        auto const& told = record->second.mPeersTold;
+        auto check = [&](std::map<NodeID, Peer::pointer> const& peers) {
+            for (auto const& p : peers)
             {
-                res.insert(p.second);
+                auto slot = mPeerSlots.find(p.second.get());
+                if (slot != mPeerSlots.end() && told.contains(slot->second))
+                {
+                    res.insert(p.second);
+                }
             }
-        }
+        };
+        auto& om = mApp.getOverlayManager();
+        check(om.getInboundAuthenticatedPeers());
+        check(om.getOutboundAuthenticatedPeers());
     }
     return res;
 }
@@ -183,6 +285,9 @@ Floodgate::shutdown()
 {
     mShuttingDown = true;
     mFloodMap.clear();
+    mPeerSlots.clear();
+    mFreePeerSlots.clear();
+    mRetiredPeerSlots.clear();
 }
 
 void
@@ -190,4 +295,18 @@ Floodgate::forgetRecord(Hash const& h)
 {
     mFloodMap.erase(h);
 }
+
+void
+Floodgate::forgetPeer(Peer const& peer)
+{
+    auto it = mPeerSlots.find(&peer);
+    if (it == mPeerSlots.end())
+    {
+        return;
+    }
+    // Records created until now may still have the slot set: keep it out of
+    // use until `clearBelow` drops them
+    mRetiredPeerSlots.emplace_back(mMaxRecordLedger, it->second);
+    mPeerSlots.erase(it);
+}
 }
@@ -6,7 +6,13 @@
 
 #include "overlay/Peer.h"
 #include "overlay/StellarXDR.h"
-#include <map>
+#include "util/HashOfHash.h"
+#include "util/UnorderedMap.h"
+#include <array>
+#include <deque>
+#include <optional>
+#include <set>
+#include <vector>
 
 /**
  * FloodGate keeps track of which peers have sent us which broadcast messages,
@@ -31,24 +37,66 @@ namespace stellar
 
 class Floodgate
 {
-    class FloodRecord
+  public:
+    // Set of the slots assigned to peers (see `getPeerSlot`). The first
+    // `INLINE_SLOTS` slots are stored inline, which covers typical peer counts
+    // without any allocation.
+    class PeerSlotSet
     {
+        static constexpr size_t INLINE_WORDS = 2;
+        std::array<uint64_t, INLINE_WORDS> mInline{};
+        std::vector<uint64_t> mOverflow;
+        size_t mSize{0};
+
+        uint64_t const* findWord(size_t slot) const;
+
       public:
-        typedef std::shared_ptr<FloodRecord> pointer;
+        static constexpr size_t INLINE_SLOTS = INLINE_WORDS * 64;
 
-        uint32_t mLedgerSeq;
-        std::set<std::string> mPeersTold;
+        // returns true if `slot` wasn't in the set
+        bool insert(size_t slot);
+        void erase(size_t slot);
+        bool contains(size_t slot) const;
+        size_t
+        size() const
+        {
+            return mSize;
+        }
+    };
+
+  private:
+    struct FloodRecord
+    {
+        FloodRecord(uint32_t ledger);
 
-        FloodRecord(uint32_t ledger, Peer::pointer peer);
+        uint32_t mLedgerSeq;
+        PeerSlotSet mPeersTold;
     };
 
-    std::map<Hash, FloodRecord::pointer> mFloodMap;
+    UnorderedMap<Hash, FloodRecord> mFloodMap;
+
+    // Highest ledger of the records created so far
+    uint32_t mMaxRecordLedger{0};
+
+    // Dense slots of the authenticated peers that have been involved in
+    // flooding. The slot of a removed peer is retired until `clearBelow`
+    // drops all the records that may refer to it, and then reused by new
+    // peers: this avoids walking all the records on every disconnection.
+    UnorderedMap<Peer const*, size_t> mPeerSlots;
+    std::vector<size_t> mFreePeerSlots;
+    // Slots of removed peers, with the highest record ledger at the time of
+    // the removal, by increasing ledger
+    std::deque<std::pair<uint32_t, size_t>> mRetiredPeerSlots;
+    size_t mPeerSlotCount{0};
+
     Application& mApp;
     medida::Counter& mFloodMapSize;
     medida::Meter& mSendFromBroadcast;
     medida::Meter& mMessagesAdvertised;
     bool mShuttingDown;
 
+    std::optional<size_t> getPeerSlot(Peer const& peer);
+
   public:
     Floodgate(Application& app);
     // forget data strictly older than `maxLedger`
@@ -71,6 +119,19 @@ class Floodgate
     // `msgID` corresponds to a `StellarMessage`
     void forgetRecord(Hash const& msgID);
 
+    // retires the slot of a peer that is being removed
+    void forgetPeer(Peer const& peer);
+
     void shutdown();
+
+#ifdef BUILD_TESTS
+    std::optional<size_t>
+    getPeerSlotForTesting(Peer const& peer) const
+    {
+        auto it = mPeerSlots.find(&peer);
+        return it == mPeerSlots.end() ? std::nullopt
+                                      : std::make_optional(it->second);
+    }
+#endif
 };
 }
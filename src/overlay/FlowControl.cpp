@@ -11,6 +11,7 @@
 #include "overlay/OverlayManager.h"
 #include "overlay/OverlayMetrics.h"
 #include "util/Logging.h"
+#include "util/numeric.h"
 #include <Tracy.hpp>
 
 namespace stellar
@@ -19,6 +20,24 @@ namespace stellar
 constexpr std::chrono::seconds const OUTBOUND_QUEUE_TIMEOUT =
     std::chrono::seconds(30);
 
+// Weight of the most recent sample in the flood capacity auto-tuning averages
+constexpr double const CAPACITY_TUNING_EWMA_ALPHA = 0.2;
+// How long a minimum SEND_MORE round-trip time measurement is trusted
+constexpr std::chrono::seconds const MIN_RTT_WINDOW = std::chrono::seconds(10);
+
+static void
+updateAverage(std::optional<double>& average, double sample)
+{
+    if (average)
+    {
+        *average += CAPACITY_TUNING_EWMA_ALPHA * (sample - *average);
+    }
+    else
+    {
+        average = sample;
+    }
+}
+
 size_t
 FlowControl::getOutboundQueueByteLimit() const
 {
@@ -76,8 +95,7 @@ FlowControl::hasOutboundCapacity(StellarMessage const& msg) const
 
 // Start flow control: send SEND_MORE to a peer to indicate available capacity
 void
-FlowControl::start(std::weak_ptr<Peer> peer,
-                   std::function<void(StellarMessage const&)> sendCb,
+FlowControl::start(std::weak_ptr<Peer> peer, SendCallback sendCb,
                    bool enableFCBytes)
 {
     auto peerPtr = peer.lock();
@@ -89,6 +107,7 @@ FlowControl::start(std::weak_ptr<Peer> peer,
     mNodeID = peerPtr->getPeerID();
     mSendCallback = sendCb;
 
+    mCapacityTuning.mGranted = mApp.getConfig().PEER_FLOOD_READING_CAPACITY;
     if (enableFCBytes)
     {
         mFlowControlBytesCapacity =
@@ -164,7 +183,7 @@ FlowControl::maybeSendNextBatch()
                 break;
             }
 
-            mSendCallback(msg);
+            mSendCallback(front.mMessage);
             ++sent;
             auto& om = mApp.getOverlayManager().getOverlayMetrics();
 
@@ -243,9 +262,147 @@ FlowControl::maybeSendMessage(std::shared_ptr<StellarMessage const> msg)
 bool
 FlowControl::beginMessageProcessing(StellarMessage const& msg)
 {
-    return mFlowControlCapacity->lockLocalCapacity(msg) &&
-           (!mFlowControlBytesCapacity ||
-            mFlowControlBytesCapacity->lockLocalCapacity(msg));
+    bool res = mFlowControlCapacity->lockLocalCapacity(msg) &&
+               (!mFlowControlBytesCapacity ||
+                mFlowControlBytesCapacity->lockLocalCapacity(msg));
+    if (res && mApp.getConfig().FLOW_CONTROL_AUTO_TUNE &&
+        mApp.getOverlayManager().isFloodMessage(msg))
+    {
+        recordFloodMessageReceived();
+    }
+    return res;
+}
+
+bool
+FlowControl::beginMessageProcessing(MessageType type, size_t msgSize)
+{
+    bool res = mFlowControlCapacity->lockLocalCapacity(type, msgSize) &&
+               (!mFlowControlBytesCapacity ||
+                mFlowControlBytesCapacity->lockLocalCapacity(type, msgSize));
+    if (res && mApp.getConfig().FLOW_CONTROL_AUTO_TUNE &&
+        OverlayManager::isFloodMessageType(type))
+    {
+        recordFloodMessageReceived();
+    }
+    return res;
+}
+
+void
+FlowControl::cancelMessageProcessing(MessageType type, size_t msgSize)
+{
+    mFlowControlCapacity->releaseLocalCapacity(type, msgSize);
+    if (mFlowControlBytesCapacity)
+    {
+        mFlowControlBytesCapacity->releaseLocalCapacity(type, msgSize);
+    }
+}
+
+void
+FlowControl::recordFloodMessageReceived()
+{
+    auto& tuning = mCapacityTuning;
+    ++tuning.mReceived;
+    // The first message granted by a SEND_MORE is sent as soon as the peer
+    // receives it when the peer is out of capacity, and later otherwise, so
+    // the minimum over recent SEND_MOREs is the round-trip time.
+    auto now = mApp.getClock().now();
+    while (!tuning.mProbes.empty() &&
+           tuning.mProbes.front().first <= tuning.mReceived)
+    {
+        auto rtt = std::chrono::duration<double, std::milli>(
+                       now - tuning.mProbes.front().second)
+                       .count();
+        if (!tuning.mMinRttMs || rtt <= *tuning.mMinRttMs ||
+            now - tuning.mMinRttTime >= MIN_RTT_WINDOW)
+        {
+            tuning.mMinRttMs = rtt;
+            tuning.mMinRttTime = now;
+        }
+        tuning.mProbes.pop_front();
+    }
+}
+
+std::pair<int64_t, int64_t>
+FlowControl::tuneCapacity()
+{
+    ZoneScoped;
+    auto const& cfg = mApp.getConfig();
+    auto& tuning = mCapacityTuning;
+    auto now = mApp.getClock().now();
+
+    if (tuning.mLastSendMore && now > *tuning.mLastSendMore)
+    {
+        updateAverage(tuning.mDrainRate,
+                      mFloodDataProcessed /
+                          std::chrono::duration<double>(
+                              now - *tuning.mLastSendMore)
+                              .count());
+    }
+    tuning.mLastSendMore = now;
+
+    // Target twice the bandwidth-delay product of the connection, plus what
+    // we keep before granting capacity back. While the peer is limited by its
+    // capacity, the drain rate is capacity / RTT, so the capacity doubles;
+    // otherwise it converges to twice what the peer needs. Shrink slowly to
+    // avoid oscillating around the limit.
+    auto limit = mFlowControlCapacity->getCapacityLimits().mFloodCapacity;
+    uint64_t bdp = 0;
+    if (tuning.mDrainRate && tuning.mMinRttMs)
+    {
+        bdp = static_cast<uint64_t>(*tuning.mDrainRate * *tuning.mMinRttMs /
+                                    1000.0);
+    }
+    uint64_t target = 2 * bdp + cfg.FLOW_CONTROL_SEND_MORE_BATCH_SIZE;
+    target = std::max(target, limit - limit / 8);
+    target = std::max<uint64_t>(
+        target, std::max(cfg.PEER_FLOOD_READING_CAPACITY_MIN,
+                         cfg.FLOW_CONTROL_SEND_MORE_BATCH_SIZE));
+    target = std::min<uint64_t>(target, cfg.PEER_FLOOD_READING_CAPACITY_MAX);
+
+    // Capacity can only be taken back from the peer by granting it less than
+    // what was processed, and each SEND_MORE must grant something.
+    auto delta = static_cast<int64_t>(target) - static_cast<int64_t>(limit);
+    delta = std::max(delta, 1 - static_cast<int64_t>(mFloodDataProcessed));
+    mFlowControlCapacity->adjustFloodCapacity(delta);
+
+    int64_t deltaBytes = 0;
+    if (mFlowControlBytesCapacity)
+    {
+        uint64_t newLimit = limit + delta;
+        uint64_t targetBytes = static_cast<uint64_t>(
+            bigDivideOrThrow(cfg.PEER_FLOOD_READING_CAPACITY_BYTES, newLimit,
+                             cfg.PEER_FLOOD_READING_CAPACITY,
+                             Rounding::ROUND_DOWN));
+        // Never go below what's needed to always be able to send the largest
+        // transaction
+        targetBytes = std::max<uint64_t>(
+            targetBytes, std::min<uint64_t>(
+                             cfg.PEER_FLOOD_READING_CAPACITY_BYTES,
+                             cfg.FLOW_CONTROL_SEND_MORE_BATCH_SIZE_BYTES +
+                                 MAX_CLASSIC_TX_SIZE_BYTES));
+        auto limitBytes =
+            mFlowControlBytesCapacity->getCapacityLimits().mFloodCapacity;
+        deltaBytes = static_cast<int64_t>(targetBytes) -
+                     static_cast<int64_t>(limitBytes);
+        deltaBytes = std::max(
+            deltaBytes, 1 - static_cast<int64_t>(mFloodDataProcessedBytes));
+        mFlowControlBytesCapacity->adjustFloodCapacity(deltaBytes);
+    }
+
+    auto granted = static_cast<int64_t>(mFloodDataProcessed) + delta;
+    tuning.mProbes.emplace_back(tuning.mGranted + 1, now);
+    tuning.mGranted += static_cast<uint64_t>(granted);
+
+    if (delta != 0)
+    {
+        CLOG_DEBUG(Overlay, "Flood capacity for peer {} set to {} ({} bytes)",
+                   cfg.toShortString(mNodeID), limit + delta,
+                   mFlowControlBytesCapacity
+                       ? mFlowControlBytesCapacity->getCapacityLimits()
+                             .mFloodCapacity
+                       : 0);
+    }
+    return {delta, deltaBytes};
 }
 
 void
@@ -276,15 +433,25 @@ FlowControl::endMessageProcessing(StellarMessage const& msg,
 
     if (shouldSendMore && peerPtr)
     {
+        int64_t extraMessages = 0;
+        int64_t extraBytes = 0;
+        if (mApp.getConfig().FLOW_CONTROL_AUTO_TUNE)
+        {
+            std::tie(extraMessages, extraBytes) = tuneCapacity();
+        }
+        auto numMessages = static_cast<uint32>(
+            static_cast<int64_t>(mFloodDataProcessed) + extraMessages);
         if (mFlowControlBytesCapacity)
         {
-            sendSendMore(static_cast<uint32>(mFloodDataProcessed),
-                         static_cast<uint32>(mFloodDataProcessedBytes),
+            sendSendMore(numMessages,
+                         static_cast<uint32>(
+                             static_cast<int64_t>(mFloodDataProcessedBytes) +
+                             extraBytes),
                          peerPtr);
         }
         else
         {
-            sendSendMore(static_cast<uint32>(mFloodDataProcessed), peerPtr);
+            sendSendMore(numMessages, peerPtr);
             releaseAssert(mFloodDataProcessedBytes == 0);
         }
         mFloodDataProcessed = 0;
@@ -546,6 +713,25 @@ FlowControl::getFlowControlJsonInfo(bool compact) const
             mFlowControlBytesCapacity->getOutboundCapacity());
     }
 
+    if (mApp.getConfig().FLOW_CONTROL_AUTO_TUNE)
+    {
+        res["flood_window"] = static_cast<Json::UInt64>(
+            mFlowControlCapacity->getCapacityLimits().mFloodCapacity);
+        if (mFlowControlBytesCapacity)
+        {
+            res["flood_window_bytes"] = static_cast<Json::UInt64>(
+                mFlowControlBytesCapacity->getCapacityLimits().mFloodCapacity);
+        }
+        if (!compact && mCapacityTuning.mMinRttMs)
+        {
+            res["send_more_rtt_ms"] = *mCapacityTuning.mMinRttMs;
+        }
+        if (!compact && mCapacityTuning.mDrainRate)
+        {
+            res["drain_rate"] = *mCapacityTuning.mDrainRate;
+        }
+    }
+
     if (!compact)
     {
         res["outbound_queue_delay_scp_p75"] = static_cast<Json::UInt64>(
@@ -8,6 +8,7 @@
 #include "medida/timer.h"
 #include "overlay/FlowControlCapacity.h"
 #include "util/Timer.h"
+#include <deque>
 #include <optional>
 
 namespace stellar
@@ -34,6 +35,9 @@ class FlowControl
         VirtualClock::time_point mTimeEmplaced;
     };
 
+    using SendCallback =
+        std::function<void(std::shared_ptr<StellarMessage const> const&)>;
+
   private:
     struct FlowControlMetrics
     {
@@ -71,7 +75,32 @@ class FlowControl
     uint64_t mFloodDataProcessedBytes{0};
     std::optional<VirtualClock::time_point> mNoOutboundCapacity;
     FlowControlMetrics mMetrics;
-    std::function<void(StellarMessage const&)> mSendCallback;
+    SendCallback mSendCallback;
+
+    // State of the flood capacity auto-tuning (see FLOW_CONTROL_AUTO_TUNE)
+    struct CapacityTuning
+    {
+        // Flood messages granted to and received from the peer so far
+        uint64_t mGranted{0};
+        uint64_t mReceived{0};
+        // For each SEND_MORE whose first granted message hasn't arrived yet:
+        // the index of that message and when the SEND_MORE was sent
+        std::deque<std::pair<uint64_t, VirtualClock::time_point>> mProbes;
+        std::optional<VirtualClock::time_point> mLastSendMore;
+        // Recent minimum of the SEND_MORE round-trip time, in milliseconds,
+        // and when it was measured
+        std::optional<double> mMinRttMs;
+        VirtualClock::time_point mMinRttTime;
+        // Moving average of the rate at which the peer's flood messages are
+        // processed, in messages per second
+        std::optional<double> mDrainRate;
+    };
+    CapacityTuning mCapacityTuning;
+    void recordFloodMessageReceived();
+    // Updates the flood capacity limits and returns how much the next
+    // SEND_MORE must grant on top of (or, when negative, withhold from) the
+    // processed messages and bytes.
+    std::pair<int64_t, int64_t> tuneCapacity();
 
     // Release capacity used by this message. Return a struct that indicates how
     // much reading and flood capacity was freed
@@ -139,6 +168,17 @@ class FlowControl
     {
         mOutboundQueueLimit = std::make_optional<size_t>(bytes);
     }
+
+    // Tunes the capacity as if the given drain rate (in flood messages per
+    // second) and round-trip time had been measured
+    std::pair<int64_t, int64_t>
+    tuneCapacityForTesting(double drainRate, double minRttMs)
+    {
+        mCapacityTuning.mDrainRate = drainRate;
+        mCapacityTuning.mMinRttMs = minRttMs;
+        mCapacityTuning.mLastSendMore.reset();
+        return tuneCapacity();
+    }
 #endif
 
     static uint32_t getNumMessages(StellarMessage const& msg);
@@ -148,6 +188,12 @@ class FlowControl
     // This method ensures local capacity is locked now that we've received a
     // new message
     bool beginMessageProcessing(StellarMessage const& msg);
+    // Same as above, for a message that is received but not decoded yet, of
+    // type `type` and serialized in `msgSize` bytes. Once decoded, the message
+    // is processed with the capacity locked here; if it can't be decoded, the
+    // capacity is given back with `cancelMessageProcessing`.
+    bool beginMessageProcessing(MessageType type, size_t msgSize);
+    void cancelMessageProcessing(MessageType type, size_t msgSize);
 
     // This method ensures local capacity is released now that we've finished
     // processing the message. It returns available capacity that can now be
@@ -167,8 +213,7 @@ class FlowControl
 
     Json::Value getFlowControlJsonInfo(bool compact) const;
 
-    void start(std::weak_ptr<Peer> peer,
-               std::function<void(StellarMessage const&)> sendCb,
+    void start(std::weak_ptr<Peer> peer, SendCallback sendCb,
                bool enableFCBytes);
 };
 
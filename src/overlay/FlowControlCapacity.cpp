@@ -26,12 +26,19 @@ FlowControlMessageCapacity::getMsgResourceCount(StellarMessage const& msg) const
     return 1;
 }
 
+uint64_t
+FlowControlMessageCapacity::getMsgResourceCount(size_t msgSize) const
+{
+    return 1;
+}
+
 FlowControlCapacity::ReadingCapacity
 FlowControlMessageCapacity::getCapacityLimits() const
 {
-    return {
-        mApp.getConfig().PEER_FLOOD_READING_CAPACITY,
-        std::make_optional<uint64_t>(mApp.getConfig().PEER_READING_CAPACITY)};
+    return {mTunedFloodCapacity.value_or(
+                mApp.getConfig().PEER_FLOOD_READING_CAPACITY),
+            std::make_optional<uint64_t>(mTunedTotalCapacity.value_or(
+                mApp.getConfig().PEER_READING_CAPACITY))};
 }
 
 void
@@ -66,7 +73,9 @@ FlowControlByteCapacity::FlowControlByteCapacity(Application& app,
 FlowControlCapacity::ReadingCapacity
 FlowControlByteCapacity::getCapacityLimits() const
 {
-    return {mApp.getConfig().PEER_FLOOD_READING_CAPACITY_BYTES, std::nullopt};
+    return {mTunedFloodCapacity.value_or(
+                mApp.getConfig().PEER_FLOOD_READING_CAPACITY_BYTES),
+            std::nullopt};
 }
 
 uint64_t
@@ -76,6 +85,12 @@ FlowControlByteCapacity::getMsgResourceCount(StellarMessage const& msg) const
     return static_cast<uint64_t>(xdr::xdr_argpack_size(msg));
 }
 
+uint64_t
+FlowControlByteCapacity::getMsgResourceCount(size_t msgSize) const
+{
+    return static_cast<uint64_t>(msgSize);
+}
+
 void
 FlowControlByteCapacity::releaseOutboundCapacity(StellarMessage const& msg)
 {
@@ -120,6 +135,44 @@ FlowControlCapacity::checkCapacityInvariants() const
     }
 }
 
+void
+FlowControlCapacity::adjustFloodCapacity(int64_t delta)
+{
+    ZoneScoped;
+    auto limits = getCapacityLimits();
+    auto limit = limits.mFloodCapacity;
+    if (delta >= 0)
+    {
+        limit += static_cast<uint64_t>(delta);
+        mCapacity.mFloodCapacity += static_cast<uint64_t>(delta);
+    }
+    else
+    {
+        auto shrinkBy = static_cast<uint64_t>(-delta);
+        releaseAssert(mCapacity.mFloodCapacity >= shrinkBy);
+        limit -= shrinkBy;
+        mCapacity.mFloodCapacity -= shrinkBy;
+    }
+    mTunedFloodCapacity = limit;
+
+    if (limits.mTotalCapacity)
+    {
+        auto const& cfg = mApp.getConfig();
+        uint64_t otherCapacity =
+            cfg.PEER_READING_CAPACITY > cfg.PEER_FLOOD_READING_CAPACITY
+                ? cfg.PEER_READING_CAPACITY - cfg.PEER_FLOOD_READING_CAPACITY
+                : 0;
+        if (limit + otherCapacity > *limits.mTotalCapacity)
+        {
+            releaseAssert(mCapacity.mTotalCapacity);
+            *mCapacity.mTotalCapacity +=
+                limit + otherCapacity - *limits.mTotalCapacity;
+            mTunedTotalCapacity = limit + otherCapacity;
+        }
+    }
+    checkCapacityInvariants();
+}
+
 void
 FlowControlCapacity::lockOutboundCapacity(StellarMessage const& msg)
 {
@@ -133,17 +186,30 @@ FlowControlCapacity::lockOutboundCapacity(StellarMessage const& msg)
 
 bool
 FlowControlCapacity::lockLocalCapacity(StellarMessage const& msg)
+{
+    return lockLocalResources(mApp.getOverlayManager().isFloodMessage(msg),
+                              getMsgResourceCount(msg));
+}
+
+bool
+FlowControlCapacity::lockLocalCapacity(MessageType type, size_t msgSize)
+{
+    return lockLocalResources(OverlayManager::isFloodMessageType(type),
+                              getMsgResourceCount(msgSize));
+}
+
+bool
+FlowControlCapacity::lockLocalResources(bool isFlood, uint64_t msgResources)
 {
     ZoneScoped;
     checkCapacityInvariants();
-    auto msgResources = getMsgResourceCount(msg);
     if (mCapacity.mTotalCapacity)
     {
         releaseAssert(*mCapacity.mTotalCapacity >= msgResources);
         *mCapacity.mTotalCapacity -= msgResources;
     }
 
-    if (mApp.getOverlayManager().isFloodMessage(msg))
+    if (isFlood)
     {
         // No capacity to process flood message
         if (mCapacity.mFloodCapacity < msgResources)
@@ -164,16 +230,30 @@ FlowControlCapacity::lockLocalCapacity(StellarMessage const& msg)
 
 uint64_t
 FlowControlCapacity::releaseLocalCapacity(StellarMessage const& msg)
+{
+    return releaseLocalResources(mApp.getOverlayManager().isFloodMessage(msg),
+                                 getMsgResourceCount(msg));
+}
+
+uint64_t
+FlowControlCapacity::releaseLocalCapacity(MessageType type, size_t msgSize)
+{
+    return releaseLocalResources(OverlayManager::isFloodMessageType(type),
+                                 getMsgResourceCount(msgSize));
+}
+
+uint64_t
+FlowControlCapacity::releaseLocalResources(bool isFlood,
+                                           uint64_t resourcesFreed)
 {
     ZoneScoped;
     uint64_t releasedFloodCapacity = 0;
-    size_t resourcesFreed = getMsgResourceCount(msg);
     if (mCapacity.mTotalCapacity)
     {
         *mCapacity.mTotalCapacity += resourcesFreed;
     }
 
-    if (mApp.getOverlayManager().isFloodMessage(msg))
+    if (isFlood)
     {
         if (mCapacity.mFloodCapacity == 0)
         {
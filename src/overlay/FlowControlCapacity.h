@@ -30,19 +30,38 @@ class FlowControlCapacity
     uint64_t mOutboundCapacity{0};
     NodeID const& mNodeID;
 
+    // Flood capacity limit set by `adjustFloodCapacity`, overriding the
+    // configured one
+    std::optional<uint64_t> mTunedFloodCapacity;
+    // Total capacity limit grown by `adjustFloodCapacity` to fit the flood
+    // capacity, overriding the configured one
+    std::optional<uint64_t> mTunedTotalCapacity;
+
   public:
     virtual uint64_t getMsgResourceCount(StellarMessage const& msg) const = 0;
+    // Same as above, for a message serialized in `msgSize` bytes
+    virtual uint64_t getMsgResourceCount(size_t msgSize) const = 0;
     virtual ReadingCapacity getCapacityLimits() const = 0;
     virtual void releaseOutboundCapacity(StellarMessage const& msg) = 0;
 
     void lockOutboundCapacity(StellarMessage const& msg);
     bool lockLocalCapacity(StellarMessage const& msg);
+    // Same as above, for a message that is received but not decoded yet, of
+    // type `type` and serialized in `msgSize` bytes
+    bool lockLocalCapacity(MessageType type, size_t msgSize);
     // Release capacity used by this message. Return how flood capacity was
     // freed
     uint64_t releaseLocalCapacity(StellarMessage const& msg);
+    uint64_t releaseLocalCapacity(MessageType type, size_t msgSize);
 
     bool hasOutboundCapacity(StellarMessage const& msg) const;
     void checkCapacityInvariants() const;
+    // Grows (or shrinks, for negative `delta`) both the flood capacity limit
+    // and the currently available flood capacity by `delta`. The total
+    // capacity, if any, is grown as needed to keep fitting the flood capacity
+    // and the configured room for other messages; it is never shrunk, as the
+    // messages being processed may hold it.
+    void adjustFloodCapacity(int64_t delta);
     ReadingCapacity
     getCapacity() const
     {
@@ -66,6 +85,10 @@ class FlowControlCapacity
 #endif
 
     FlowControlCapacity(Application& app, NodeID const& nodeID);
+
+  private:
+    bool lockLocalResources(bool isFlood, uint64_t msgResources);
+    uint64_t releaseLocalResources(bool isFlood, uint64_t resourcesFreed);
 };
 
 class FlowControlByteCapacity : public FlowControlCapacity
@@ -76,6 +99,7 @@ class FlowControlByteCapacity : public FlowControlCapacity
     virtual ~FlowControlByteCapacity() = default;
     virtual uint64_t
     getMsgResourceCount(StellarMessage const& msg) const override;
+    virtual uint64_t getMsgResourceCount(size_t msgSize) const override;
     virtual ReadingCapacity getCapacityLimits() const override;
     virtual void releaseOutboundCapacity(StellarMessage const& msg) override;
     bool canRead() const override;
@@ -88,6 +112,7 @@ class FlowControlMessageCapacity : public FlowControlCapacity
     virtual ~FlowControlMessageCapacity() = default;
     virtual uint64_t
     getMsgResourceCount(StellarMessage const& msg) const override;
+    virtual uint64_t getMsgResourceCount(size_t msgSize) const override;
     virtual ReadingCapacity getCapacityLimits() const override;
     void releaseOutboundCapacity(StellarMessage const& msg) override;
     bool canRead() const override;
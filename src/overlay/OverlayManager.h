@@ -46,6 +46,7 @@
 namespace stellar
 {
 
+class OverlayThreadPool;
 class PeerAuth;
 class PeerBareAddress;
 class PeerManager;
@@ -132,6 +133,7 @@ class OverlayManager
     virtual bool isPreferred(Peer* peer) const = 0;
 
     virtual bool isFloodMessage(StellarMessage const& msg) = 0;
+    static bool isFloodMessageType(MessageType type);
 
     // Return the current in-memory set of inbound pending peers.
     virtual std::vector<Peer::pointer> const&
@@ -193,6 +195,20 @@ class OverlayManager
 
     virtual size_t getMaxAdvertSize() const = 0;
 
+    // Returns the XDR serialization of `msg`. The serialization is shared by
+    // all the callers for as long as `msg` is alive, so that a message sent to
+    // many peers is only serialized once.
+    virtual std::shared_ptr<xdr::opaque_vec<> const>
+    getSerializedMessage(std::shared_ptr<StellarMessage const> const& msg) = 0;
+
+    // Returns the pool of threads used to decode and authenticate received
+    // messages, or `nullptr` if OVERLAY_DECODE_THREADS is 0.
+    virtual OverlayThreadPool* getOverlayThreadPool() = 0;
+
+    // Appends a transaction received via flooding to the recording configured
+    // with FLOODED_TX_RECORD_PATH. No-op when recording is disabled.
+    virtual void recordFloodedTransaction(TransactionEnvelope const& tx) = 0;
+
     virtual ~OverlayManager()
     {
     }
@@ -51,6 +51,18 @@ constexpr std::chrono::seconds OUT_OF_SYNC_RECONNECT_DELAY(60);
 // longer than 2 seconds between re-issuing demands.
 constexpr std::chrono::seconds MAX_DELAY_DEMAND{2};
 
+// Weight of the most recent sample in the per-peer pull latency estimates.
+constexpr double DEMAND_LATENCY_EWMA_ALPHA = 0.2;
+
+// Maximum number of outstanding demands to a single peer, as a multiple of
+// the per-message demand limit.
+constexpr size_t MAX_IN_FLIGHT_DEMAND_MULTIPLIER = 2;
+
+// Minimum number of entries in, and bytes held by the serialized message map
+// before sweeping the expired ones.
+constexpr size_t MIN_SERIALIZED_MESSAGES_SWEEP_SIZE = 1024;
+constexpr size_t MIN_SERIALIZED_MESSAGES_SWEEP_BYTES = 16 * 1024 * 1024;
+
 OverlayManagerImpl::PeersList::PeersList(
     OverlayManagerImpl& overlayManager,
     medida::MetricsRegistry& metricsRegistry,
@@ -281,6 +293,8 @@ OverlayManagerImpl::OverlayManagerImpl(Application& app)
     , mDemandTimer(app)
     , mResolvingPeersWithBackoff(true)
     , mResolvingPeersRetryCount(0)
+    , mSerializedMessagesSweepSize(MIN_SERIALIZED_MESSAGES_SWEEP_SIZE)
+    , mSerializedMessagesSweepBytes(MIN_SERIALIZED_MESSAGES_SWEEP_BYTES)
 
 {
     mPeerSources[PeerType::INBOUND] = std::make_unique<RandomPeerSource>(
@@ -289,6 +303,19 @@ OverlayManagerImpl::OverlayManagerImpl(Application& app)
         mPeerManager, RandomPeerSource::nextAttemptCutoff(PeerType::OUTBOUND));
     mPeerSources[PeerType::PREFERRED] = std::make_unique<RandomPeerSource>(
         mPeerManager, RandomPeerSource::nextAttemptCutoff(PeerType::PREFERRED));
+
+    if (mApp.getConfig().OVERLAY_DECODE_THREADS > 0)
+    {
+        mOverlayThreadPool = std::make_unique<OverlayThreadPool>(
+            mApp.getConfig().OVERLAY_DECODE_THREADS);
+    }
+
+    auto const& recordPath = mApp.getConfig().FLOODED_TX_RECORD_PATH;
+    if (!recordPath.empty())
+    {
+        mFloodedTxRecorder =
+            std::make_unique<FloodedTxRecorder>(mApp, recordPath);
+    }
 }
 
 OverlayManagerImpl::~OverlayManagerImpl()
@@ -589,6 +616,10 @@ OverlayManagerImpl::tick()
                           VirtualTimer::onFailureNoop);
     });
 
+    // Release the serializations of the messages sent since the last tick,
+    // large tx sets in particular
+    sweepSerializedMessages();
+
     if (futureIsReady(mResolvedPeers))
     {
         CLOG_TRACE(Overlay, "Resolved peers are ready");
@@ -862,6 +893,7 @@ OverlayManagerImpl::removePeer(Peer* peer)
 {
     ZoneScoped;
     getPeersList(peer).removePeer(peer);
+    mFloodGate.forgetPeer(*peer);
     getPeerManager().removePeersWithManyFailures(
         Config::REALLY_DEAD_NUM_FAILURES_CUTOFF, &peer->getAddress());
     updateSizeCounters();
@@ -966,9 +998,16 @@ OverlayManagerImpl::isPreferred(Peer* peer) const
 bool
 OverlayManagerImpl::isFloodMessage(StellarMessage const& msg)
 {
-    return msg.type() == SCP_MESSAGE || msg.type() == TRANSACTION ||
-           msg.type() == FLOOD_DEMAND || msg.type() == FLOOD_ADVERT;
+    return isFloodMessageType(msg.type());
+}
+
+bool
+OverlayManager::isFloodMessageType(MessageType type)
+{
+    return type == SCP_MESSAGE || type == TRANSACTION ||
+           type == FLOOD_DEMAND || type == FLOOD_ADVERT;
 }
+
 std::vector<Peer::pointer>
 OverlayManagerImpl::getRandomAuthenticatedPeers()
 {
@@ -1095,12 +1134,21 @@ OverlayManagerImpl::shutdown()
     mFloodGate.shutdown();
     mInboundPeers.shutdown();
     mOutboundPeers.shutdown();
+    mPeerManager.shutdown();
 
     mDemandTimer.cancel();
 
     // Stop ticking and resolving peers
     mTimer.cancel();
     mPeerIPTimer.cancel();
+
+    if (mOverlayThreadPool)
+    {
+        mOverlayThreadPool->shutdown();
+    }
+
+    // Flush and close the recording, if any
+    mFloodedTxRecorder.reset();
 }
 
 bool
@@ -1192,6 +1240,78 @@ getOpsFloodLedger(size_t maxOps, double rate)
     return static_cast<int64_t>(opsToFloodPerLedgerDbl);
 }
 
+std::shared_ptr<xdr::opaque_vec<> const>
+OverlayManagerImpl::getSerializedMessage(
+    std::shared_ptr<StellarMessage const> const& msg)
+{
+    ZoneScoped;
+    auto& entry = mSerializedMessages[msg.get()];
+    // The address may belong to a message that has since been destroyed, in
+    // which case the stored weak pointer can't be locked anymore.
+    if (entry.mBytes && entry.mMessage.lock() == msg)
+    {
+        return entry.mBytes;
+    }
+    if (entry.mBytes)
+    {
+        mSerializedMessagesBytes -= entry.mBytes->size();
+    }
+    entry.mMessage = msg;
+    entry.mBytes =
+        std::make_shared<xdr::opaque_vec<> const>(xdr::xdr_to_opaque(*msg));
+    mSerializedMessagesBytes += entry.mBytes->size();
+    auto bytes = entry.mBytes;
+
+    if (mSerializedMessages.size() >= mSerializedMessagesSweepSize ||
+        mSerializedMessagesBytes >= mSerializedMessagesSweepBytes)
+    {
+        sweepSerializedMessages();
+    }
+    return bytes;
+}
+
+void
+OverlayManagerImpl::sweepSerializedMessages()
+{
+    ZoneScoped;
+    for (auto it = mSerializedMessages.begin();
+         it != mSerializedMessages.end();)
+    {
+        if (it->second.mMessage.expired())
+        {
+            mSerializedMessagesBytes -= it->second.mBytes->size();
+            it = mSerializedMessages.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    mSerializedMessagesSweepSize = std::max(MIN_SERIALIZED_MESSAGES_SWEEP_SIZE,
+                                            2 * mSerializedMessages.size());
+    mSerializedMessagesSweepBytes = std::max(
+        MIN_SERIALIZED_MESSAGES_SWEEP_BYTES, 2 * mSerializedMessagesBytes);
+}
+
+OverlayThreadPool*
+OverlayManagerImpl::getOverlayThreadPool()
+{
+    return mOverlayThreadPool.get();
+}
+
+void
+OverlayManagerImpl::recordFloodedTransaction(TransactionEnvelope const& tx)
+{
+    if (!mFloodedTxRecorder)
+    {
+        return;
+    }
+    auto arrivalTime = std::chrono::duration_cast<std::chrono::microseconds>(
+                           mApp.getClock().system_now().time_since_epoch())
+                           .count();
+    mFloodedTxRecorder->record(tx, static_cast<uint64_t>(arrivalTime));
+}
+
 size_t
 OverlayManagerImpl::getMaxAdvertSize() const
 {
@@ -1280,6 +1400,7 @@ OverlayManagerImpl::recordTxPullLatency(Hash const& hash,
             auto delta = now - peerIt->second;
             mOverlayMetrics.mPeerTxPullLatency.Update(delta);
             peer->getPeerMetrics().mPullLatency.Update(delta);
+            updateDemandLatency(mPeerDemandStats[peer->getPeerID()], delta);
             CLOG_DEBUG(
                 Overlay,
                 "Pulled transaction {} in {} milliseconds from peer {}",
@@ -1288,6 +1409,68 @@ OverlayManagerImpl::recordTxPullLatency(Hash const& hash,
                     .count(),
                 peer->toString());
         }
+
+        // No need to wait for the other peers we've asked
+        clearInFlightDemands(hash, it->second);
+    }
+}
+
+void
+OverlayManagerImpl::updateDemandLatency(PeerDemandStats& stats,
+                                        VirtualClock::duration latency)
+{
+    double sample = std::chrono::duration<double, std::milli>(latency).count();
+    if (stats.latencyMs)
+    {
+        *stats.latencyMs +=
+            DEMAND_LATENCY_EWMA_ALPHA * (sample - *stats.latencyMs);
+    }
+    else
+    {
+        stats.latencyMs = sample;
+    }
+}
+
+void
+OverlayManagerImpl::clearInFlightDemands(Hash const& txHash,
+                                         DemandHistory& history)
+{
+    for (auto const& nodeID : history.inFlight)
+    {
+        auto statsIt = mPeerDemandStats.find(nodeID);
+        if (statsIt != mPeerDemandStats.end())
+        {
+            releaseAssert(statsIt->second.inFlight > 0);
+            --statsIt->second.inFlight;
+        }
+    }
+    history.inFlight.clear();
+}
+
+void
+OverlayManagerImpl::expireInFlightDemands()
+{
+    // Demands that aren't answered within FLOOD_DEMAND_BACKOFF_DELAY_MS
+    // are retried with other peers, so stop counting them against the peer
+    // they were sent to, and account for the timeout in its latency.
+    auto const now = mApp.getClock().now();
+    auto const timeout = mApp.getConfig().FLOOD_DEMAND_BACKOFF_DELAY_MS;
+    for (auto& stats : mPeerDemandStats)
+    {
+        auto& demands = stats.second.demands;
+        while (!demands.empty() && (now - demands.front().first) >= timeout)
+        {
+            auto historyIt = mDemandHistoryMap.find(demands.front().second);
+            if (historyIt != mDemandHistoryMap.end() &&
+                historyIt->second.inFlight.erase(stats.first) > 0)
+            {
+                releaseAssert(stats.second.inFlight > 0);
+                --stats.second.inFlight;
+                updateDemandLatency(stats.second,
+                                    now - demands.front().first);
+            }
+            demands.pop_front();
+        }
     }
 }
 
@@ -1359,6 +1542,7 @@ OverlayManagerImpl::demand()
                 // We never received the txn.
                 mOverlayMetrics.mAbandonedDemandMeter.Mark();
             }
+            clearInFlightDemands(it->first, it->second);
             mPendingDemands.pop();
             mDemandHistoryMap.erase(it);
         }
@@ -1370,70 +1554,172 @@ OverlayManagerImpl::demand()
         }
     }
 
+    expireInFlightDemands();
+
     auto peers = getRandomAuthenticatedPeers();
 
     auto const& cfg = mApp.getConfig();
+    auto const maxDemandSize = getMaxDemandSize();
+    auto const maxInFlight = maxDemandSize * MAX_IN_FLIGHT_DEMAND_MULTIPLIER;
+
+    // Drop the stats of peers we're no longer connected to
+    auto authenticated = getAuthenticatedPeers();
+    for (auto it = mPeerDemandStats.begin(); it != mPeerDemandStats.end();)
+    {
+        if (authenticated.find(it->first) == authenticated.end())
+        {
+            for (auto const& d : it->second.demands)
+            {
+                auto historyIt = mDemandHistoryMap.find(d.second);
+                if (historyIt != mDemandHistoryMap.end())
+                {
+                    historyIt->second.inFlight.erase(it->first);
+                }
+            }
+            it = mPeerDemandStats.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
 
     UnorderedMap<Peer::pointer, std::pair<TxDemandVector, std::list<Hash>>>
         demandMap;
-    bool anyNewDemand = false;
-    do
+
+    // First collect, for every tx hash that can be demanded now, all the
+    // peers that advertised it (in random order, as `peers` is shuffled).
+    UnorderedMap<Hash, std::vector<Peer::pointer>> advertisers;
+    std::vector<Hash> demandOrder;
+    for (auto const& peer : peers)
     {
-        anyNewDemand = false;
-        for (auto const& peer : peers)
+        auto& retry = demandMap[peer].second;
+        size_t toDemand = 0;
+        while (toDemand < maxDemandSize &&
+               peer->getTxAdvertQueue().size() > 0)
         {
-            auto& demPair = demandMap[peer];
-            auto& demand = demPair.first;
-            auto& retry = demPair.second;
-            bool addedNewDemand = false;
-            while (demand.size() < getMaxDemandSize() &&
-                   peer->getTxAdvertQueue().size() > 0 && !addedNewDemand)
+            auto hashPair = peer->getTxAdvertQueue().pop();
+            auto txHash = hashPair.first;
+            if (hashPair.second)
+            {
+                auto delta = now - *(hashPair.second);
+                mOverlayMetrics.mAdvertQueueDelay.Update(delta);
+                peer->getPeerMetrics().mAdvertQueueDelay.Update(delta);
+            }
+
+            switch (demandStatus(txHash, peer))
+            {
+            case DemandStatus::DEMAND:
             {
-                auto hashPair = peer->getTxAdvertQueue().pop();
-                auto txHash = hashPair.first;
-                if (hashPair.second)
+                auto res = advertisers.try_emplace(txHash);
+                if (res.second)
                 {
-                    auto delta = now - *(hashPair.second);
-                    mOverlayMetrics.mAdvertQueueDelay.Update(delta);
-                    peer->getPeerMetrics().mAdvertQueueDelay.Update(delta);
+                    demandOrder.push_back(txHash);
                 }
-
-                switch (demandStatus(txHash, peer))
+                auto& candidates = res.first->second;
+                if (std::find(candidates.begin(), candidates.end(), peer) ==
+                    candidates.end())
                 {
-                case DemandStatus::DEMAND:
-                    demand.push_back(txHash);
-                    if (mDemandHistoryMap.find(txHash) ==
-                        mDemandHistoryMap.end())
-                    {
-                        // We don't have any pending demand record of this tx
-                        // hash.
-                        mPendingDemands.push(txHash);
-                        mDemandHistoryMap[txHash].firstDemanded = now;
-                        CLOG_DEBUG(Overlay, "Demand tx {}, asking peer {}",
-                                   hexAbbrev(txHash), peer->toString());
-                    }
-                    else
-                    {
-                        getOverlayMetrics().mDemandTimeouts.Mark();
-                        ++(peer->getPeerMetrics().mDemandTimeouts);
-                        CLOG_DEBUG(Overlay, "Timeout for tx {}, asking peer {}",
-                                   hexAbbrev(txHash), peer->toString());
-                    }
-                    mDemandHistoryMap[txHash].peers.emplace(peer->getPeerID(),
-                                                            now);
-                    mDemandHistoryMap[txHash].lastDemanded = now;
-                    addedNewDemand = true;
-                    break;
-                case DemandStatus::RETRY_LATER:
-                    retry.push_back(txHash);
-                    break;
-                case DemandStatus::DISCARD:
-                    break;
+                    candidates.push_back(peer);
+                    ++toDemand;
                 }
+                break;
+            }
+            case DemandStatus::RETRY_LATER:
+                retry.push_back(txHash);
+                break;
+            case DemandStatus::DISCARD:
+                break;
             }
-            anyNewDemand |= addedNewDemand;
         }
-    } while (anyNewDemand);
+    }
+
+    // Then demand each tx hash from the advertiser expected to deliver it
+    // the soonest: its latency estimate scaled by the number of demands it
+    // already has to serve. Hashes with fewer advertisers are placed first
+    // as they have fewer options.
+    std::stable_sort(demandOrder.begin(), demandOrder.end(),
+                     [&](Hash const& a, Hash const& b) {
+                         return advertisers[a].size() < advertisers[b].size();
+                     });
+
+    // Peers we know nothing about yet are assumed to be as fast as the
+    // fastest peer we know of, so that they get a chance to prove it.
+    double defaultLatencyMs =
+        std::chrono::duration<double, std::milli>(cfg.FLOOD_DEMAND_PERIOD_MS)
+            .count();
+    bool haveLatency = false;
+    for (auto const& stats : mPeerDemandStats)
+    {
+        if (stats.second.latencyMs &&
+            (!haveLatency || *stats.second.latencyMs < defaultLatencyMs))
+        {
+            defaultLatencyMs = *stats.second.latencyMs;
+            haveLatency = true;
+        }
+    }
+
+    for (auto const& txHash : demandOrder)
+    {
+        auto const& candidates = advertisers[txHash];
+        Peer::pointer best;
+        double bestCost = 0;
+        for (auto const& peer : candidates)
+        {
+            auto const& demand = demandMap[peer].first;
+            auto const& stats = mPeerDemandStats[peer->getPeerID()];
+            if (demand.size() >= maxDemandSize ||
+                stats.inFlight + demand.size() >= maxInFlight)
+            {
+                continue;
+            }
+            double cost = stats.latencyMs.value_or(defaultLatencyMs) *
+                          static_cast<double>(1 + stats.inFlight +
+                                              demand.size());
+            if (!best || cost < bestCost)
+            {
+                best = peer;
+                bestCost = cost;
+            }
+        }
+
+        // The other advertisers are asked once the demand times out
+        for (auto const& peer : candidates)
+        {
+            if (peer != best)
+            {
+                demandMap[peer].second.push_back(txHash);
+            }
+        }
+        if (!best)
+        {
+            continue;
+        }
+
+        demandMap[best].first.push_back(txHash);
+        auto& history = mDemandHistoryMap[txHash];
+        if (history.peers.empty())
+        {
+            // We don't have any pending demand record of this tx hash.
+            mPendingDemands.push(txHash);
+            history.firstDemanded = now;
+            CLOG_DEBUG(Overlay, "Demand tx {}, asking peer {}",
+                       hexAbbrev(txHash), best->toString());
+        }
+        else
+        {
+            getOverlayMetrics().mDemandTimeouts.Mark();
+            ++(best->getPeerMetrics().mDemandTimeouts);
+            CLOG_DEBUG(Overlay, "Timeout for tx {}, asking peer {}",
+                       hexAbbrev(txHash), best->toString());
+        }
+        history.peers.emplace(best->getPeerID(), now);
+        history.lastDemanded = now;
+        history.inFlight.emplace(best->getPeerID());
+        auto& stats = mPeerDemandStats[best->getPeerID()];
+        ++stats.inFlight;
+        stats.demands.emplace_back(now, txHash);
+    }
 
     for (auto const& peer : peers)
     {
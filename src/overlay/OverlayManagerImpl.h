@@ -10,18 +10,23 @@
 #include "PeerManager.h"
 #include "herder/TxSetFrame.h"
 #include "overlay/Floodgate.h"
+#include "overlay/FloodedTxRecorder.h"
 #include "overlay/ItemFetcher.h"
 #include "overlay/OverlayManager.h"
 #include "overlay/OverlayMetrics.h"
+#include "overlay/OverlayThreadPool.h"
 #include "overlay/StellarXDR.h"
 #include "overlay/SurveyManager.h"
 #include "util/Logging.h"
 #include "util/Timer.h"
+#include "util/UnorderedSet.h"
 
 #include "medida/metrics_registry.h"
 #include "util/RandomEvictionCache.h"
 
+#include <deque>
 #include <future>
+#include <optional>
 #include <set>
 #include <vector>
 
@@ -97,6 +102,28 @@ class OverlayManagerImpl : public OverlayManager
 
     std::shared_ptr<SurveyManager> mSurveyManager;
 
+    // Serializations of the messages sent to peers via
+    // `getSerializedMessage`, keyed by the message address. An entry is only
+    // valid while the message it was created for is still alive; expired
+    // entries are swept on every tick, and as soon as the map or the bytes it
+    // holds double in size.
+    struct SerializedMessage
+    {
+        std::weak_ptr<StellarMessage const> mMessage;
+        std::shared_ptr<xdr::opaque_vec<> const> mBytes;
+    };
+    UnorderedMap<StellarMessage const*, SerializedMessage> mSerializedMessages;
+    size_t mSerializedMessagesBytes{0};
+    size_t mSerializedMessagesSweepSize;
+    size_t mSerializedMessagesSweepBytes;
+    void sweepSerializedMessages();
+
+    // Set only when OVERLAY_DECODE_THREADS is non-zero.
+    std::unique_ptr<OverlayThreadPool> mOverlayThreadPool;
+
+    // Set only when FLOODED_TX_RECORD_PATH is configured.
+    std::unique_ptr<FloodedTxRecorder> mFloodedTxRecorder;
+
     // This gets called once when starting
     // and it continues to call itself every FLOOD_DEMAND_PERIOD_MS.
     void demand();
@@ -106,10 +133,31 @@ class OverlayManagerImpl : public OverlayManager
         VirtualClock::time_point firstDemanded;
         VirtualClock::time_point lastDemanded;
         UnorderedMap<NodeID, VirtualClock::time_point> peers;
+        // Peers whose demand for this tx is still outstanding (neither
+        // answered nor timed out).
+        UnorderedSet<NodeID> inFlight;
         bool latencyRecorded{false};
     };
     UnorderedMap<Hash, DemandHistory> mDemandHistoryMap;
 
+    // Per-peer view of the demands, used by `demand` to send each tx hash to
+    // the advertiser that is likely to answer first.
+    struct PeerDemandStats
+    {
+        // Demands sent to the peer, oldest first. Entries that are no longer
+        // in flight are skipped when they reach the front.
+        std::deque<std::pair<VirtualClock::time_point, Hash>> demands;
+        size_t inFlight{0};
+        // Exponentially weighted moving average of the pull latency, in
+        // milliseconds; timeouts count as samples too.
+        std::optional<double> latencyMs;
+    };
+    UnorderedMap<NodeID, PeerDemandStats> mPeerDemandStats;
+    void updateDemandLatency(PeerDemandStats& stats,
+                             VirtualClock::duration latency);
+    void clearInFlightDemands(Hash const& txHash, DemandHistory& history);
+    void expireInFlightDemands();
+
     std::queue<Hash> mPendingDemands;
     enum class DemandStatus
     {
@@ -188,6 +236,21 @@ class OverlayManagerImpl : public OverlayManager
                              std::shared_ptr<Peer> peer) override;
     size_t getMaxAdvertSize() const override;
 
+    std::shared_ptr<xdr::opaque_vec<> const> getSerializedMessage(
+        std::shared_ptr<StellarMessage const> const& msg) override;
+
+    OverlayThreadPool* getOverlayThreadPool() override;
+
+    void recordFloodedTransaction(TransactionEnvelope const& tx) override;
+
+#ifdef BUILD_TESTS
+    size_t
+    getSerializedMessagesBytesForTesting() const
+    {
+        return mSerializedMessagesBytes;
+    }
+#endif
+
   private:
     struct ResolvedPeers
     {
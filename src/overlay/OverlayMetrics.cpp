@@ -26,6 +26,10 @@ OverlayMetrics::OverlayMetrics(Application& app)
           app.getMetrics().NewMeter({"overlay", "error", "read"}, "error"))
     , mErrorWrite(
           app.getMetrics().NewMeter({"overlay", "error", "write"}, "error"))
+    , mRecvBufferReused(app.getMetrics().NewMeter(
+          {"overlay", "recv-buffer", "reused"}, "buffer"))
+    , mRecvBufferAllocated(app.getMetrics().NewMeter(
+          {"overlay", "recv-buffer", "allocated"}, "buffer"))
     , mTimeoutIdle(
           app.getMetrics().NewMeter({"overlay", "timeout", "idle"}, "timeout"))
     , mTimeoutStraggler(app.getMetrics().NewMeter(
@@ -172,6 +176,12 @@ OverlayMetrics::OverlayMetrics(Application& app)
           {"overlay", "fetch", "unique-recv"}, "byte"))
     , mDuplicateFetchBytesRecv(app.getMetrics().NewMeter(
           {"overlay", "fetch", "duplicate-recv"}, "byte"))
+    , mCompactTxSetReconstructedMeter(app.getMetrics().NewMeter(
+          {"overlay", "compact-txset", "reconstructed"}, "txset"))
+    , mCompactTxSetMissingTxsMeter(app.getMetrics().NewMeter(
+          {"overlay", "compact-txset", "missing-txs"}, "transaction"))
+    , mCompactTxSetFallbackMeter(app.getMetrics().NewMeter(
+          {"overlay", "compact-txset", "fallback"}, "txset"))
 {
 }
 }
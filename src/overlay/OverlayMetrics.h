@@ -31,6 +31,8 @@ struct OverlayMetrics
     medida::Meter& mByteWrite;
     medida::Meter& mErrorRead;
     medida::Meter& mErrorWrite;
+    medida::Meter& mRecvBufferReused;
+    medida::Meter& mRecvBufferAllocated;
     medida::Meter& mTimeoutIdle;
     medida::Meter& mTimeoutStraggler;
     medida::Timer& mConnectionLatencyTimer;
@@ -117,5 +119,9 @@ struct OverlayMetrics
     medida::Meter& mDuplicateFloodBytesRecv;
     medida::Meter& mUniqueFetchBytesRecv;
     medida::Meter& mDuplicateFetchBytesRecv;
+
+    medida::Meter& mCompactTxSetReconstructedMeter;
+    medida::Meter& mCompactTxSetMissingTxsMeter;
+    medida::Meter& mCompactTxSetFallbackMeter;
 };
 }
@@ -0,0 +1,64 @@
+// Copyright 2023 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "overlay/OverlayThreadPool.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+#include <Tracy.hpp>
+
+namespace stellar
+{
+
+OverlayThreadPool::OverlayThreadPool(size_t numThreads)
+{
+    releaseAssert(numThreads > 0);
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+        auto worker = std::make_unique<Worker>();
+        worker->mWork =
+            std::make_unique<asio::io_context::work>(worker->mContext);
+        auto& context = worker->mContext;
+        worker->mThread = std::thread{[&context]() { context.run(); }};
+        mWorkers.emplace_back(std::move(worker));
+    }
+}
+
+OverlayThreadPool::~OverlayThreadPool()
+{
+    shutdown();
+}
+
+size_t
+OverlayThreadPool::assignShard()
+{
+    return mNextShard++;
+}
+
+void
+OverlayThreadPool::post(size_t shard, std::function<void()>&& f)
+{
+    auto& worker = *mWorkers[shard % mWorkers.size()];
+    if (!worker.mWork)
+    {
+        return;
+    }
+    asio::post(worker.mContext, std::move(f));
+}
+
+void
+OverlayThreadPool::shutdown()
+{
+    for (auto& worker : mWorkers)
+    {
+        worker->mWork.reset();
+    }
+    for (auto& worker : mWorkers)
+    {
+        if (worker->mThread.joinable())
+        {
+            worker->mThread.join();
+        }
+    }
+}
+}
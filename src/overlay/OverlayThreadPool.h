@@ -0,0 +1,50 @@
+#pragma once
+
+// Copyright 2023 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/asio.h"
+#include "util/NonCopyable.h"
+
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace stellar
+{
+
+// Set of threads that overlay uses to take per-peer work (decoding and
+// authenticating received messages) off the main thread. The herder also uses
+// one to verify the signatures of SCP envelopes.
+//
+// Every job is posted for a `shard` (typically identifying a peer) and all the
+// jobs of a shard run on the same thread, in the order they were posted. Jobs
+// must not touch any state owned by the main thread, and should hand their
+// results back via `Application::postOnMainThread`.
+class OverlayThreadPool : public NonMovableOrCopyable
+{
+    struct Worker
+    {
+        asio::io_context mContext{1};
+        std::unique_ptr<asio::io_context::work> mWork;
+        std::thread mThread;
+    };
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    size_t mNextShard{0};
+
+  public:
+    explicit OverlayThreadPool(size_t numThreads);
+    ~OverlayThreadPool();
+
+    // Returns a new shard, spreading the shards evenly across the threads.
+    size_t assignShard();
+
+    void post(size_t shard, std::function<void()>&& f);
+
+    // Lets the threads finish the jobs already posted and joins them. Jobs
+    // posted after this call are ignored.
+    void shutdown();
+};
+}
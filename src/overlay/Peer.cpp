@@ -89,7 +89,8 @@ Peer::rememberHash(Hash const& hash, uint32_t ledgerSeq)
 }
 
 Peer::MsgCapacityTracker::MsgCapacityTracker(std::weak_ptr<Peer> peer,
-                                             StellarMessage const& msg)
+                                             StellarMessage const& msg,
+                                             bool capacityLocked)
     : mWeakPeer(peer), mMsg(msg)
 {
     auto self = mWeakPeer.lock();
@@ -97,7 +98,10 @@ Peer::MsgCapacityTracker::MsgCapacityTracker(std::weak_ptr<Peer> peer,
     {
         throw std::runtime_error("Invalid peer");
     }
-    self->beginMessageProcessing(mMsg);
+    if (!capacityLocked)
+    {
+        self->beginMessageProcessing(mMsg);
+    }
 }
 
 Peer::MsgCapacityTracker::~MsgCapacityTracker()
@@ -157,6 +161,20 @@ Peer::beginMessageProcessing(StellarMessage const& msg)
     }
 }
 
+bool
+Peer::beginMessageProcessing(MessageType type, size_t msgSize)
+{
+    releaseAssert(mFlowControl);
+    auto success = mFlowControl->beginMessageProcessing(type, msgSize);
+    if (!success)
+    {
+        drop("unexpected flood message, peer at capacity",
+             Peer::DropDirection::WE_DROPPED_REMOTE,
+             Peer::DropMode::IGNORE_WRITE_QUEUE);
+    }
+    return success;
+}
+
 void
 Peer::endMessageProcessing(StellarMessage const& msg)
 {
@@ -422,11 +440,23 @@ Peer::sendSCPQuorumSet(SCPQuorumSetPtr qSet)
 }
 
 void
-Peer::sendGetTxSet(uint256 const& setID)
+Peer::sendGetTxSet(uint256 const& setID, bool allowCompact)
 {
     ZoneScoped;
     StellarMessage newMsg;
     newMsg.type(GET_TX_SET);
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    // The compact tx set messages are only defined in the current protocol
+    // XDR for now.
+    if (allowCompact && mApp.getConfig().COMPACT_TX_SET_RELAY &&
+        mRemoteOverlayVersion >=
+            Peer::FIRST_VERSION_SUPPORTING_COMPACT_TX_SET &&
+        mRequestedCompactTxSets.size() < MAX_REQUESTED_COMPACT_TX_SETS)
+    {
+        newMsg.type(GET_COMPACT_TX_SET);
+        ++mRequestedCompactTxSets[setID];
+    }
+#endif
     newMsg.txSetHash() = setID;
 
     auto msgPtr = std::make_shared<StellarMessage const>(newMsg);
@@ -537,6 +567,23 @@ Peer::msgSummary(StellarMessage const& msg)
     case TX_SET:
     case GENERALIZED_TX_SET:
         return "TXSET";
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    case GET_COMPACT_TX_SET:
+        return fmt::format(FMT_STRING("GETCOMPACTTXSET {}"),
+                           hexAbbrev(msg.txSetHash()));
+    case COMPACT_TX_SET:
+        return fmt::format(FMT_STRING("COMPACTTXSET {}"),
+                           hexAbbrev(msg.compactTxSet().txSetHash));
+    case GET_TX_SET_TRANSACTIONS:
+        return fmt::format(
+            FMT_STRING("GETTXSETTXS {}:{:d}"),
+            hexAbbrev(msg.getTxSetTransactions().txSetHash),
+            msg.getTxSetTransactions().indices.size());
+    case TX_SET_TRANSACTIONS:
+        return fmt::format(FMT_STRING("TXSETTXS {}:{:d}"),
+                           hexAbbrev(msg.txSetTransactions().txSetHash),
+                           msg.txSetTransactions().txs.size());
+#endif
 
     case TRANSACTION:
         return "TRANSACTION";
@@ -633,10 +680,18 @@ Peer::sendMessage(std::shared_ptr<StellarMessage const> msg, bool log)
         getOverlayMetrics().mSendPeersMeter.Mark();
         break;
     case GET_TX_SET:
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    case GET_COMPACT_TX_SET:
+    case GET_TX_SET_TRANSACTIONS:
+#endif
         getOverlayMetrics().mSendGetTxSetMeter.Mark();
         break;
     case TX_SET:
     case GENERALIZED_TX_SET:
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    case COMPACT_TX_SET:
+    case TX_SET_TRANSACTIONS:
+#endif
         getOverlayMetrics().mSendTxSetMeter.Mark();
         break;
     case TRANSACTION:
@@ -676,28 +731,82 @@ Peer::sendMessage(std::shared_ptr<StellarMessage const> msg, bool log)
     if (!mFlowControl->maybeSendMessage(msg))
     {
         // Outgoing message is not flow-controlled, send it directly
-        sendAuthenticatedMessage(*msg);
+        sendAuthenticatedMessage(msg);
     }
 }
 
 void
 Peer::sendAuthenticatedMessage(StellarMessage const& msg)
 {
-    AuthenticatedMessage amsg;
-    amsg.v0().message = msg;
-    if (msg.type() != HELLO && msg.type() != ERROR_MSG)
+    sendAuthenticatedMessage(msg, nullptr);
+}
+
+void
+Peer::sendAuthenticatedMessage(std::shared_ptr<StellarMessage const> const& msg)
+{
+    switch (msg->type())
     {
-        ZoneNamedN(hmacZone, "message HMAC", true);
-        amsg.v0().sequence = mSendMacSeq;
-        amsg.v0().mac =
-            hmacSha256(mSendMacKey, xdr::xdr_to_opaque(mSendMacSeq, msg));
-        ++mSendMacSeq;
+    case SCP_MESSAGE:
+    case TX_SET:
+    case GENERALIZED_TX_SET:
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    case COMPACT_TX_SET:
+#endif
+    {
+        auto serializedMsg =
+            mApp.getOverlayManager().getSerializedMessage(msg);
+        sendAuthenticatedMessage(*msg, serializedMsg.get());
+        break;
     }
-    xdr::msg_ptr xdrBytes;
+    default:
+        sendAuthenticatedMessage(*msg, nullptr);
+    }
+}
+
+void
+Peer::sendAuthenticatedMessage(StellarMessage const& msg,
+                               xdr::opaque_vec<> const* serializedMsg)
+{
+    // Build the `AuthenticatedMessage` frame directly instead of copying `msg`
+    // into it: the v0 arm consists of the union discriminant, the sequence
+    // number, the message and the MAC, and the MAC is computed over the
+    // sequence number and message bytes that are already in the frame.
+    size_t constexpr prefixSize = sizeof(uint32_t) + sizeof(uint64_t);
+    size_t constexpr macSize = sizeof(HmacSha256Mac::mac);
+    size_t const msgSize = serializedMsg ? serializedMsg->size()
+                                         : xdr::xdr_argpack_size(msg);
+
+    xdr::msg_ptr xdrBytes =
+        xdr::message_t::alloc(prefixSize + msgSize + macSize);
+    char* const data = xdrBytes->data();
+    bool const authenticated = msg.type() != HELLO && msg.type() != ERROR_MSG;
+    uint64_t const sequence = authenticated ? mSendMacSeq : 0;
     {
         ZoneNamedN(xdrZone, "XDR serialize", true);
-        xdrBytes = xdr::xdr_to_msg(amsg);
+        xdr::xdr_put p(data, data + prefixSize);
+        xdr::xdr_argpack_archive(p, uint32_t(0), sequence);
+        if (serializedMsg)
+        {
+            std::memcpy(data + prefixSize, serializedMsg->data(), msgSize);
+        }
+        else
+        {
+            xdr::xdr_put pm(data + prefixSize, data + prefixSize + msgSize);
+            xdr::xdr_argpack_archive(pm, msg);
+        }
+    }
+
+    HmacSha256Mac mac;
+    if (authenticated)
+    {
+        ZoneNamedN(hmacZone, "message HMAC", true);
+        mac = hmacSha256(mSendMacKey,
+                         ByteSlice(data + sizeof(uint32_t),
+                                   sizeof(uint64_t) + msgSize));
+        ++mSendMacSeq;
     }
+    std::memcpy(data + prefixSize + msgSize, mac.mac.data(), macSize);
+
     this->sendMessage(std::move(xdrBytes));
 }
 
@@ -789,7 +898,7 @@ Peer::recvMessage(AuthenticatedMessage const& msg)
 }
 
 void
-Peer::recvMessage(StellarMessage const& stellarMsg)
+Peer::recvMessage(StellarMessage const& stellarMsg, bool capacityLocked)
 {
     ZoneScoped;
     if (shouldAbort())
@@ -806,6 +915,10 @@ Peer::recvMessage(StellarMessage const& stellarMsg)
     // group messages used during handshake, process those synchronously
     case HELLO:
     case AUTH:
+        if (capacityLocked)
+        {
+            endMessageProcessing(stellarMsg);
+        }
         Peer::recvRawMessage(stellarMsg);
         return;
     // control messages
@@ -829,6 +942,10 @@ Peer::recvMessage(StellarMessage const& stellarMsg)
 
     // consensus, inbound
     case GET_TX_SET:
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    case GET_COMPACT_TX_SET:
+    case GET_TX_SET_TRANSACTIONS:
+#endif
     case GET_SCP_QUORUMSET:
     case GET_SCP_STATE:
         cat = "SCPQ";
@@ -839,6 +956,10 @@ Peer::recvMessage(StellarMessage const& stellarMsg)
     case DONT_HAVE:
     case TX_SET:
     case GENERALIZED_TX_SET:
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    case COMPACT_TX_SET:
+    case TX_SET_TRANSACTIONS:
+#endif
     case SCP_QUORUMSET:
     case SCP_MESSAGE:
         cat = "SCP";
@@ -850,7 +971,8 @@ Peer::recvMessage(StellarMessage const& stellarMsg)
 
     auto self = shared_from_this();
     std::weak_ptr<Peer> weak(static_pointer_cast<Peer>(self));
-    auto msgTracker = std::make_shared<MsgCapacityTracker>(weak, stellarMsg);
+    auto msgTracker =
+        std::make_shared<MsgCapacityTracker>(weak, stellarMsg, capacityLocked);
 
     if (!mApp.getLedgerManager().isSynced() && ignoreIfOutOfSync)
     {
@@ -871,7 +993,7 @@ Peer::recvMessage(StellarMessage const& stellarMsg)
 
             try
             {
-                self->recvRawMessage(msgTracker->getMessage());
+                self->recvRawMessage(msgTracker->getMessage(), msgTracker);
             }
             catch (CryptoError const& e)
             {
@@ -897,7 +1019,8 @@ Peer::recvSendMore(StellarMessage const& msg)
 }
 
 void
-Peer::recvRawMessage(StellarMessage const& stellarMsg)
+Peer::recvRawMessage(StellarMessage const& stellarMsg,
+                     std::shared_ptr<MsgCapacityTracker> const& msgTracker)
 {
     ZoneScoped;
     auto peerStr = toString();
@@ -982,12 +1105,24 @@ Peer::recvRawMessage(StellarMessage const& stellarMsg)
     break;
 
     case GET_TX_SET:
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    case GET_COMPACT_TX_SET:
+#endif
     {
         auto t = getOverlayMetrics().mRecvGetTxSetTimer.TimeScope();
         recvGetTxSet(stellarMsg);
     }
     break;
 
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    case GET_TX_SET_TRANSACTIONS:
+    {
+        auto t = getOverlayMetrics().mRecvGetTxSetTimer.TimeScope();
+        recvGetTxSetTransactions(stellarMsg);
+    }
+    break;
+#endif
+
     case TX_SET:
     {
         auto t = getOverlayMetrics().mRecvTxSetTimer.TimeScope();
@@ -1002,6 +1137,22 @@ Peer::recvRawMessage(StellarMessage const& stellarMsg)
     }
     break;
 
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    case COMPACT_TX_SET:
+    {
+        auto t = getOverlayMetrics().mRecvTxSetTimer.TimeScope();
+        recvCompactTxSet(stellarMsg);
+    }
+    break;
+
+    case TX_SET_TRANSACTIONS:
+    {
+        auto t = getOverlayMetrics().mRecvTxSetTimer.TimeScope();
+        recvTxSetTransactions(stellarMsg);
+    }
+    break;
+#endif
+
     case TRANSACTION:
     {
         auto t = getOverlayMetrics().mRecvTransactionTimer.TimeScope();
@@ -1026,7 +1177,7 @@ Peer::recvRawMessage(StellarMessage const& stellarMsg)
     case SCP_MESSAGE:
     {
         auto t = getOverlayMetrics().mRecvSCPMessageTimer.TimeScope();
-        recvSCPMessage(stellarMsg);
+        recvSCPMessage(stellarMsg, msgTracker);
     }
     break;
 
@@ -1072,6 +1223,11 @@ Peer::recvDontHave(StellarMessage const& msg)
 {
     ZoneScoped;
     maybeProcessPingResponse(msg.dontHave().reqHash);
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    // the peer won't be able to provide the missing transactions either
+    answerCompactTxSetRequest(msg.dontHave().reqHash);
+    mPendingCompactTxSets.erase(msg.dontHave().reqHash);
+#endif
 
     mApp.getHerder().peerDoesntHave(msg.dontHave().type, msg.dontHave().reqHash,
                                     shared_from_this());
@@ -1084,28 +1240,26 @@ Peer::recvGetTxSet(StellarMessage const& msg)
     auto self = shared_from_this();
     if (auto txSet = mApp.getHerder().getTxSet(msg.txSetHash()))
     {
-        StellarMessage newMsg;
-        if (txSet->isGeneralizedTxSet())
-        {
-            if (mRemoteOverlayVersion <
+        if (txSet->isGeneralizedTxSet() &&
+            mRemoteOverlayVersion <
                 Peer::FIRST_VERSION_SUPPORTING_GENERALIZED_TX_SET)
-            {
-                // The peer wouldn't be able to accept the generalized tx set,
-                // but it wouldn't be correct to say we don't have it. So we
-                // just let the request to timeout.
-                return;
-            }
-            newMsg.type(GENERALIZED_TX_SET);
-            txSet->toXDR(newMsg.generalizedTxSet());
+        {
+            // The peer wouldn't be able to accept the generalized tx set,
+            // but it wouldn't be correct to say we don't have it. So we
+            // just let the request to timeout.
+            return;
         }
-        else
+        // The message is shared between all the peers requesting this tx
+        // set.
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+        if (msg.type() == GET_COMPACT_TX_SET && txSet->isGeneralizedTxSet() &&
+            txSet->sizeTxTotal() <= COMPACT_TX_SET_MAX_TXS)
         {
-            newMsg.type(TX_SET);
-            txSet->toXDR(newMsg.txSet());
+            self->sendMessage(txSet->toCompactStellarMessage());
+            return;
         }
-
-        auto newMsgPtr = std::make_shared<StellarMessage const>(newMsg);
-        self->sendMessage(newMsgPtr);
+#endif
+        self->sendMessage(txSet->toStellarMessage());
     }
     else
     {
@@ -1140,6 +1294,11 @@ Peer::recvTxSet(StellarMessage const& msg)
 {
     ZoneScoped;
     auto frame = TxSetFrame::makeFromWire(mApp, msg.txSet());
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    // the peer may answer a compact tx set request with the full tx set
+    answerCompactTxSetRequest(frame->getContentsHash());
+    mPendingCompactTxSets.erase(frame->getContentsHash());
+#endif
     mApp.getHerder().recvTxSet(frame->getContentsHash(), frame);
 }
 
@@ -1148,9 +1307,193 @@ Peer::recvGeneralizedTxSet(StellarMessage const& msg)
 {
     ZoneScoped;
     auto frame = TxSetFrame::makeFromWire(mApp, msg.generalizedTxSet());
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    // the peer may answer a compact tx set request with the full tx set
+    answerCompactTxSetRequest(frame->getContentsHash());
+    mPendingCompactTxSets.erase(frame->getContentsHash());
+#endif
     mApp.getHerder().recvTxSet(frame->getContentsHash(), frame);
 }
 
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+bool
+Peer::answerCompactTxSetRequest(Hash const& txSetHash)
+{
+    auto it = mRequestedCompactTxSets.find(txSetHash);
+    if (it == mRequestedCompactTxSets.end())
+    {
+        return false;
+    }
+    if (--it->second == 0)
+    {
+        mRequestedCompactTxSets.erase(it);
+    }
+    return true;
+}
+
+void
+Peer::recvCompactTxSet(StellarMessage const& msg)
+{
+    ZoneScoped;
+    auto const& compact = msg.compactTxSet();
+    auto& herder = mApp.getHerder();
+    // Only reconstruct the tx sets we asked this peer for, as this walks the
+    // transaction queues
+    if (!answerCompactTxSetRequest(compact.txSetHash))
+    {
+        sendErrorAndDrop(ERR_DATA, "unrequested compact tx set",
+                         Peer::DropMode::IGNORE_WRITE_QUEUE);
+        return;
+    }
+    if (herder.getTxSet(compact.txSetHash) ||
+        mPendingCompactTxSets.count(compact.txSetHash) != 0)
+    {
+        return;
+    }
+    size_t txCount = 0;
+    for (auto const& phase : compact.phases)
+    {
+        for (auto const& component : phase.components)
+        {
+            txCount += component.shortTxIDs.size();
+        }
+    }
+    if (txCount > COMPACT_TX_SET_MAX_TXS)
+    {
+        sendErrorAndDrop(ERR_DATA, "compact tx set too large",
+                         Peer::DropMode::IGNORE_WRITE_QUEUE);
+        return;
+    }
+
+    auto reconstructor =
+        std::make_unique<CompactTxSetReconstructor>(compact, herder);
+    if (reconstructor->isComplete())
+    {
+        finishCompactTxSet(*reconstructor);
+        return;
+    }
+
+    getOverlayMetrics().mCompactTxSetMissingTxsMeter.Mark(
+        reconstructor->getMissingIndices().size());
+    if (mPendingCompactTxSets.size() >= MAX_PENDING_COMPACT_TX_SETS)
+    {
+        // too many reconstructions in flight, just get the full tx set
+        getOverlayMetrics().mCompactTxSetFallbackMeter.Mark();
+        sendGetTxSet(compact.txSetHash, /* allowCompact */ false);
+        return;
+    }
+
+    StellarMessage newMsg;
+    newMsg.type(GET_TX_SET_TRANSACTIONS);
+    auto& req = newMsg.getTxSetTransactions();
+    req.txSetHash = compact.txSetHash;
+    req.indices.assign(reconstructor->getMissingIndices().begin(),
+                       reconstructor->getMissingIndices().end());
+    mPendingCompactTxSets.emplace(compact.txSetHash, std::move(reconstructor));
+    sendMessage(std::make_shared<StellarMessage const>(std::move(newMsg)));
+}
+
+void
+Peer::recvGetTxSetTransactions(StellarMessage const& msg)
+{
+    ZoneScoped;
+    auto const& req = msg.getTxSetTransactions();
+    auto txSet = mApp.getHerder().getTxSet(req.txSetHash);
+    if (!txSet || !txSet->isGeneralizedTxSet())
+    {
+        sendDontHave(GENERALIZED_TX_SET, req.txSetHash);
+        return;
+    }
+
+    // flatten the tx set in the order used for the indices
+    std::vector<TransactionEnvelope const*> txs;
+    auto const& xdrTxSet = txSet->toStellarMessage()->generalizedTxSet();
+    for (auto const& phase : xdrTxSet.v1TxSet().phases)
+    {
+        for (auto const& component : phase.v0Components())
+        {
+            for (auto const& tx : component.txsMaybeDiscountedFee().txs)
+            {
+                txs.emplace_back(&tx);
+            }
+        }
+    }
+
+    // Distinct transactions in increasing order: the response can't be
+    // larger than the tx set
+    size_t size = 0;
+    for (size_t i = 0; i < req.indices.size(); ++i)
+    {
+        auto index = req.indices[i];
+        if (index >= txs.size() || (i > 0 && index <= req.indices[i - 1]))
+        {
+            sendErrorAndDrop(ERR_DATA, "invalid tx set transaction indices",
+                             Peer::DropMode::IGNORE_WRITE_QUEUE);
+            return;
+        }
+        size += xdr::xdr_argpack_size(*txs[index]);
+    }
+    if (size > MAX_TX_SET_TRANSACTIONS_SIZE)
+    {
+        // most of a large tx set is missing, send all of it at once
+        sendMessage(txSet->toStellarMessage());
+        return;
+    }
+
+    StellarMessage newMsg;
+    newMsg.type(TX_SET_TRANSACTIONS);
+    auto& res = newMsg.txSetTransactions();
+    res.txSetHash = req.txSetHash;
+    res.txs.reserve(req.indices.size());
+    for (auto index : req.indices)
+    {
+        res.txs.emplace_back(*txs[index]);
+    }
+    sendMessage(std::make_shared<StellarMessage const>(std::move(newMsg)));
+}
+
+void
+Peer::recvTxSetTransactions(StellarMessage const& msg)
+{
+    ZoneScoped;
+    auto const& txs = msg.txSetTransactions();
+    auto it = mPendingCompactTxSets.find(txs.txSetHash);
+    if (it == mPendingCompactTxSets.end())
+    {
+        return;
+    }
+    auto reconstructor = std::move(it->second);
+    mPendingCompactTxSets.erase(it);
+
+    if (!reconstructor->addMissingTransactions(txs.txs))
+    {
+        getOverlayMetrics().mCompactTxSetFallbackMeter.Mark();
+        sendGetTxSet(txs.txSetHash, /* allowCompact */ false);
+        return;
+    }
+    finishCompactTxSet(*reconstructor);
+}
+
+void
+Peer::finishCompactTxSet(CompactTxSetReconstructor& reconstructor)
+{
+    ZoneScoped;
+    auto hash = reconstructor.getTxSetHash();
+    auto frame = TxSetFrame::makeFromWire(mApp, reconstructor.finish());
+    if (frame->getContentsHash() != hash)
+    {
+        // a short id matched the wrong transaction, get the full tx set
+        CLOG_DEBUG(Overlay, "Compact tx set {} mismatch from {}",
+                   hexAbbrev(hash), toString());
+        getOverlayMetrics().mCompactTxSetFallbackMeter.Mark();
+        sendGetTxSet(hash, /* allowCompact */ false);
+        return;
+    }
+    getOverlayMetrics().mCompactTxSetReconstructedMeter.Mark();
+    mApp.getHerder().recvTxSet(hash, frame);
+}
+#endif
+
 void
 Peer::recvTransaction(StellarMessage const& msg)
 {
@@ -1187,6 +1530,9 @@ Peer::recvTransaction(StellarMessage const& msg)
             if (!dup)
             {
                 pulledRelevantTx = true;
+                // record each transaction once, when it first gets accepted
+                mApp.getOverlayManager().recordFloodedTransaction(
+                    msg.transaction());
             }
             CLOG_DEBUG(
                 Overlay,
@@ -1283,7 +1629,8 @@ Peer::recvSCPQuorumSet(StellarMessage const& msg)
 }
 
 void
-Peer::recvSCPMessage(StellarMessage const& msg)
+Peer::recvSCPMessage(StellarMessage const& msg,
+                     std::shared_ptr<MsgCapacityTracker> const& msgTracker)
 {
     ZoneScoped;
     SCPEnvelope const& envelope = msg.envelope();
@@ -1321,12 +1668,19 @@ Peer::recvSCPMessage(StellarMessage const& msg)
     Hash msgID;
     mApp.getOverlayManager().recvFloodedMsgID(msg, shared_from_this(), msgID);
 
-    auto res = mApp.getHerder().recvSCPEnvelope(envelope);
-    if (res == Herder::ENVELOPE_STATUS_DISCARDED)
-    {
-        // the message was discarded, remove it from the floodmap as well
-        mApp.getOverlayManager().forgetFloodedMsg(msgID);
-    }
+    // The capacity of the message is only released once the envelope is
+    // processed, so that the peer can't get more envelopes queued for
+    // verification than its capacity allows
+    mApp.getHerder().recvSCPEnvelopeAsync(
+        envelope, [&om = mApp.getOverlayManager(), msgID,
+                   msgTracker](Herder::EnvelopeStatus res) {
+            if (res == Herder::ENVELOPE_STATUS_DISCARDED)
+            {
+                // the message was discarded, remove it from the floodmap as
+                // well
+                om.forgetFloodedMsg(msgID);
+            }
+        });
 }
 
 void
@@ -1597,13 +1951,14 @@ Peer::recvAuth(StellarMessage const& msg)
     // Subtle: after successful auth, must send sendMore message first to tell
     // the other peer about the local node's reading capacity.
     auto weakSelf = std::weak_ptr<Peer>(self);
-    auto sendCb = [weakSelf](StellarMessage const& msg) {
-        auto self = weakSelf.lock();
-        if (self)
-        {
-            self->sendAuthenticatedMessage(msg);
-        }
-    };
+    auto sendCb =
+        [weakSelf](std::shared_ptr<StellarMessage const> const& msg) {
+            auto self = weakSelf.lock();
+            if (self)
+            {
+                self->sendAuthenticatedMessage(msg);
+            }
+        };
 
     bool enableBytes =
         (mApp.getConfig().OVERLAY_PROTOCOL_VERSION >=
@@ -6,6 +6,7 @@
 
 #include "util/asio.h"
 #include "database/Database.h"
+#include "herder/CompactTxSet.h"
 #include "lib/json/json.h"
 #include "medida/timer.h"
 #include "overlay/PeerBareAddress.h"
@@ -15,6 +16,7 @@
 #include "util/NonCopyable.h"
 #include "util/RandomEvictionCache.h"
 #include "util/Timer.h"
+#include "util/UnorderedMap.h"
 #include "xdrpp/message.h"
 
 namespace stellar
@@ -66,6 +68,7 @@ class Peer : public std::enable_shared_from_this<Peer>,
         std::chrono::seconds(1);
     static constexpr uint32_t FIRST_VERSION_SUPPORTING_FLOW_CONTROL_IN_BYTES =
         28;
+    static constexpr uint32_t FIRST_VERSION_SUPPORTING_COMPACT_TX_SET = 29;
 
     // The reporting will be based on the previous
     // PEER_METRICS_WINDOW_SIZE-second time window.
@@ -172,7 +175,10 @@ class Peer : public std::enable_shared_from_this<Peer>,
         StellarMessage mMsg;
 
       public:
-        MsgCapacityTracker(std::weak_ptr<Peer> peer, StellarMessage const& msg);
+        // `capacityLocked` is set when the capacity of the message was locked
+        // before it was decoded
+        MsgCapacityTracker(std::weak_ptr<Peer> peer, StellarMessage const& msg,
+                           bool capacityLocked = false);
         ~MsgCapacityTracker();
         StellarMessage const& getMessage();
         std::weak_ptr<Peer> getPeer();
@@ -211,11 +217,34 @@ class Peer : public std::enable_shared_from_this<Peer>,
 
     PeerMetrics mPeerMetrics;
 
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    // Number of outstanding compact tx set requests to this peer, by tx set.
+    // Any other compact tx set received from it is a protocol error. When
+    // too many tx sets are requested, full tx sets are requested instead.
+    static constexpr size_t MAX_REQUESTED_COMPACT_TX_SETS = 16;
+    UnorderedMap<Hash, uint32_t> mRequestedCompactTxSets;
+
+    // Compact tx sets received from this peer that are waiting for their
+    // missing transactions.
+    static constexpr size_t MAX_PENDING_COMPACT_TX_SETS = 8;
+    UnorderedMap<Hash, std::unique_ptr<CompactTxSetReconstructor>>
+        mPendingCompactTxSets;
+
+    // Maximum size of the transactions returned for a
+    // GET_TX_SET_TRANSACTIONS request, above which the full tx set is sent
+    // instead.
+    static constexpr size_t MAX_TX_SET_TRANSACTIONS_SIZE = MAX_MESSAGE_SIZE / 2;
+#endif
+
     OverlayMetrics& getOverlayMetrics();
 
     bool shouldAbort() const;
-    void recvRawMessage(StellarMessage const& msg);
-    void recvMessage(StellarMessage const& msg);
+    // `msgTracker` holds the flow control capacity of the message, for
+    // messages that are processed asynchronously
+    void recvRawMessage(
+        StellarMessage const& msg,
+        std::shared_ptr<MsgCapacityTracker> const& msgTracker = nullptr);
+    void recvMessage(StellarMessage const& msg, bool capacityLocked = false);
     void recvMessage(AuthenticatedMessage const& msg);
     void recvMessage(xdr::msg_ptr const& xdrBytes);
 
@@ -234,10 +263,22 @@ class Peer : public std::enable_shared_from_this<Peer>,
     void recvGetTxSet(StellarMessage const& msg);
     void recvTxSet(StellarMessage const& msg);
     void recvGeneralizedTxSet(StellarMessage const& msg);
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    // Accounts for an answer to a compact tx set request, returns false if
+    // there was no such request outstanding.
+    bool answerCompactTxSetRequest(Hash const& txSetHash);
+    void recvCompactTxSet(StellarMessage const& msg);
+    void recvGetTxSetTransactions(StellarMessage const& msg);
+    void recvTxSetTransactions(StellarMessage const& msg);
+    // Passes the reconstructed compact tx set to the herder, or falls back to
+    // fetching the full tx set when it doesn't match the announced hash.
+    void finishCompactTxSet(CompactTxSetReconstructor& reconstructor);
+#endif
     void recvTransaction(StellarMessage const& msg);
     void recvGetSCPQuorumSet(StellarMessage const& msg);
     void recvSCPQuorumSet(StellarMessage const& msg);
-    void recvSCPMessage(StellarMessage const& msg);
+    void recvSCPMessage(StellarMessage const& msg,
+                        std::shared_ptr<MsgCapacityTracker> const& msgTracker);
     void recvGetSCPState(StellarMessage const& msg);
     void recvFloodAdvert(StellarMessage const& msg);
     void recvFloodDemand(StellarMessage const& msg);
@@ -279,7 +320,17 @@ class Peer : public std::enable_shared_from_this<Peer>,
     void receivedBytes(size_t byteCount, bool gotFullMessage);
 
     void sendAuthenticatedMessage(StellarMessage const& msg);
+    // Same as above, but messages that are usually sent to many peers at once
+    // reuse the serialization shared via `OverlayManager`.
+    void
+    sendAuthenticatedMessage(std::shared_ptr<StellarMessage const> const& msg);
+    void sendAuthenticatedMessage(StellarMessage const& msg,
+                                  xdr::opaque_vec<> const* serializedMsg);
     void beginMessageProcessing(StellarMessage const& msg);
+    // Locks the capacity of a message that is not decoded yet, see
+    // `FlowControl`. Returns false if the peer was dropped for lack of
+    // capacity.
+    bool beginMessageProcessing(MessageType type, size_t msgSize);
     void endMessageProcessing(StellarMessage const& msg);
     TxAdvertQueue mTxAdvertQueue;
 
@@ -310,7 +361,9 @@ class Peer : public std::enable_shared_from_this<Peer>,
     void clearBelow(uint32_t ledgerSeq);
 
     std::string msgSummary(StellarMessage const& stellarMsg);
-    void sendGetTxSet(uint256 const& setID);
+    // Requests a tx set. When `allowCompact` is set and COMPACT_TX_SET_RELAY
+    // is enabled, the peer is asked for the compact form of the tx set.
+    void sendGetTxSet(uint256 const& setID, bool allowCompact = true);
     void sendGetQuorumSet(uint256 const& setID);
     void sendGetPeers();
     void sendGetScpState(uint32 ledgerSeq);
@@ -81,6 +81,7 @@ toXdr(PeerBareAddress const& address)
 
 constexpr const size_t BATCH_SIZE = 1000;
 constexpr const size_t MAX_FAILURES = 10;
+constexpr const std::chrono::seconds FLUSH_PERIOD(5);
 
 PeerManager::PeerManager(Application& app)
     : mApp(app)
@@ -88,6 +89,7 @@ PeerManager::PeerManager(Application& app)
           *this, RandomPeerSource::maxFailures(MAX_FAILURES, true)))
     , mInboundPeersToSend(std::make_unique<RandomPeerSource>(
           *this, RandomPeerSource::maxFailures(MAX_FAILURES, false)))
+    , mFlushTimer(app)
 {
 }
 
@@ -95,75 +97,44 @@ std::vector<PeerBareAddress>
 PeerManager::loadRandomPeers(PeerQuery const& query, size_t size)
 {
     ZoneScoped;
+    ensureLoaded();
     // BATCH_SIZE should always be bigger, so it should win anyway
     size = std::max(size, BATCH_SIZE);
 
-    // if we ever start removing peers from db, we may need to enable this
-    // soci::transaction sqltx(mApp.getDatabase().getSession());
-    // mApp.getDatabase().setCurrentTransactionReadOnly();
-
-    std::vector<std::string> conditions;
-    if (query.mUseNextAttempt)
-    {
-        conditions.push_back("nextattempt <= :nextattempt");
-    }
-    if (query.mMaxNumFailures.has_value())
-    {
-        conditions.push_back("numfailures <= :maxFailures");
-    }
-    if (query.mTypeFilter == PeerTypeFilter::ANY_OUTBOUND)
-    {
-        conditions.push_back("type != :inboundType");
-    }
-    else
-    {
-        conditions.push_back("type = :type");
-    }
-    releaseAssert(!conditions.empty());
-    std::string where = conditions[0];
-    for (size_t i = 1; i < conditions.size(); i++)
-    {
-        where += " AND " + conditions[i];
-    }
-
-    std::tm nextAttempt =
-        VirtualClock::systemPointToTm(mApp.getClock().system_now());
-    size_t maxNumFailures{0};
+    auto now = mApp.getClock().system_now();
     int exactType = static_cast<int>(query.mTypeFilter);
     int inboundType = static_cast<int>(PeerType::INBOUND);
 
-    auto bindToStatement = [&](soci::statement& st) {
-        if (query.mUseNextAttempt)
-        {
-            st.exchange(soci::use(nextAttempt));
-        }
-        if (query.mMaxNumFailures.has_value())
-        {
-            maxNumFailures = *query.mMaxNumFailures;
-            st.exchange(soci::use(maxNumFailures));
-        }
-        if (query.mTypeFilter == PeerTypeFilter::ANY_OUTBOUND)
+    auto result = std::vector<PeerBareAddress>{};
+    for (auto const& byType : mPeersByNextAttempt)
+    {
+        bool typeMatches = query.mTypeFilter == PeerTypeFilter::ANY_OUTBOUND
+                               ? byType.first != inboundType
+                               : byType.first == exactType;
+        if (!typeMatches)
         {
-            st.exchange(soci::use(inboundType));
+            continue;
         }
-        else
+        for (auto const& key : byType.second)
         {
-            st.exchange(soci::use(exactType));
+            if (query.mUseNextAttempt && key.first > now)
+            {
+                break;
+            }
+            if (query.mMaxNumFailures.has_value() &&
+                mPeers.at(key.second).mNumFailures > *query.mMaxNumFailures)
+            {
+                continue;
+            }
+            result.emplace_back(key.second);
         }
-    };
-
-    auto result = std::vector<PeerBareAddress>{};
-    size_t count = countPeers(where, bindToStatement);
-    if (count == 0)
-    {
-        return result;
     }
 
-    size_t maxOffset = count > size ? count - size : 0;
-    size_t offset = rand_uniform<size_t>(0, maxOffset);
-    result = loadPeers(size, offset, where, bindToStatement);
-
     stellar::shuffle(std::begin(result), std::end(result), gRandomEngine);
+    if (result.size() > size)
+    {
+        result.resize(size);
+    }
     return result;
 }
 
@@ -172,40 +143,19 @@ PeerManager::removePeersWithManyFailures(size_t minNumFailures,
                                          PeerBareAddress const* address)
 {
     ZoneScoped;
-    try
+    ensureLoaded();
+    for (auto it = mPeers.begin(); it != mPeers.end();)
     {
-        auto& db = mApp.getDatabase();
-        auto sql = std::string{
-            "DELETE FROM peers WHERE numfailures >= :minNumFailures"};
-        if (address)
+        if (it->second.mNumFailures >= minNumFailures &&
+            (!address || it->first.getIP() == address->getIP()))
         {
-            sql += " AND ip = :ip";
+            it = erasePeer(it);
         }
-
-        auto prep = db.getPreparedStatement(sql);
-        auto& st = prep.statement();
-
-        st.exchange(use(minNumFailures));
-
-        std::string ip;
-        if (address)
-        {
-            ip = address->getIP();
-            st.exchange(use(ip));
-        }
-        st.define_and_bind();
-
+        else
         {
-            auto timer = db.getDeleteTimer("peer");
-            st.execute(true);
+            ++it;
         }
     }
-    catch (soci_error& err)
-    {
-        CLOG_ERROR(Overlay,
-                   "PeerManager::removePeersWithManyFailures error: {}",
-                   err.what());
-    }
 }
 
 std::vector<PeerBareAddress>
@@ -232,43 +182,18 @@ std::pair<PeerRecord, bool>
 PeerManager::load(PeerBareAddress const& address)
 {
     ZoneScoped;
-    auto result = PeerRecord{};
-    auto inDatabase = false;
-
-    try
+    ensureLoaded();
+    auto it = mPeers.find(address);
+    if (it != mPeers.end())
     {
-        auto prep = mApp.getDatabase().getPreparedStatement(
-            "SELECT numfailures, nextattempt, type FROM peers "
-            "WHERE ip = :v1 AND port = :v2");
-        auto& st = prep.statement();
-        st.exchange(into(result.mNumFailures));
-        st.exchange(into(result.mNextAttempt));
-        st.exchange(into(result.mType));
-        std::string ip = address.getIP();
-        st.exchange(use(ip));
-        int port = address.getPort();
-        st.exchange(use(port));
-        st.define_and_bind();
-        {
-            auto timer = mApp.getDatabase().getSelectTimer("peer");
-            st.execute(true);
-            inDatabase = st.got_data();
-
-            if (!inDatabase)
-            {
-                result.mNextAttempt =
-                    VirtualClock::systemPointToTm(mApp.getClock().system_now());
-                result.mType = static_cast<int>(PeerType::INBOUND);
-            }
-        }
-    }
-    catch (soci_error& err)
-    {
-        CLOG_ERROR(Overlay, "PeerManager::load error: {} on {}", err.what(),
-                   address.toString());
+        return std::make_pair(it->second, true);
     }
 
-    return std::make_pair(result, inDatabase);
+    auto result = PeerRecord{};
+    result.mNextAttempt =
+        VirtualClock::systemPointToTm(mApp.getClock().system_now());
+    result.mType = static_cast<int>(PeerType::INBOUND);
+    return std::make_pair(result, false);
 }
 
 void
@@ -276,51 +201,15 @@ PeerManager::store(PeerBareAddress const& address, PeerRecord const& peerRecord,
                    bool inDatabase)
 {
     ZoneScoped;
-    std::string query;
-
-    if (inDatabase)
+    ensureLoaded();
+    if ((mPeers.find(address) != mPeers.end()) != inDatabase)
     {
-        query = "UPDATE peers SET "
-                "nextattempt = :v1, "
-                "numfailures = :v2, "
-                "type = :v3 "
-                "WHERE ip = :v4 AND port = :v5";
-    }
-    else
-    {
-        query = "INSERT INTO peers "
-                "(nextattempt, numfailures, type, ip,  port) "
-                "VALUES "
-                "(:v1,         :v2,        :v3,  :v4, :v5)";
-    }
-
-    try
-    {
-        auto prep = mApp.getDatabase().getPreparedStatement(query);
-        auto& st = prep.statement();
-        st.exchange(use(peerRecord.mNextAttempt));
-        st.exchange(use(peerRecord.mNumFailures));
-        st.exchange(use(peerRecord.mType));
-        std::string ip = address.getIP();
-        st.exchange(use(ip));
-        int port = address.getPort();
-        st.exchange(use(port));
-        st.define_and_bind();
-        {
-            auto timer = mApp.getDatabase().getUpdateTimer("peer");
-            st.execute(true);
-            if (st.get_affected_rows() != 1)
-            {
-                CLOG_ERROR(Overlay, "PeerManager::store failed on {}",
-                           address.toString());
-            }
-        }
-    }
-    catch (soci_error& err)
-    {
-        CLOG_ERROR(Overlay, "PeerManager::store error: {} on {}", err.what(),
+        CLOG_ERROR(Overlay, "PeerManager::store failed on {}",
                    address.toString());
+        return;
     }
+    insertPeer(address, peerRecord);
+    markDirty(address);
 }
 
 void
@@ -494,96 +383,96 @@ PeerManager::update(PeerBareAddress const& address, PeerType observedType,
     store(address, peer.first, peer.second);
 }
 
-size_t
-PeerManager::countPeers(std::string const& where,
-                        std::function<void(soci::statement&)> const& bind)
+void
+PeerManager::dropAll(Database& db)
 {
-    ZoneScoped;
-    size_t count = 0;
-
-    try
-    {
-        std::string sql = "SELECT COUNT(*) FROM peers WHERE " + where;
-
-        auto prep = mApp.getDatabase().getPreparedStatement(sql);
-        auto& st = prep.statement();
+    db.getSession() << "DROP TABLE IF EXISTS peers;";
+    db.getSession() << kSQLCreateStatement;
+}
 
-        bind(st);
-        st.exchange(into(count));
+std::vector<std::pair<PeerBareAddress, PeerRecord>>
+PeerManager::loadAllPeers()
+{
+    ZoneScoped;
+    ensureLoaded();
+    return std::vector<std::pair<PeerBareAddress, PeerRecord>>(mPeers.begin(),
+                                                               mPeers.end());
+}
 
-        st.define_and_bind();
-        st.execute(true);
-    }
-    catch (soci_error& err)
+void
+PeerManager::storePeers(
+    std::vector<std::pair<PeerBareAddress, PeerRecord>> peers)
+{
+    mPeers.clear();
+    mPeersByNextAttempt.clear();
+    mDirtyPeers.clear();
+    mPeersLoaded = true;
+    for (auto const& peer : peers)
     {
-        CLOG_ERROR(Overlay, "countPeers error: {}", err.what());
+        insertPeer(peer.first, peer.second);
+        mDirtyPeers.emplace(peer.first);
     }
-
-    return count;
+    flush();
 }
 
-std::vector<PeerBareAddress>
-PeerManager::loadPeers(size_t limit, size_t offset, std::string const& where,
-                       std::function<void(soci::statement&)> const& bind)
+void
+PeerManager::flush()
 {
     ZoneScoped;
-    auto result = std::vector<PeerBareAddress>{};
+    if (mDirtyPeers.empty())
+    {
+        return;
+    }
 
     try
     {
-        std::string sql = "SELECT ip, port "
-                          "FROM peers WHERE " +
-                          where + " LIMIT :limit OFFSET :offset";
-
-        auto prep = mApp.getDatabase().getPreparedStatement(sql);
-        auto& st = prep.statement();
-
-        bind(st);
-        st.exchange(use(limit));
-        st.exchange(use(offset));
-
-        std::string ip;
-        int lport;
-        st.exchange(into(ip));
-        st.exchange(into(lport));
-
-        st.define_and_bind();
-        {
-            auto timer = mApp.getDatabase().getSelectTimer("peer");
-            st.execute(true);
-        }
-        while (st.got_data())
+        auto& db = mApp.getDatabase();
+        auto timer = db.getUpdateTimer("peer");
+        soci::transaction tx(db.getSession());
+        for (auto const& address : mDirtyPeers)
         {
-            if (!ip.empty() && lport > 0)
+            auto it = mPeers.find(address);
+            if (it != mPeers.end())
             {
-                result.emplace_back(ip, static_cast<unsigned short>(lport));
+                writePeer(address, it->second);
+            }
+            else
+            {
+                deletePeer(address);
             }
-            st.fetch();
         }
+        tx.commit();
+        mDirtyPeers.clear();
     }
     catch (soci_error& err)
     {
-        CLOG_ERROR(Overlay, "loadPeers error: {}", err.what());
+        // nothing was written, as the transaction was rolled back: keep the
+        // peers dirty and try again later
+        CLOG_ERROR(Overlay, "PeerManager::flush error: {}", err.what());
+        scheduleFlush();
     }
-
-    return result;
 }
 
 void
-PeerManager::dropAll(Database& db)
+PeerManager::shutdown()
 {
-    db.getSession() << "DROP TABLE IF EXISTS peers;";
-    db.getSession() << kSQLCreateStatement;
+    mShuttingDown = true;
+    mFlushTimer.cancel();
+    flush();
 }
 
-std::vector<std::pair<PeerBareAddress, PeerRecord>>
-PeerManager::loadAllPeers()
+void
+PeerManager::ensureLoaded()
 {
     ZoneScoped;
-    std::vector<std::pair<PeerBareAddress, PeerRecord>> result;
+    if (mPeersLoaded)
+    {
+        return;
+    }
+    mPeersLoaded = true;
+
     std::string sql =
         "SELECT ip, port, nextattempt, numfailures, type FROM peers";
-
     try
     {
         std::string ip;
@@ -606,29 +495,112 @@ PeerManager::loadAllPeers()
         }
         while (st.got_data())
         {
-            PeerBareAddress pba{ip, static_cast<unsigned short>(port)};
-            result.emplace_back(std::make_pair(pba, record));
+            insertPeer(PeerBareAddress{ip, static_cast<unsigned short>(port)},
+                       record);
             st.fetch();
         }
     }
     catch (soci_error& err)
     {
-        CLOG_ERROR(Overlay, "loadPeers error: {}", err.what());
+        CLOG_ERROR(Overlay, "PeerManager::ensureLoaded error: {}",
+                   err.what());
     }
+    CLOG_DEBUG(Overlay, "Loaded {} peers from database", mPeers.size());
+}
 
-    return result;
+void
+PeerManager::insertPeer(PeerBareAddress const& address,
+                        PeerRecord const& record)
+{
+    auto res = mPeers.emplace(address, record);
+    if (!res.second)
+    {
+        auto& old = res.first->second;
+        mPeersByNextAttempt[old.mType].erase(NextAttemptKey{
+            VirtualClock::tmToSystemPoint(old.mNextAttempt), address});
+        old = record;
+    }
+    mPeersByNextAttempt[record.mType].emplace(
+        VirtualClock::tmToSystemPoint(record.mNextAttempt), address);
+}
+
+std::map<PeerBareAddress, PeerRecord>::iterator
+PeerManager::erasePeer(std::map<PeerBareAddress, PeerRecord>::iterator it)
+{
+    auto const& record = it->second;
+    mPeersByNextAttempt[record.mType].erase(NextAttemptKey{
+        VirtualClock::tmToSystemPoint(record.mNextAttempt), it->first});
+    markDirty(it->first);
+    return mPeers.erase(it);
 }
 
 void
-PeerManager::storePeers(
-    std::vector<std::pair<PeerBareAddress, PeerRecord>> peers)
+PeerManager::markDirty(PeerBareAddress const& address)
 {
-    soci::transaction tx(mApp.getDatabase().getSession());
-    for (auto const& peer : peers)
+    bool wasClean = mDirtyPeers.empty();
+    mDirtyPeers.emplace(address);
+    if (wasClean)
+    {
+        scheduleFlush();
+    }
+}
+
+void
+PeerManager::scheduleFlush()
+{
+    if (!mShuttingDown)
     {
-        store(peer.first, peer.second, /* inDatabase */ false);
+        mFlushTimer.expires_from_now(FLUSH_PERIOD);
+        mFlushTimer.async_wait([this]() { flush(); },
+                               VirtualTimer::onFailureNoop);
     }
-    tx.commit();
+}
+
+void
+PeerManager::writePeer(PeerBareAddress const& address,
+                       PeerRecord const& record)
+{
+    auto& db = mApp.getDatabase();
+    std::string ip = address.getIP();
+    int port = address.getPort();
+
+    // the row may be missing even for peers loaded from the database if it
+    // has been recreated since, so fall back to INSERT
+    for (auto const& query :
+         {"UPDATE peers SET nextattempt = :v1, numfailures = :v2, type = :v3 "
+          "WHERE ip = :v4 AND port = :v5",
+          "INSERT INTO peers (nextattempt, numfailures, type, ip, port) "
+          "VALUES (:v1, :v2, :v3, :v4, :v5)"})
+    {
+        auto prep = db.getPreparedStatement(query);
+        auto& st = prep.statement();
+        st.exchange(use(record.mNextAttempt));
+        st.exchange(use(record.mNumFailures));
+        st.exchange(use(record.mType));
+        st.exchange(use(ip));
+        st.exchange(use(port));
+        st.define_and_bind();
+        st.execute(true);
+        if (st.get_affected_rows() == 1)
+        {
+            return;
+        }
+    }
+    CLOG_ERROR(Overlay, "PeerManager::flush failed on {}", address.toString());
+}
+
+void
+PeerManager::deletePeer(PeerBareAddress const& address)
+{
+    auto prep = mApp.getDatabase().getPreparedStatement(
+        "DELETE FROM peers WHERE ip = :v1 AND port = :v2");
+    auto& st = prep.statement();
+    std::string ip = address.getIP();
+    st.exchange(use(ip));
+    int port = address.getPort();
+    st.exchange(use(port));
+    st.define_and_bind();
+    st.execute(true);
 }
 
 const char* PeerManager::kSQLCreateStatement =
@@ -8,11 +8,8 @@
 #include "util/Timer.h"
 
 #include <functional>
-
-namespace soci
-{
-class statement;
-}
+#include <map>
+#include <set>
 
 namespace stellar
 {
@@ -57,7 +54,8 @@ struct PeerQuery
 PeerAddress toXdr(PeerBareAddress const& address);
 
 /**
- * Maintain list of know peers in database.
+ * Maintain list of know peers in database. The peers are kept in memory once
+ * loaded, and changes are written back to the database in batches.
  */
 class PeerManager
 {
@@ -109,13 +107,14 @@ class PeerManager
     /**
      * Load PeerRecord data for peer with given address. If not available in
      * database, create default one. Second value in pair is true when data
-     * was loaded from database, false otherwise.
+     * was found in the peer table, false otherwise.
      */
     std::pair<PeerRecord, bool> load(PeerBareAddress const& address);
 
     /**
-     * Store PeerRecord data into database. If inDatabase is true, uses UPDATE
-     * query, uses INSERT otherwise.
+     * Store PeerRecord data into the peer table. inDatabase must match the
+     * value returned by load (the peer must be known if true, unknown
+     * otherwise). The change reaches the database on the next flush.
      */
     void store(PeerBareAddress const& address, PeerRecord const& PeerRecord,
                bool inDatabase);
@@ -145,22 +144,51 @@ class PeerManager
     std::vector<std::pair<PeerBareAddress, PeerRecord>> loadAllPeers();
 
     /**
-     * Store peers in the database.
+     * Replace the peer table with given peers and store them in the database
+     * right away. Used after the database has been recreated.
      */
     void storePeers(std::vector<std::pair<PeerBareAddress, PeerRecord>>);
 
+    /**
+     * Write all pending changes of the peer table to the database. If that
+     * fails, the changes are kept pending and written on the next flush.
+     */
+    void flush();
+
+    /**
+     * Flush pending changes and stop scheduling new flushes.
+     */
+    void shutdown();
+
   private:
     static const char* kSQLCreateStatement;
 
+    using NextAttemptKey =
+        std::pair<VirtualClock::system_time_point, PeerBareAddress>;
+
     Application& mApp;
     std::unique_ptr<RandomPeerSource> mOutboundPeersToSend;
     std::unique_ptr<RandomPeerSource> mInboundPeersToSend;
 
-    size_t countPeers(std::string const& where,
-                      std::function<void(soci::statement&)> const& bind);
-    std::vector<PeerBareAddress>
-    loadPeers(size_t limit, size_t offset, std::string const& where,
-              std::function<void(soci::statement&)> const& bind);
+    // In-memory copy of the peers table, loaded on first use.
+    bool mPeersLoaded{false};
+    std::map<PeerBareAddress, PeerRecord> mPeers;
+    // Peers of each type, ordered by next attempt time.
+    std::map<int, std::set<NextAttemptKey>> mPeersByNextAttempt;
+    // Peers changed since the last flush: the ones still in mPeers are
+    // written to the database, the other ones are deleted from it.
+    std::set<PeerBareAddress> mDirtyPeers;
+    VirtualTimer mFlushTimer;
+    bool mShuttingDown{false};
+
+    void scheduleFlush();
+    void ensureLoaded();
+    void insertPeer(PeerBareAddress const& address, PeerRecord const& record);
+    std::map<PeerBareAddress, PeerRecord>::iterator
+    erasePeer(std::map<PeerBareAddress, PeerRecord>::iterator it);
+    void markDirty(PeerBareAddress const& address);
+    void writePeer(PeerBareAddress const& address, PeerRecord const& record);
+    void deletePeer(PeerBareAddress const& address);
 
     void update(PeerRecord& peer, TypeUpdate type);
     void update(PeerRecord& peer, BackOffUpdate backOff, Application& app);
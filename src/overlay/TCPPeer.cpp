@@ -5,6 +5,7 @@
 #include "overlay/TCPPeer.h"
 #include "crypto/CryptoError.h"
 #include "crypto/Curve25519.h"
+#include "crypto/SHA.h"
 #include "database/Database.h"
 #include "main/Application.h"
 #include "main/Config.h"
@@ -13,6 +14,7 @@
 #include "medida/metrics_registry.h"
 #include "overlay/OverlayManager.h"
 #include "overlay/OverlayMetrics.h"
+#include "overlay/OverlayThreadPool.h"
 #include "overlay/PeerManager.h"
 #include "overlay/StellarXDR.h"
 #include "util/GlobalChecks.h"
@@ -455,13 +457,9 @@ TCPPeer::startRead()
         return;
     }
 
-    mIncomingHeader.clear();
-
     CLOG_DEBUG(Overlay, "TCPPeer::startRead {} from {}", mSocket->in_avail(),
                toString());
 
-    mIncomingHeader.resize(HDRSZ);
-
     // We read large-ish (256KB) buffers of data from TCP which might have quite
     // a few messages in them. We want to digest as many of these
     // _synchronously_ as we can before we issue an async_read against ASIO.
@@ -489,7 +487,7 @@ TCPPeer::startRead()
             noteFullyReadHeader();
             if (length != 0)
             {
-                mIncomingBody.resize(length);
+                prepareIncomingBody(length);
                 n = mSocket->read_some(asio::buffer(mIncomingBody), ec_body);
                 if (ec_body)
                 {
@@ -503,7 +501,7 @@ TCPPeer::startRead()
                 }
                 noteFullyReadBody(length);
                 recvMessage();
-                if (!canRead())
+                if (!canReadMore())
                 {
                     // Break and wait until more capacity frees up
                     CLOG_DEBUG(Overlay, "Throttle reading from peer {}!",
@@ -579,6 +577,42 @@ TCPPeer::getIncomingMsgLength()
     return (length);
 }
 
+void
+TCPPeer::prepareIncomingBody(size_t length)
+{
+    // The body buffer is moved out when decoding on the overlay threads, so
+    // pick up one of the buffers they handed back before allocating.
+    if (mIncomingBody.capacity() < length && !mFreeRecvBuffers.empty())
+    {
+        std::swap(mIncomingBody, mFreeRecvBuffers.back());
+        if (mFreeRecvBuffers.back().capacity() == 0)
+        {
+            mFreeRecvBuffers.pop_back();
+        }
+    }
+    if (mIncomingBody.capacity() < length)
+    {
+        getOverlayMetrics().mRecvBufferAllocated.Mark();
+    }
+    else
+    {
+        getOverlayMetrics().mRecvBufferReused.Mark();
+    }
+    mIncomingBody.resize(length);
+}
+
+void
+TCPPeer::recycleRecvBuffer(std::vector<uint8_t>&& buffer)
+{
+    if (buffer.capacity() == 0 ||
+        buffer.capacity() > MAX_RECYCLED_RECV_BUFFER_SIZE ||
+        mFreeRecvBuffers.size() >= MAX_FREE_RECV_BUFFERS)
+    {
+        return;
+    }
+    mFreeRecvBuffers.emplace_back(std::move(buffer));
+}
+
 void
 TCPPeer::connected()
 {
@@ -612,7 +646,7 @@ TCPPeer::readHeaderHandler(asio::error_code const& error,
         size_t expected_length = getIncomingMsgLength();
         if (expected_length != 0)
         {
-            mIncomingBody.resize(expected_length);
+            prepareIncomingBody(expected_length);
             auto self = static_pointer_cast<TCPPeer>(shared_from_this());
             asio::async_read(*mSocket.get(), asio::buffer(mIncomingBody),
                              [self, expected_length](asio::error_code ec,
@@ -643,12 +677,11 @@ TCPPeer::readBodyHandler(asio::error_code const& error,
     {
         noteFullyReadBody(bytes_transferred);
         recvMessage();
-        mIncomingHeader.clear();
         // Completing a startRead => readHeaderHandler => readBodyHandler
         // sequence happens after the first read of a single large input-buffer
         // worth of input. Even when we weren't preempted, we still bounce off
         // the per-peer scheduler queue here, to balance input across peers.
-        if (!canRead())
+        if (!canReadMore())
         {
             // No more capacity after processing this message
             CLOG_DEBUG(Overlay,
@@ -669,6 +702,13 @@ TCPPeer::recvMessage()
     assertThreadIsMain();
     releaseAssert(canRead());
 
+    auto pool = mApp.getOverlayManager().getOverlayThreadPool();
+    if (pool && isAuthenticated())
+    {
+        decodeInBackground(*pool);
+        return;
+    }
+
     try
     {
         xdr::xdr_get g(mIncomingBody.data(),
@@ -692,6 +732,186 @@ TCPPeer::recvMessage()
     }
 }
 
+bool
+TCPPeer::canReadMore() const
+{
+    return canRead() && mPendingDecodes < MAX_PENDING_DECODES;
+}
+
+void
+TCPPeer::decodeInBackground(OverlayThreadPool& pool)
+{
+    ZoneScoped;
+    if (!mRecvAuthState)
+    {
+        // From now on the receiving MAC state is only accessed from the pool
+        // thread assigned to this peer.
+        mRecvAuthState = std::make_shared<RecvAuthState>(
+            RecvAuthState{mRecvMacKey, mRecvMacSeq});
+        mDecodeShard = pool.assignShard();
+    }
+
+    // Lock the capacity of the message before decoding it, so that the
+    // messages waiting to be decoded count against the capacity of this peer
+    // when deciding whether to keep reading from it. Bodies too short to be
+    // peeked at fail to decode.
+    auto lockedCapacity = peekMessage(mIncomingBody);
+    if (lockedCapacity &&
+        !beginMessageProcessing(lockedCapacity->first, lockedCapacity->second))
+    {
+        return;
+    }
+
+    ++mPendingDecodes;
+    std::weak_ptr<TCPPeer> weak =
+        static_pointer_cast<TCPPeer>(shared_from_this());
+    pool.post(*mDecodeShard,
+              [&app = mApp, weak, state = mRecvAuthState, lockedCapacity,
+               body = std::move(mIncomingBody),
+               name = fmt::format(FMT_STRING("TCPPeer::recvDecodedMessage {}"),
+                                  toString())]() mutable {
+                  auto msg = std::make_shared<DecodedMessage>(
+                      decodeAndAuthenticate(*state, body));
+                  msg->mBody = std::move(body);
+                  msg->mLockedCapacity = lockedCapacity;
+                  app.postOnMainThread(
+                      [weak, msg]() {
+                          auto self = weak.lock();
+                          if (self)
+                          {
+                              self->recvDecodedMessage(*msg);
+                          }
+                      },
+                      std::move(name));
+              });
+}
+
+std::optional<std::pair<MessageType, size_t>>
+TCPPeer::peekMessage(std::vector<uint8_t> const& body)
+{
+    // The StellarMessage is framed by the AuthenticatedMessage discriminant
+    // and sequence number, and followed by the MAC. It starts with its type.
+    size_t constexpr prefixSize = sizeof(uint32_t) + sizeof(uint64_t);
+    size_t constexpr overhead = prefixSize + sizeof(HmacSha256Mac::mac);
+    if (body.size() < overhead + sizeof(int32_t))
+    {
+        return std::nullopt;
+    }
+    auto p = body.data() + prefixSize;
+    auto type = static_cast<int32_t>(
+        (static_cast<uint32_t>(p[0]) << 24) |
+        (static_cast<uint32_t>(p[1]) << 16) |
+        (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]));
+    return std::make_pair(static_cast<MessageType>(type),
+                          body.size() - overhead);
+}
+
+TCPPeer::DecodedMessage
+TCPPeer::decodeAndAuthenticate(RecvAuthState& state,
+                               std::vector<uint8_t> const& body)
+{
+    ZoneScoped;
+    DecodedMessage res;
+    AuthenticatedMessage am;
+    try
+    {
+        xdr::xdr_get g(body.data(), body.data() + body.size());
+        xdr::xdr_argpack_archive(g, am);
+    }
+    catch (xdr::xdr_runtime_error& e)
+    {
+        res.mErrorCode = ERR_DATA;
+        res.mError = "received corrupt XDR";
+        return res;
+    }
+    // The capacity was locked for the whole body, which must then be the
+    // exact encoding of the message
+    if (xdr::xdr_argpack_size(am) != body.size())
+    {
+        res.mErrorCode = ERR_DATA;
+        res.mError = "received corrupt XDR";
+        return res;
+    }
+
+    if (am.v0().message.type() != ERROR_MSG)
+    {
+        if (am.v0().sequence != state.mSequence)
+        {
+            ++state.mSequence;
+            res.mErrorCode = ERR_AUTH;
+            res.mError = "unexpected auth sequence";
+            return res;
+        }
+
+        // The MAC covers the sequence number and the message, which are
+        // serialized between the union discriminant and the MAC itself, so
+        // verify it over the received bytes instead of re-serializing.
+        ByteSlice authenticatedBytes(
+            body.data() + sizeof(uint32_t),
+            body.size() - sizeof(uint32_t) - sizeof(HmacSha256Mac::mac));
+        if (!hmacSha256Verify(am.v0().mac, state.mKey, authenticatedBytes))
+        {
+            ++state.mSequence;
+            res.mErrorCode = ERR_AUTH;
+            res.mError = "unexpected MAC";
+            return res;
+        }
+        ++state.mSequence;
+    }
+    res.mMessage = std::move(am.v0().message);
+    return res;
+}
+
+void
+TCPPeer::recvDecodedMessage(DecodedMessage& msg)
+{
+    ZoneScoped;
+    assertThreadIsMain();
+    releaseAssert(mPendingDecodes > 0);
+    --mPendingDecodes;
+    recycleRecvBuffer(std::move(msg.mBody));
+    if (shouldAbort())
+    {
+        return;
+    }
+
+    if (!msg.mMessage)
+    {
+        if (msg.mLockedCapacity)
+        {
+            mFlowControl->cancelMessageProcessing(msg.mLockedCapacity->first,
+                                                  msg.mLockedCapacity->second);
+        }
+        if (msg.mErrorCode == ERR_DATA)
+        {
+            CLOG_ERROR(Overlay, "recvMessage got a corrupt xdr");
+        }
+        sendErrorAndDrop(msg.mErrorCode, msg.mError,
+                         Peer::DropMode::IGNORE_WRITE_QUEUE);
+        return;
+    }
+
+    try
+    {
+        Peer::recvMessage(*msg.mMessage, msg.mLockedCapacity.has_value());
+    }
+    catch (CryptoError const& e)
+    {
+        CLOG_ERROR(Overlay, "Crypto error: {}", e.what());
+        sendErrorAndDrop(ERR_DATA, "crypto error",
+                         Peer::DropMode::IGNORE_WRITE_QUEUE);
+        return;
+    }
+
+    if (mIsPeerThrottled && canReadMore())
+    {
+        CLOG_DEBUG(Overlay, "Stop throttling reading from peer {}",
+                   mApp.getConfig().toShortString(getPeerID()));
+        mIsPeerThrottled = false;
+        scheduleRead();
+    }
+}
+
 void
 TCPPeer::drop(std::string const& reason, DropDirection dropDirection,
               DropMode dropMode)
@@ -6,7 +6,9 @@
 
 #include "overlay/Peer.h"
 #include "util/Timer.h"
+#include <array>
 #include <deque>
+#include <optional>
 
 namespace medida
 {
@@ -16,6 +18,8 @@ class Meter;
 namespace stellar
 {
 
+class OverlayThreadPool;
+
 static auto const MAX_UNAUTH_MESSAGE_SIZE = 0x1000;
 
 // Peer that communicates via a TCP socket.
@@ -26,9 +30,19 @@ class TCPPeer : public Peer
     static constexpr size_t BUFSZ = 0x40000; // 256KB
 
   private:
+    static constexpr size_t HDRSZ = 4;
+
     std::shared_ptr<SocketType> mSocket;
-    std::vector<uint8_t> mIncomingHeader;
+    std::array<uint8_t, HDRSZ> mIncomingHeader;
     std::vector<uint8_t> mIncomingBody;
+    // Body buffers handed back once decoded on the overlay threads, reused
+    // for the next messages instead of allocating new ones.
+    std::vector<std::vector<uint8_t>> mFreeRecvBuffers;
+    // Buffers larger than this are released rather than kept for reuse.
+    static constexpr size_t MAX_RECYCLED_RECV_BUFFER_SIZE = BUFSZ;
+    // Only a few buffers are needed to absorb the decoding latency, keeping
+    // more just pins memory after a burst of messages.
+    static constexpr size_t MAX_FREE_RECV_BUFFERS = 4;
 
     std::vector<asio::const_buffer> mWriteBuffers;
     std::deque<TimestampedMessage> mWriteQueue;
@@ -39,6 +53,47 @@ class TCPPeer : public Peer
     void recvMessage();
     void sendMessage(xdr::msg_ptr&& xdrBytes) override;
 
+    // When OVERLAY_DECODE_THREADS is set, messages received after the
+    // authentication are decoded and authenticated on the overlay thread
+    // assigned to this peer. The receiving MAC state is then owned by that
+    // thread, and the decoded messages are handed back to the main thread in
+    // the order they were received. The flow control capacity of a message is
+    // locked when it is read, before it is decoded.
+    struct RecvAuthState
+    {
+        HmacSha256Key mKey;
+        uint64_t mSequence;
+    };
+    struct DecodedMessage
+    {
+        std::optional<StellarMessage> mMessage;
+        ErrorCode mErrorCode{ERR_MISC};
+        std::string mError;
+        // The received body, returned to the peer for reuse.
+        std::vector<uint8_t> mBody;
+        // Type and size the capacity was locked for when the body was read.
+        std::optional<std::pair<MessageType, size_t>> mLockedCapacity;
+    };
+    // Maximum number of messages waiting to be decoded before this peer stops
+    // reading from its socket.
+    static constexpr size_t MAX_PENDING_DECODES = 64;
+    std::shared_ptr<RecvAuthState> mRecvAuthState;
+    std::optional<size_t> mDecodeShard;
+    size_t mPendingDecodes{0};
+
+    // Reads the type and the serialized size of the StellarMessage carried by
+    // a received body, without decoding it.
+    static std::optional<std::pair<MessageType, size_t>>
+    peekMessage(std::vector<uint8_t> const& body);
+    static DecodedMessage
+    decodeAndAuthenticate(RecvAuthState& state,
+                          std::vector<uint8_t> const& body);
+    void decodeInBackground(OverlayThreadPool& pool);
+    void recvDecodedMessage(DecodedMessage& msg);
+    void prepareIncomingBody(size_t length);
+    void recycleRecvBuffer(std::vector<uint8_t>&& buffer);
+    bool canReadMore() const;
+
     void messageSender();
 
     size_t getIncomingMsgLength();
@@ -47,7 +102,6 @@ class TCPPeer : public Peer
     virtual bool sendQueueIsOverloaded() const override;
     void startRead();
 
-    static constexpr size_t HDRSZ = 4;
     void noteErrorReadHeader(size_t nbytes, asio::error_code const& ec);
     void noteShortReadHeader(size_t nbytes);
     void noteFullyReadHeader();
@@ -83,5 +137,18 @@ class TCPPeer : public Peer
                       DropMode dropMode) override;
 
     std::string getIP() const override;
+
+#ifdef BUILD_TESTS
+    size_t
+    getFreeRecvBufferCountForTesting() const
+    {
+        return mFreeRecvBuffers.size();
+    }
+    static constexpr size_t
+    getMaxFreeRecvBuffersForTesting()
+    {
+        return MAX_FREE_RECV_BUFFERS;
+    }
+#endif
 };
 }
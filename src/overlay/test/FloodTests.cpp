@@ -10,18 +10,23 @@
 #include "lib/catch.hpp"
 #include "main/Application.h"
 #include "main/Config.h"
+#include "overlay/FloodedTxRecorder.h"
+#include "overlay/Floodgate.h"
 #include "overlay/OverlayManager.h"
 #include "overlay/OverlayMetrics.h"
 #include "overlay/PeerDoor.h"
 #include "overlay/TCPPeer.h"
+#include "overlay/test/LoopbackPeer.h"
 #include "overlay/test/OverlayTestUtils.h"
 #include "simulation/Simulation.h"
 #include "simulation/Topologies.h"
 #include "test/TestAccount.h"
+#include "test/TestUtils.h"
 #include "test/TxTests.h"
 #include "test/test.h"
 #include "util/Logging.h"
 #include "util/Timer.h"
+#include "util/TmpDir.h"
 #include "xdrpp/marshal.h"
 
 namespace stellar
@@ -548,4 +553,201 @@ TEST_CASE("Flooding", "[flood][overlay][acceptance]")
         }
     }
 }
+
+TEST_CASE("flooded transactions recording", "[flood][overlay]")
+{
+    VirtualClock clock;
+    TmpDir dir("flooded-tx-recording");
+    auto recordPath = dir.getName() + "/flooded.xdr";
+    auto cfg = getTestConfig();
+    cfg.FLOODED_TX_RECORD_PATH = recordPath;
+    auto app = createTestApplication(clock, cfg);
+
+    auto root = TestAccount::createRoot(*app);
+    std::vector<TransactionEnvelope> txs;
+    for (int i = 0; i < 5; ++i)
+    {
+        auto tx = root.tx({payment(root, i + 1)});
+        txs.emplace_back(tx->getEnvelope());
+        app->getOverlayManager().recordFloodedTransaction(txs.back());
+    }
+    // Shutting down the overlay flushes and closes the recording
+    app->getOverlayManager().shutdown();
+
+    XDRInputFileStream in;
+    in.open(recordPath);
+    uint64_t arrivalTime = 0;
+    uint64_t prevArrivalTime = 0;
+    TransactionEnvelope env;
+    size_t i = 0;
+    while (FloodedTxRecorder::readNext(in, arrivalTime, env))
+    {
+        REQUIRE(i < txs.size());
+        REQUIRE(env == txs[i]);
+        REQUIRE(arrivalTime >= prevArrivalTime);
+        prevArrivalTime = arrivalTime;
+        ++i;
+    }
+    REQUIRE(i == txs.size());
+}
+
+TEST_CASE("flooded transactions recording from peers", "[flood][overlay]")
+{
+    VirtualClock clock;
+    TmpDir dir("flooded-tx-recording");
+    auto recordPath = dir.getName() + "/flooded.xdr";
+    auto cfg = getTestConfig(0);
+    cfg.FLOODED_TX_RECORD_PATH = recordPath;
+    auto app = createTestApplication(clock, cfg);
+    auto peerApp1 = createTestApplication(clock, getTestConfig(1));
+    auto peerApp2 = createTestApplication(clock, getTestConfig(2));
+
+    LoopbackPeerConnection conn1(*peerApp1, *app);
+    LoopbackPeerConnection conn2(*peerApp2, *app);
+    testutil::crankSome(clock);
+    REQUIRE(conn1.getInitiator()->isAuthenticated());
+    REQUIRE(conn2.getInitiator()->isAuthenticated());
+
+    auto root = TestAccount::createRoot(*app);
+    auto tx = root.tx({payment(root, 1)});
+    // Invalid: reuses the sequence number of `tx`
+    auto invalidTx = root.tx({payment(root, 2)}, tx->getSeqNum());
+    auto send = [&](LoopbackPeerConnection& conn,
+                    TransactionFrameBasePtr const& t) {
+        conn.getInitiator()->sendMessage(
+            std::make_shared<StellarMessage const>(t->toStellarMessage()));
+    };
+    // Both peers flood the transaction, only recorded once
+    send(conn1, tx);
+    send(conn2, tx);
+    send(conn2, invalidTx);
+    testutil::crankSome(clock);
+
+    // Shutting down the overlay flushes and closes the recording
+    app->getOverlayManager().shutdown();
+
+    XDRInputFileStream in;
+    in.open(recordPath);
+    uint64_t arrivalTime = 0;
+    TransactionEnvelope env;
+    REQUIRE(FloodedTxRecorder::readNext(in, arrivalTime, env));
+    REQUIRE(env == tx->getEnvelope());
+    REQUIRE(!FloodedTxRecorder::readNext(in, arrivalTime, env));
+
+    testutil::shutdownWorkScheduler(*peerApp2);
+    testutil::shutdownWorkScheduler(*peerApp1);
+    testutil::shutdownWorkScheduler(*app);
+}
+
+TEST_CASE("flood peer slot set", "[flood][overlay]")
+{
+    Floodgate::PeerSlotSet set;
+    size_t const inlineSlots = Floodgate::PeerSlotSet::INLINE_SLOTS;
+    REQUIRE(set.size() == 0);
+    REQUIRE(!set.contains(0));
+    REQUIRE(!set.contains(inlineSlots * 4));
+
+    // Inline and overflow slots, with gaps in the overflow words
+    std::vector<size_t> slots{0,
+                              63,
+                              inlineSlots - 1,
+                              inlineSlots,
+                              inlineSlots + 63,
+                              inlineSlots * 4 + 5};
+    for (auto slot : slots)
+    {
+        REQUIRE(set.insert(slot));
+    }
+    REQUIRE(set.size() == slots.size());
+    for (auto slot : slots)
+    {
+        REQUIRE(set.contains(slot));
+        REQUIRE(!set.insert(slot));
+    }
+    REQUIRE(set.size() == slots.size());
+    REQUIRE(!set.contains(1));
+    REQUIRE(!set.contains(inlineSlots + 1));
+    REQUIRE(!set.contains(inlineSlots * 2));
+    REQUIRE(!set.contains(inlineSlots * 8));
+
+    // Erasing missing slots, allocated or not, is a no-op
+    set.erase(1);
+    set.erase(inlineSlots + 1);
+    set.erase(inlineSlots * 8);
+    REQUIRE(set.size() == slots.size());
+
+    for (auto slot : slots)
+    {
+        set.erase(slot);
+        REQUIRE(!set.contains(slot));
+    }
+    REQUIRE(set.size() == 0);
+
+    // Slots are reusable after being erased
+    REQUIRE(set.insert(inlineSlots * 4 + 5));
+    REQUIRE(set.size() == 1);
+}
+
+TEST_CASE("flood peer slots of reconnected peers", "[flood][overlay]")
+{
+    VirtualClock clock;
+    auto app1 = createTestApplication(clock, getTestConfig(0));
+    auto app2 = createTestApplication(clock, getTestConfig(1));
+    // A floodgate of our own, to control when peers are forgotten
+    Floodgate floodgate(*app1);
+
+    StellarMessage msg;
+    msg.type(GET_SCP_STATE);
+    msg.getSCPLedgerSeq() = 1;
+    auto const ledger = app1->getHerder().trackingConsensusLedgerIndex();
+
+    auto connect = [&]() {
+        auto conn = std::make_unique<LoopbackPeerConnection>(*app1, *app2);
+        testutil::crankSome(clock);
+        REQUIRE(conn->getInitiator()->isAuthenticated());
+        return conn;
+    };
+    auto disconnect = [&](std::unique_ptr<LoopbackPeerConnection>& conn) {
+        auto peer = conn->getInitiator();
+        conn.reset();
+        testutil::crankSome(clock);
+        floodgate.forgetPeer(*peer);
+        REQUIRE(!floodgate.getPeerSlotForTesting(*peer));
+    };
+
+    // The message came from the first connection, it isn't sent back
+    auto conn = connect();
+    Hash msgID;
+    REQUIRE(floodgate.addRecord(msg, conn->getInitiator(), msgID));
+    REQUIRE(floodgate.getPeerSlotForTesting(*conn->getInitiator()) == 0);
+    REQUIRE(floodgate.getPeersKnows(msgID).count(conn->getInitiator()) == 1);
+    REQUIRE(!floodgate.broadcast(msg, false));
+
+    // After a reconnection, the peer is told again, using a new slot as the
+    // record still refers to the slot of the previous connection
+    disconnect(conn);
+    floodgate.clearBelow(ledger);
+    conn = connect();
+    REQUIRE(floodgate.getPeersKnows(msgID).empty());
+    REQUIRE(floodgate.broadcast(msg, false));
+    REQUIRE(floodgate.getPeerSlotForTesting(*conn->getInitiator()) == 1);
+    REQUIRE(floodgate.getPeersKnows(msgID).count(conn->getInitiator()) == 1);
+    REQUIRE(!floodgate.broadcast(msg, false));
+
+    // Once the record is cleared, the retired slots are reused
+    disconnect(conn);
+    floodgate.clearBelow(ledger + 1);
+    conn = connect();
+    REQUIRE(floodgate.addRecord(msg, nullptr, msgID));
+    REQUIRE(floodgate.broadcast(msg, false));
+    auto slot = floodgate.getPeerSlotForTesting(*conn->getInitiator());
+    REQUIRE(slot);
+    REQUIRE(*slot < 2);
+    REQUIRE(!floodgate.broadcast(msg, false));
+
+    conn.reset();
+    testutil::crankSome(clock);
+    testutil::shutdownWorkScheduler(*app2);
+    testutil::shutdownWorkScheduler(*app1);
+}
 }
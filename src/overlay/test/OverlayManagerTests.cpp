@@ -167,6 +167,7 @@ class OverlayManagerTests
             pm.storeConfigPeers();
         }
 
+        pm.getPeerManager().flush();
         rowset<row> rs = app->getDatabase().getSession().prepare
                          << "SELECT ip,port,type FROM peers ORDER BY ip, port";
 
@@ -215,6 +216,7 @@ class OverlayManagerTests
         pm.mResolvedPeers.wait();
         pm.tick();
 
+        pm.getPeerManager().flush();
         rowset<row> rs = app->getDatabase().getSession().prepare
                          << "SELECT ip,port,type FROM peers ORDER BY ip, port";
 
@@ -4,6 +4,9 @@
 
 #include "crypto/KeyUtils.h"
 #include "crypto/SecretKey.h"
+#include "herder/TxSetFrame.h"
+#include "herder/test/TestTxSetUtils.h"
+#include "ledger/LedgerManager.h"
 #include "lib/catch.hpp"
 #include "main/Application.h"
 #include "main/Config.h"
@@ -97,6 +100,60 @@ TEST_CASE("loopback peer send auth before hello", "[overlay][connections]")
     testutil::shutdownWorkScheduler(*app1);
 }
 
+TEST_CASE("loopback peer shared message serialization", "[overlay]")
+{
+    VirtualClock clock;
+    auto const& cfg1 = getTestConfig(0);
+    auto const& cfg2 = getTestConfig(1);
+    auto app1 = createTestApplication(clock, cfg1);
+    auto app2 = createTestApplication(clock, cfg2);
+
+    LoopbackPeerConnection conn(*app1, *app2);
+    testutil::crankSome(clock);
+    REQUIRE(conn.getInitiator()->isAuthenticated());
+    REQUIRE(conn.getAcceptor()->isAuthenticated());
+
+    auto txSet = TxSetFrame::makeEmpty(
+        app1->getLedgerManager().getLastClosedLedgerHeader());
+    auto msg = txSet->toStellarMessage();
+
+    auto& om = app1->getOverlayManager();
+    auto serialized = om.getSerializedMessage(msg);
+    REQUIRE(*serialized == xdr::xdr_to_opaque(*msg));
+    REQUIRE(om.getSerializedMessage(msg) == serialized);
+    // An equal, but distinct message gets its own serialization
+    auto msgCopy = std::make_shared<StellarMessage const>(*msg);
+    REQUIRE(om.getSerializedMessage(msgCopy) != serialized);
+
+    // Frames built from the shared serialization are correctly authenticated
+    auto& recvTxSet =
+        app2->getOverlayManager().getOverlayMetrics().mRecvTxSetTimer;
+    auto recvBefore = recvTxSet.count();
+    conn.getInitiator()->sendMessage(msg);
+    conn.getInitiator()->sendMessage(msgCopy);
+    conn.getInitiator()->sendMessage(msg);
+    testutil::crankSome(clock);
+
+    REQUIRE(conn.getInitiator()->isAuthenticated());
+    REQUIRE(conn.getAcceptor()->isAuthenticated());
+    REQUIRE(recvTxSet.count() == recvBefore + 3);
+
+    // Serializations of destroyed messages are released on the next tick
+    auto& omImpl = static_cast<OverlayManagerImpl&>(om);
+    REQUIRE(omImpl.getSerializedMessagesBytesForTesting() ==
+            2 * serialized->size());
+    txSet.reset();
+    msg.reset();
+    msgCopy.reset();
+    serialized.reset();
+    testutil::crankFor(
+        clock, std::chrono::seconds(cfg1.PEER_AUTHENTICATION_TIMEOUT + 2));
+    REQUIRE(omImpl.getSerializedMessagesBytesForTesting() == 0);
+
+    testutil::shutdownWorkScheduler(*app2);
+    testutil::shutdownWorkScheduler(*app1);
+}
+
 TEST_CASE("flow control byte capacity", "[overlay][flowcontrol]")
 {
     StellarMessage msg;
@@ -211,6 +268,136 @@ TEST_CASE("flow control byte capacity", "[overlay][flowcontrol]")
     }
 }
 
+TEST_CASE("flow control capacity auto-tuning", "[overlay][flowcontrol]")
+{
+    StellarMessage msg;
+    msg.type(TRANSACTION);
+
+    VirtualClock clock;
+    auto cfg1 = getTestConfig(0);
+    auto cfg2 = getTestConfig(1);
+    cfg2.FLOW_CONTROL_AUTO_TUNE = true;
+    cfg2.PEER_FLOOD_READING_CAPACITY = 20;
+    cfg2.FLOW_CONTROL_SEND_MORE_BATCH_SIZE = 2;
+    cfg2.PEER_FLOOD_READING_CAPACITY_MIN = 5;
+    cfg2.PEER_FLOOD_READING_CAPACITY_MAX = 100;
+
+    auto app1 = createTestApplication(clock, cfg1);
+    auto app2 = createTestApplication(clock, cfg2);
+    LoopbackPeerConnection conn(*app1, *app2);
+    testutil::crankSome(clock);
+    REQUIRE(conn.getInitiator()->isAuthenticated());
+    REQUIRE(conn.getAcceptor()->isAuthenticated());
+
+    auto getWindow = [&]() {
+        return conn.getAcceptor()
+            ->getFlowControl()
+            ->getCapacity()
+            ->getCapacityLimits()
+            .mFloodCapacity;
+    };
+    REQUIRE(getWindow() == cfg2.PEER_FLOOD_READING_CAPACITY);
+
+    // Loopback connections have no latency, so the capacity granted to the
+    // initiator is more than it needs and shrinks down to the minimum.
+    for (int i = 0; i < 60; i++)
+    {
+        conn.getInitiator()->sendMessage(std::make_shared<StellarMessage>(msg));
+        testutil::crankSome(clock);
+    }
+    REQUIRE(getWindow() == cfg2.PEER_FLOOD_READING_CAPACITY_MIN);
+    REQUIRE(conn.getAcceptor()->getFlowControl()->getCapacity()->getCapacity()
+                .mFloodCapacity == cfg2.PEER_FLOOD_READING_CAPACITY_MIN);
+
+    // The initiator is told about the smaller capacity
+    REQUIRE(conn.getInitiator()
+                ->getFlowControl()
+                ->getCapacity()
+                ->getOutboundCapacity() ==
+            cfg2.PEER_FLOOD_READING_CAPACITY_MIN);
+
+    auto info = conn.getAcceptor()->getJsonInfo(false)["flow_control"];
+    REQUIRE(info["flood_window"].asUInt64() ==
+            cfg2.PEER_FLOOD_READING_CAPACITY_MIN);
+    REQUIRE(info.isMember("send_more_rtt_ms"));
+}
+
+TEST_CASE("flow control capacity auto-tuning growth", "[overlay][flowcontrol]")
+{
+    VirtualClock clock;
+    auto cfg1 = getTestConfig(0);
+    auto cfg2 = getTestConfig(1);
+    cfg2.FLOW_CONTROL_AUTO_TUNE = true;
+    cfg2.PEER_READING_CAPACITY = 30;
+    cfg2.PEER_FLOOD_READING_CAPACITY = 20;
+    cfg2.FLOW_CONTROL_SEND_MORE_BATCH_SIZE = 2;
+    cfg2.PEER_FLOOD_READING_CAPACITY_MIN = 5;
+    cfg2.PEER_FLOOD_READING_CAPACITY_MAX = 100;
+
+    auto app1 = createTestApplication(clock, cfg1);
+    auto app2 = createTestApplication(clock, cfg2);
+    LoopbackPeerConnection conn(*app1, *app2);
+    testutil::crankSome(clock);
+    REQUIRE(conn.getInitiator()->isAuthenticated());
+    REQUIRE(conn.getAcceptor()->isAuthenticated());
+
+    auto flowControl = conn.getAcceptor()->getFlowControl();
+    auto capacity = flowControl->getCapacity();
+    REQUIRE(capacity->getCapacityLimits().mFloodCapacity ==
+            cfg2.PEER_FLOOD_READING_CAPACITY);
+
+    // A peer sending 1000 messages per second with a 20ms round-trip time
+    // needs 20 messages in flight: the capacity targets twice that, plus a
+    // batch. The total capacity grows along, keeping the room for non-flood
+    // messages.
+    flowControl->tuneCapacityForTesting(1000, 20);
+    REQUIRE(capacity->getCapacityLimits().mFloodCapacity == 42);
+    REQUIRE(*capacity->getCapacityLimits().mTotalCapacity == 52);
+    REQUIRE(capacity->getCapacity().mFloodCapacity == 42);
+    REQUIRE(*capacity->getCapacity().mTotalCapacity == 52);
+
+    // Growth stops at PEER_FLOOD_READING_CAPACITY_MAX
+    flowControl->tuneCapacityForTesting(1000, 500);
+    REQUIRE(capacity->getCapacityLimits().mFloodCapacity ==
+            cfg2.PEER_FLOOD_READING_CAPACITY_MAX);
+    REQUIRE(*capacity->getCapacityLimits().mTotalCapacity == 110);
+    flowControl->tuneCapacityForTesting(1000, 5000);
+    REQUIRE(capacity->getCapacityLimits().mFloodCapacity ==
+            cfg2.PEER_FLOOD_READING_CAPACITY_MAX);
+
+    // The whole flood window can be used, along with the room for other
+    // messages
+    StellarMessage floodMsg;
+    floodMsg.type(TRANSACTION);
+    StellarMessage otherMsg;
+    otherMsg.type(GET_PEERS);
+    for (uint32_t i = 0; i < cfg2.PEER_FLOOD_READING_CAPACITY_MAX; ++i)
+    {
+        REQUIRE(capacity->lockLocalCapacity(floodMsg));
+    }
+    // A rejected flood message still takes total capacity
+    REQUIRE(!capacity->lockLocalCapacity(floodMsg));
+    capacity->releaseLocalCapacity(otherMsg);
+    for (int i = 0; i < 10; ++i)
+    {
+        REQUIRE(capacity->lockLocalCapacity(otherMsg));
+    }
+    REQUIRE(!capacity->canRead());
+
+    // Shrinking the flood capacity leaves the total capacity alone
+    for (uint32_t i = 0; i < cfg2.PEER_FLOOD_READING_CAPACITY_MAX; ++i)
+    {
+        capacity->releaseLocalCapacity(floodMsg);
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        capacity->releaseLocalCapacity(otherMsg);
+    }
+    capacity->adjustFloodCapacity(-50);
+    REQUIRE(capacity->getCapacityLimits().mFloodCapacity == 50);
+    REQUIRE(*capacity->getCapacityLimits().mTotalCapacity == 110);
+}
+
 void
 runWithBothFlowControlModes(std::vector<Config>& cfgs,
                             std::function<void(bool)> f)
@@ -543,6 +730,88 @@ TEST_CASE("failed auth", "[overlay][connections]")
     testutil::shutdownWorkScheduler(*app1);
 }
 
+#ifndef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+TEST_CASE("drop peers sending invalid compact tx set messages",
+          "[overlay][connections]")
+{
+    VirtualClock clock;
+    auto app1 = createTestApplication(clock, getTestConfig(0));
+    auto app2 = createTestApplication(clock, getTestConfig(1));
+
+    LoopbackPeerConnection conn(*app1, *app2);
+    testutil::crankSome(clock);
+    REQUIRE(conn.getInitiator()->isAuthenticated());
+    REQUIRE(conn.getAcceptor()->isAuthenticated());
+
+    std::string dropReason;
+    SECTION("unrequested compact tx set")
+    {
+        StellarMessage msg;
+        msg.type(COMPACT_TX_SET);
+        msg.compactTxSet().txSetHash = HashUtils::random();
+        conn.getInitiator()->sendMessage(
+            std::make_shared<StellarMessage const>(msg));
+        dropReason = "unrequested compact tx set";
+    }
+    SECTION("tx set transactions request")
+    {
+        auto root = TestAccount::createRoot(*app2);
+        std::vector<TransactionFrameBasePtr> txs;
+        for (int i = 0; i < 3; ++i)
+        {
+            txs.emplace_back(root.tx({txtest::payment(root, 1)}));
+        }
+        auto lcl = app2->getLedgerManager().getLastClosedLedgerHeader();
+        auto txSet = testtxset::makeNonValidatedGeneralizedTxSet(
+            {{std::make_pair(std::nullopt, txs)}}, *app2, lcl.hash);
+        auto& herder = static_cast<HerderImpl&>(app2->getHerder());
+        herder.getPendingEnvelopes().putTxSet(txSet->getContentsHash(),
+                                              lcl.header.ledgerSeq, txSet);
+
+        StellarMessage msg;
+        msg.type(GET_TX_SET_TRANSACTIONS);
+        msg.getTxSetTransactions().txSetHash = txSet->getContentsHash();
+        SECTION("valid indices")
+        {
+            msg.getTxSetTransactions().indices = {0, 2};
+        }
+        SECTION("index out of range")
+        {
+            msg.getTxSetTransactions().indices = {0, 3};
+            dropReason = "invalid tx set transaction indices";
+        }
+        SECTION("duplicate indices")
+        {
+            msg.getTxSetTransactions().indices = {1, 1};
+            dropReason = "invalid tx set transaction indices";
+        }
+        SECTION("decreasing indices")
+        {
+            msg.getTxSetTransactions().indices = {2, 0};
+            dropReason = "invalid tx set transaction indices";
+        }
+        conn.getInitiator()->sendMessage(
+            std::make_shared<StellarMessage const>(msg));
+    }
+    testutil::crankSome(clock);
+
+    if (dropReason.empty())
+    {
+        REQUIRE(conn.getInitiator()->isConnected());
+        REQUIRE(conn.getAcceptor()->isConnected());
+    }
+    else
+    {
+        REQUIRE(!conn.getInitiator()->isConnected());
+        REQUIRE(!conn.getAcceptor()->isConnected());
+        REQUIRE(conn.getAcceptor()->getDropReason() == dropReason);
+    }
+
+    testutil::shutdownWorkScheduler(*app2);
+    testutil::shutdownWorkScheduler(*app1);
+}
+#endif
+
 TEST_CASE("outbound queue filtering", "[overlay][connections]")
 {
     auto networkID = sha256(getTestConfig().NETWORK_PASSPHRASE);
@@ -2515,6 +2784,32 @@ TEST_CASE("overlay pull mode", "[overlay][pullmode]")
         REQUIRE(getUnknownDemandCount(apps[1]) == 3);
     }
 
+    SECTION("balance demands across advertisers")
+    {
+        std::vector<std::shared_ptr<StellarMessage>> onlyNode0;
+        std::vector<std::shared_ptr<StellarMessage>> both;
+        for (auto i = 0; i < 4; i++)
+        {
+            onlyNode0.push_back(createTxn(i));
+            both.push_back(createTxn(i + 4));
+        }
+
+        // Node 0 advertises {tx0, ..., tx3} and {tx4, ..., tx7} to Node 2,
+        // Node 1 only advertises {tx4, ..., tx7}
+        links[0][2]->sendMessage(createAdvert(onlyNode0), false);
+        links[0][2]->sendMessage(createAdvert(both), false);
+        links[1][2]->sendMessage(createAdvert(both), false);
+
+        testutil::crankFor(clock, apps[2]->getConfig().FLOOD_DEMAND_PERIOD_MS +
+                                      epsilon);
+
+        // Node 0 is the only one that can serve {tx0, ..., tx3}, so the
+        // transactions both nodes know about are all demanded from Node 1.
+        REQUIRE(getSentDemandCount(apps[2]) == 2);
+        REQUIRE(getUnknownDemandCount(apps[0]) == 4);
+        REQUIRE(getUnknownDemandCount(apps[1]) == 4);
+    }
+
     SECTION("randomize peers")
     {
         auto peer0 = 0;
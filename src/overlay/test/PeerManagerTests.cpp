@@ -537,4 +537,45 @@ TEST_CASE("purge peer table", "[overlay][PeerManager]")
     peerManager.removePeersWithManyFailures(2, &localhost2);
     REQUIRE(!peerManager.load(localhost(2)).second);
 }
+
+TEST_CASE("peer table is written back to database", "[overlay][PeerManager]")
+{
+    VirtualClock clock;
+    auto app = createTestApplication(clock, getTestConfig());
+    auto& peerManager = app->getOverlayManager().getPeerManager();
+    auto now = VirtualClock::systemPointToTm(clock.system_now());
+    auto record = [&](size_t numFailures) {
+        return PeerRecord{now, numFailures,
+                          static_cast<int>(PeerType::INBOUND)};
+    };
+    auto loadFromDatabase = [&](PeerBareAddress const& address) {
+        PeerManager fresh{*app};
+        return fresh.load(address);
+    };
+
+    peerManager.store(localhost(1), record(1), false);
+    peerManager.store(localhost(2), record(5), false);
+    REQUIRE(!loadFromDatabase(localhost(1)).second);
+
+    testutil::crankFor(clock, std::chrono::seconds(6));
+    REQUIRE(loadFromDatabase(localhost(1)).first == record(1));
+    REQUIRE(loadFromDatabase(localhost(2)).first == record(5));
+
+    peerManager.update(localhost(1), PeerType::OUTBOUND, false);
+    peerManager.removePeersWithManyFailures(5);
+    peerManager.flush();
+
+    auto loaded = loadFromDatabase(localhost(1));
+    REQUIRE(loaded.second);
+    REQUIRE(loaded.first.mType == static_cast<int>(PeerType::OUTBOUND));
+    REQUIRE(!loadFromDatabase(localhost(2)).second);
+
+    // Changes that failed to be written are kept for the next flush
+    peerManager.store(localhost(3), record(2), false);
+    app->getDatabase().getSession() << "DROP TABLE peers;";
+    peerManager.flush();
+    PeerManager::dropAll(app->getDatabase());
+    peerManager.flush();
+    REQUIRE(loadFromDatabase(localhost(3)).first == record(2));
+}
 }
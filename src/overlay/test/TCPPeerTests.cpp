@@ -2,18 +2,26 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "herder/Herder.h"
 #include "lib/catch.hpp"
 #include "main/Application.h"
 #include "main/Config.h"
+#include "overlay/FlowControl.h"
+#include "overlay/FlowControlCapacity.h"
 #include "overlay/OverlayManager.h"
+#include "overlay/OverlayMetrics.h"
 #include "overlay/PeerBareAddress.h"
 #include "overlay/PeerDoor.h"
 #include "overlay/TCPPeer.h"
 #include "simulation/Simulation.h"
+#include "simulation/Topologies.h"
 #include "test/test.h"
 #include "util/Logging.h"
 #include "util/Timer.h"
 
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
+
 namespace stellar
 {
 
@@ -53,4 +61,125 @@ TEST_CASE("TCPPeer can communicate", "[overlay][acceptance]")
     REQUIRE(p1->isAuthenticated());
     s->stopAllNodes();
 }
+
+TEST_CASE("TCPPeer decodes messages on overlay threads", "[overlay]")
+{
+    Hash networkID = sha256(getTestConfig().NETWORK_PASSPHRASE);
+    auto s = Topologies::core(3, 1.0f, Simulation::OVER_TCP, networkID,
+                              [](int i) {
+                                  auto cfg = getTestConfig(i);
+                                  cfg.OVERLAY_DECODE_THREADS = 2;
+                                  return cfg;
+                              });
+    s->startAllNodes();
+
+    // Reaching consensus requires every SCP message exchanged after the
+    // handshake to go through the overlay threads
+    s->crankUntil([&]() { return s->haveAllExternalized(4, 1); },
+                  5 * Herder::EXP_LEDGER_TIMESPAN_SECONDS, false);
+
+    for (auto const& node : s->getNodes())
+    {
+        REQUIRE(node->getOverlayManager().getOverlayThreadPool());
+        REQUIRE(node->getOverlayManager().getAuthenticatedPeersCount() == 2);
+
+        // The body buffers handed back by the overlay threads are reused,
+        // and only a few of them are kept around
+        auto& reused = node->getMetrics().NewMeter(
+            {"overlay", "recv-buffer", "reused"}, "buffer");
+        auto& allocated = node->getMetrics().NewMeter(
+            {"overlay", "recv-buffer", "allocated"}, "buffer");
+        REQUIRE(allocated.count() > 0);
+        REQUIRE(reused.count() > allocated.count());
+        for (auto const& kv : node->getOverlayManager().getAuthenticatedPeers())
+        {
+            auto peer = std::dynamic_pointer_cast<TCPPeer>(kv.second);
+            REQUIRE(peer);
+            REQUIRE(peer->getFreeRecvBufferCountForTesting() <=
+                    TCPPeer::getMaxFreeRecvBuffersForTesting());
+        }
+    }
+    s->stopAllNodes();
+}
+
+TEST_CASE("TCPPeer decoding on overlay threads enforces capacity",
+          "[overlay][flowcontrol]")
+{
+    Hash networkID = sha256(getTestConfig().NETWORK_PASSPHRASE);
+    Simulation::pointer s =
+        std::make_shared<Simulation>(Simulation::OVER_TCP, networkID);
+
+    auto v10SecretKey = SecretKey::fromSeed(sha256("v10"));
+    auto v11SecretKey = SecretKey::fromSeed(sha256("v11"));
+
+    SCPQuorumSet n0_qset;
+    n0_qset.threshold = 1;
+    n0_qset.validators.push_back(v10SecretKey.getPublicKey());
+    auto n0 = s->addNode(v10SecretKey, n0_qset);
+
+    auto cfg1 = getTestConfig(1);
+    cfg1.OVERLAY_DECODE_THREADS = 1;
+    cfg1.PEER_READING_CAPACITY = 4;
+    cfg1.PEER_FLOOD_READING_CAPACITY = 2;
+    cfg1.FLOW_CONTROL_SEND_MORE_BATCH_SIZE = 1;
+    SCPQuorumSet n1_qset;
+    n1_qset.threshold = 1;
+    n1_qset.validators.push_back(v11SecretKey.getPublicKey());
+    auto n1 = s->addNode(v11SecretKey, n1_qset, &cfg1);
+
+    s->addPendingConnection(v10SecretKey.getPublicKey(),
+                            v11SecretKey.getPublicKey());
+    s->startAllNodes();
+    s->crankForAtLeast(std::chrono::seconds(1), false);
+
+    auto p0 = n0->getOverlayManager().getConnectedPeer(
+        PeerBareAddress{"127.0.0.1", n1->getConfig().PEER_PORT});
+    auto p1 = n1->getOverlayManager().getConnectedPeer(
+        PeerBareAddress{"127.0.0.1", n0->getConfig().PEER_PORT});
+    REQUIRE(p0);
+    REQUIRE(p1);
+    REQUIRE(p0->isAuthenticated());
+    REQUIRE(p1->isAuthenticated());
+
+    // n1 reads the messages faster than it decodes them, so it must account
+    // for their capacity as it reads them
+    SECTION("messages over the reading capacity are throttled")
+    {
+        auto& recvTimer = n1->getOverlayManager()
+                              .getOverlayMetrics()
+                              .mRecvGetSCPQuorumSetTimer;
+        auto recvBefore = recvTimer.count();
+        StellarMessage msg;
+        msg.type(GET_SCP_QUORUMSET);
+        for (int i = 0; i < 20; i++)
+        {
+            p0->sendMessage(std::make_shared<StellarMessage const>(msg));
+        }
+        s->crankForAtLeast(std::chrono::seconds(1), false);
+
+        REQUIRE(p1->isAuthenticated());
+        REQUIRE(recvTimer.count() == recvBefore + 20);
+    }
+    SECTION("peer sending past its flood capacity is dropped")
+    {
+        // Make n0 ignore the capacity n1 granted it
+        p0->getFlowControl()->getCapacity()->setOutboundCapacity(100);
+        if (p0->getFlowControl()->getCapacityBytes())
+        {
+            p0->getFlowControl()->getCapacityBytes()->setOutboundCapacity(
+                100 * MAX_MESSAGE_SIZE);
+        }
+        StellarMessage msg;
+        msg.type(TRANSACTION);
+        for (int i = 0; i < 20; i++)
+        {
+            p0->sendMessage(std::make_shared<StellarMessage const>(msg));
+        }
+        s->crankForAtLeast(std::chrono::seconds(1), false);
+
+        REQUIRE(!p1->isConnected());
+        REQUIRE(!p0->isConnected());
+    }
+    s->stopAllNodes();
+}
 }
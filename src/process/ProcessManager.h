@@ -49,6 +49,8 @@ class ProcessManager : public std::enable_shared_from_this<ProcessManager>,
 {
   public:
     static std::shared_ptr<ProcessManager> create(Application& app);
+    // `cmdLine` is not run through a shell: it is split on whitespace, and
+    // arguments containing whitespace must be put in double quotes.
     virtual std::weak_ptr<ProcessExitEvent>
     runProcess(std::string const& cmdLine, std::string outputFile) = 0;
 
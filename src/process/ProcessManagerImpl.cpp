@@ -22,10 +22,10 @@
 #include <fmt/format.h>
 
 #include <algorithm>
+#include <cctype>
 #include <functional>
 #include <iterator>
 #include <mutex>
-#include <regex>
 #include <string>
 #include <thread>
 
@@ -766,13 +766,42 @@ ProcessManagerImpl::forcedShutdown(std::shared_ptr<ProcessExitEvent> pe)
     return true;
 }
 
+// Splits `s` on whitespace, except within double quotes, which are removed:
+// arguments containing spaces can be quoted as on Windows (without its
+// backslash escaping rules).
 static std::vector<std::string>
 split(std::string const& s)
 {
     std::vector<std::string> parts;
-    std::regex ws_re("\\s+");
-    std::copy(std::sregex_token_iterator(s.begin(), s.end(), ws_re, -1),
-              std::sregex_token_iterator(), std::back_inserter(parts));
+    std::string part;
+    bool inPart = false;
+    bool quoted = false;
+    for (char c : s)
+    {
+        if (c == '"')
+        {
+            quoted = !quoted;
+            inPart = true;
+        }
+        else if (!quoted && std::isspace(static_cast<unsigned char>(c)))
+        {
+            if (inPart)
+            {
+                parts.emplace_back(std::move(part));
+                part.clear();
+                inPart = false;
+            }
+        }
+        else
+        {
+            part += c;
+            inPart = true;
+        }
+    }
+    if (inPart)
+    {
+        parts.emplace_back(std::move(part));
+    }
     return parts;
 }
 
@@ -109,6 +109,43 @@ TEST_CASE("subprocess redirect to new file", "[process]")
     CHECK(!s.empty());
 }
 
+TEST_CASE("subprocess with quoted arguments", "[process]")
+{
+    VirtualClock clock;
+    Config const& cfg = getTestConfig();
+    Application::pointer appPtr = createTestApplication(clock, cfg);
+    Application& app = *appPtr;
+    TmpDir tmpDir = app.getTmpDirManager().tmpDir("subprocess quoted");
+    std::string src(fmt::format("{}/source file.txt", tmpDir.getName()));
+    std::string dst(fmt::format("{}/copied file.txt", tmpDir.getName()));
+    {
+        std::ofstream out(src);
+        out << "content";
+    }
+    bool exited = false;
+    bool failed = false;
+    auto evt = app.getProcessManager()
+                   .runProcess(fmt::format("cp \"{}\" \"{}\"", src, dst), "")
+                   .lock();
+    REQUIRE(evt);
+    evt->async_wait([&](asio::error_code ec) {
+        failed = !!ec;
+        exited = true;
+    });
+
+    while (!exited && !clock.getIOContext().stopped())
+    {
+        clock.crank(true);
+    }
+    REQUIRE(!failed);
+
+    std::ifstream in(dst);
+    REQUIRE(in);
+    std::string s;
+    std::getline(in, s);
+    REQUIRE(s == "content");
+}
+
 TEST_CASE("subprocess redirect to existing file", "[process]")
 {
     // This test should have the process fail, because there's already
@@ -87,7 +87,7 @@ struct PeerAddress
     uint32 numFailures;
 };
 
-// Next ID: 21
+// Next ID: 25
 enum MessageType
 {
     ERROR_MSG = 0,
@@ -100,6 +100,11 @@ enum MessageType
     GET_TX_SET = 6, // gets a particular txset by hash
     TX_SET = 7,
     GENERALIZED_TX_SET = 17,
+    // compact tx set relay
+    GET_COMPACT_TX_SET = 21,
+    COMPACT_TX_SET = 22,
+    GET_TX_SET_TRANSACTIONS = 23,
+    TX_SET_TRANSACTIONS = 24,
 
     TRANSACTION = 8, // pass on a tx you have heard about
 
@@ -238,6 +243,51 @@ struct FloodDemand
     TxDemandVector txHashes;
 };
 
+// Generalized tx sets have at most one phase per kind of transactions (classic
+// and Soroban), and the ones with more than COMPACT_TX_SET_MAX_TXS
+// transactions in total are only relayed in full.
+const COMPACT_TX_SET_MAX_PHASES = 2;
+const COMPACT_TX_SET_MAX_TXS = 10000;
+
+// Generalized tx set where every transaction is replaced by a short id
+// derived from its full hash. The receiver reconstructs the tx set from the
+// transactions it already knows and requests the missing ones with
+// GetTxSetTransactions.
+struct CompactTxSetComponent
+{
+    int64* baseFee;
+    uint64 shortTxIDs<COMPACT_TX_SET_MAX_TXS>;
+};
+
+struct CompactTxSetPhase
+{
+    CompactTxSetComponent components<COMPACT_TX_SET_MAX_TXS>;
+};
+
+struct CompactTxSet
+{
+    Hash txSetHash;
+    Hash previousLedgerHash;
+    // salt of the short transaction ids, chosen by the sender
+    uint64 shortIDSalt;
+    CompactTxSetPhase phases<COMPACT_TX_SET_MAX_PHASES>;
+};
+
+struct GetTxSetTransactions
+{
+    Hash txSetHash;
+    // positions of the requested transactions in the tx set, counted across
+    // all the components of all the phases, in increasing order
+    uint32 indices<COMPACT_TX_SET_MAX_TXS>;
+};
+
+struct TxSetTransactions
+{
+    Hash txSetHash;
+    // transactions in the order they were requested
+    TransactionEnvelope txs<COMPACT_TX_SET_MAX_TXS>;
+};
+
 union StellarMessage switch (MessageType type)
 {
 case ERROR_MSG:
@@ -254,11 +304,18 @@ case PEERS:
     PeerAddress peers<100>;
 
 case GET_TX_SET:
+case GET_COMPACT_TX_SET:
     uint256 txSetHash;
 case TX_SET:
     TransactionSet txSet;
 case GENERALIZED_TX_SET:
     GeneralizedTransactionSet generalizedTxSet;
+case COMPACT_TX_SET:
+    CompactTxSet compactTxSet;
+case GET_TX_SET_TRANSACTIONS:
+    GetTxSetTransactions getTxSetTransactions;
+case TX_SET_TRANSACTIONS:
+    TxSetTransactions txSetTransactions;
 
 case TRANSACTION:
     TransactionEnvelope transaction;
@@ -218,7 +218,7 @@ BallotProtocol::processEnvelope(SCPEnvelopeWrapperPtr envelope, bool self)
     // note: this handles also our own messages
     // in particular our final EXTERNALIZE message
     dbgAssert(mPhase == SCP_PHASE_EXTERNALIZE);
-    if (mCommit->getBallot().value == getWorkingBallot(statement).value)
+    if (mCommit->getBallot().value == getWorkingBallotValue(statement))
     {
         recordEnvelope(envelope);
         return SCP::EnvelopeState::VALID;
@@ -724,9 +724,9 @@ BallotProtocol::getPrepareCandidates(SCPStatement const& hint)
 
     while (!hintBallots.empty())
     {
-        auto last = --hintBallots.end();
-        SCPBallot topVote = *last;
-        hintBallots.erase(last);
+        // take the ballot out of the set rather than copying it
+        auto node = hintBallots.extract(--hintBallots.end());
+        SCPBallot const& topVote = node.value();
 
         auto const& val = topVote.value;
 
@@ -812,7 +812,7 @@ BallotProtocol::attemptAcceptPrepared(SCPStatement const& hint)
     // see if we can accept any of the candidates, starting with the highest
     for (auto cur = candidates.rbegin(); cur != candidates.rend(); cur++)
     {
-        SCPBallot ballot = *cur;
+        SCPBallot const& ballot = *cur;
 
         if (mPhase == SCP_PHASE_CONFIRM)
         {
@@ -876,7 +876,9 @@ BallotProtocol::attemptAcceptPrepared(SCPStatement const& hint)
 
                 return res;
             },
-            std::bind(&BallotProtocol::hasPreparedBallot, ballot, _1));
+            [&ballot](SCPStatement const& st) {
+                return hasPreparedBallot(ballot, st);
+            });
         if (accepted)
         {
             return setAcceptPrepared(ballot);
@@ -945,7 +947,7 @@ BallotProtocol::attemptConfirmPrepared(SCPStatement const& hint)
     auto cur = candidates.rbegin();
     for (; cur != candidates.rend(); cur++)
     {
-        SCPBallot ballot = *cur;
+        SCPBallot const& ballot = *cur;
 
         // only consider it if we can potentially raise h
         if (mHighBallot &&
@@ -954,8 +956,9 @@ BallotProtocol::attemptConfirmPrepared(SCPStatement const& hint)
             break;
         }
 
-        bool ratified = federatedRatify(
-            std::bind(&BallotProtocol::hasPreparedBallot, ballot, _1));
+        bool ratified = federatedRatify([&ballot](SCPStatement const& st) {
+            return hasPreparedBallot(ballot, st);
+        });
         if (ratified)
         {
             newH = ballot;
@@ -982,7 +985,7 @@ BallotProtocol::attemptConfirmPrepared(SCPStatement const& hint)
             // continue where we left off (cur is at newH at this point)
             for (; cur != candidates.rend(); cur++)
             {
-                SCPBallot ballot = *cur;
+                SCPBallot const& ballot = *cur;
                 if (compareBallots(ballot, b) < 0)
                 {
                     break;
@@ -992,8 +995,10 @@ BallotProtocol::attemptConfirmPrepared(SCPStatement const& hint)
                 {
                     continue;
                 }
-                bool ratified = federatedRatify(
-                    std::bind(&BallotProtocol::hasPreparedBallot, ballot, _1));
+                bool ratified =
+                    federatedRatify([&ballot](SCPStatement const& st) {
+                        return hasPreparedBallot(ballot, st);
+                    });
                 if (ratified)
                 {
                     newC = ballot;
@@ -1272,7 +1277,9 @@ BallotProtocol::attemptAcceptCommit(SCPStatement const& hint)
                 }
                 return res;
             },
-            std::bind(&BallotProtocol::commitPredicate, ballot, cur, _1));
+            [&](SCPStatement const& st) {
+                return commitPredicate(ballot, cur, st);
+            });
     };
 
     // build the boundaries to scan
@@ -1489,8 +1496,9 @@ BallotProtocol::attemptConfirmCommit(SCPStatement const& hint)
     Interval candidate;
 
     auto pred = [&ballot, this](Interval const& cur) -> bool {
-        return federatedRatify(
-            std::bind(&BallotProtocol::commitPredicate, ballot, cur, _1));
+        return federatedRatify([&](SCPStatement const& st) {
+            return commitPredicate(ballot, cur, st);
+        });
     };
 
     findExtendedInterval(candidate, boundaries, pred);
@@ -1549,9 +1557,10 @@ BallotProtocol::hasPreparedBallot(SCPBallot const& ballot,
     break;
     case SCP_ST_CONFIRM:
     {
+        // same as areBallotsLessAndCompatible(ballot, {c.nPrepared,
+        // c.ballot.value}), without building the ballot
         auto const& c = st.pledges.confirm();
-        SCPBallot prepared(c.nPrepared, c.ballot.value);
-        res = areBallotsLessAndCompatible(ballot, prepared);
+        res = ballot.counter <= c.nPrepared && ballot.value == c.ballot.value;
     }
     break;
     case SCP_ST_EXTERNALIZE:
@@ -1613,6 +1622,21 @@ BallotProtocol::getWorkingBallot(SCPStatement const& st)
     return res;
 }
 
+Value const&
+BallotProtocol::getWorkingBallotValue(SCPStatement const& st)
+{
+    switch (st.pledges.type())
+    {
+    case SCP_ST_CONFIRM:
+        return st.pledges.confirm().ballot.value;
+    case SCP_ST_EXTERNALIZE:
+        return st.pledges.externalize().commit.value;
+    default:
+        // throws on anything but SCP_ST_PREPARE
+        return st.pledges.prepare().ballot.value;
+    }
+}
+
 bool
 BallotProtocol::setPrepared(SCPBallot const& ballot)
 {
@@ -1842,9 +1866,8 @@ BallotProtocol::getExternalizingState() const
                 // good approximation: statements with the value that
                 // externalized
                 // we could filter more using mConfirmedPrepared as well
-                if (areBallotsCompatible(
-                        getWorkingBallot(n.second->getStatement()),
-                        mCommit->getBallot()))
+                if (getWorkingBallotValue(n.second->getStatement()) ==
+                    mCommit->getBallot().value)
                 {
                     res.emplace_back(n.second->getEnvelope());
                 }
@@ -2060,8 +2083,7 @@ BallotProtocol::getState(NodeID const& n, bool selfAlreadyMovedOn)
         auto const& selfSt = mLastEnvelopeEmit->getStatement();
 
         if (selfAcceptedConfirm && otherAcceptedConfirm &&
-            !areBallotsCompatible(getWorkingBallot(st),
-                                  getWorkingBallot(selfSt)))
+            getWorkingBallotValue(st) != getWorkingBallotValue(selfSt))
         {
             // n has accepted to commit a different value than mine!
             // Even if this node has been marked something else,
@@ -2127,7 +2149,7 @@ BallotProtocol::getJsonQuorumInfo(NodeID const& id, bool summary, bool fullKeys)
     auto f = LocalNode::findClosestVBlocking(
         *qSet, mLatestEnvelopes,
         [&](SCPStatement const& st) {
-            return areBallotsCompatible(getWorkingBallot(st), b);
+            return getWorkingBallotValue(st) == b.value;
         },
         &id);
     ret["fail_at"] = static_cast<int>(f.size());
@@ -2169,15 +2191,15 @@ BallotProtocol::getLocalNode()
 }
 
 bool
-BallotProtocol::federatedAccept(StatementPredicate voted,
-                                StatementPredicate accepted)
+BallotProtocol::federatedAccept(StatementPredicate const& voted,
+                                StatementPredicate const& accepted)
 {
     ZoneScoped;
     return mSlot.federatedAccept(voted, accepted, mLatestEnvelopes);
 }
 
 bool
-BallotProtocol::federatedRatify(StatementPredicate voted)
+BallotProtocol::federatedRatify(StatementPredicate const& voted)
 {
     ZoneScoped;
     return mSlot.federatedRatify(voted, mLatestEnvelopes);
@@ -144,6 +144,8 @@ class BallotProtocol
     // helper function to retrieve b for PREPARE, P for CONFIRM or
     // c for EXTERNALIZE messages
     static SCPBallot getWorkingBallot(SCPStatement const& st);
+    // value of `getWorkingBallot(st)`, without copying the ballot
+    static Value const& getWorkingBallotValue(SCPStatement const& st);
 
     SCPEnvelope const*
     getLastMessageSend() const
@@ -310,8 +312,9 @@ class BallotProtocol
 
     std::shared_ptr<LocalNode> getLocalNode();
 
-    bool federatedAccept(StatementPredicate voted, StatementPredicate accepted);
-    bool federatedRatify(StatementPredicate voted);
+    bool federatedAccept(StatementPredicate const& voted,
+                         StatementPredicate const& accepted);
+    bool federatedRatify(StatementPredicate const& voted);
 
     void startBallotProtocolTimer();
     void stopBallotProtocolTimer();
@@ -8,8 +8,10 @@
 #include "crypto/SecretKey.h"
 #include "lib/json/json.h"
 #include "scp/QuorumSetUtils.h"
+#include "util/BitSet.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
+#include "util/UnorderedMap.h"
 #include "util/XDROperators.h"
 #include "util/numeric.h"
 #include "xdrpp/marshal.h"
@@ -174,8 +176,9 @@ LocalNode::isQuorumSlice(SCPQuorumSet const& qSet,
 
 // called recursively
 bool
-LocalNode::isVBlockingInternal(SCPQuorumSet const& qset,
-                               std::vector<NodeID> const& nodeSet)
+LocalNode::isVBlockingInternal(
+    SCPQuorumSet const& qset,
+    std::function<bool(NodeID const&)> const& contains)
 {
     // There is no v-blocking set for {\empty}
     if (qset.threshold == 0)
@@ -189,8 +192,7 @@ LocalNode::isVBlockingInternal(SCPQuorumSet const& qset,
 
     for (auto const& validator : qset.validators)
     {
-        auto it = std::find(nodeSet.begin(), nodeSet.end(), validator);
-        if (it != nodeSet.end())
+        if (contains(validator))
         {
             leftTillBlock--;
             if (leftTillBlock <= 0)
@@ -201,7 +203,7 @@ LocalNode::isVBlockingInternal(SCPQuorumSet const& qset,
     }
     for (auto const& inner : qset.innerSets)
     {
-        if (isVBlockingInternal(inner, nodeSet))
+        if (isVBlockingInternal(inner, contains))
         {
             leftTillBlock--;
             if (leftTillBlock <= 0)
@@ -218,7 +220,10 @@ bool
 LocalNode::isVBlocking(SCPQuorumSet const& qSet,
                        std::vector<NodeID> const& nodeSet)
 {
-    return isVBlockingInternal(qSet, nodeSet);
+    return isVBlockingInternal(qSet, [&](NodeID const& nodeID) {
+        return std::find(nodeSet.begin(), nodeSet.end(), nodeID) !=
+               nodeSet.end();
+    });
 }
 
 bool
@@ -227,16 +232,81 @@ LocalNode::isVBlocking(SCPQuorumSet const& qSet,
                        std::function<bool(SCPStatement const&)> const& filter)
 {
     ZoneScoped;
-    std::vector<NodeID> pNodes;
-    for (auto const& it : map)
+    return isVBlockingInternal(qSet, [&](NodeID const& nodeID) {
+        auto it = map.find(nodeID);
+        return it != map.end() && filter(it->second->getStatement());
+    });
+}
+
+namespace
+{
+// Quorum set with its validators replaced by their index among the nodes
+// being evaluated. Validators outside of these nodes can never be part of a
+// quorum, so they are dropped (the threshold is kept as is).
+struct IndexedQSet
+{
+    uint32 mThreshold{0};
+    std::vector<size_t> mValidators;
+    std::vector<IndexedQSet> mInnerSets;
+};
+
+IndexedQSet
+indexQSet(SCPQuorumSet const& qSet,
+          UnorderedMap<NodeID, size_t> const& nodeIndices)
+{
+    IndexedQSet res;
+    res.mThreshold = qSet.threshold;
+    for (auto const& validator : qSet.validators)
     {
-        if (filter(it.second->getStatement()))
+        auto it = nodeIndices.find(validator);
+        if (it != nodeIndices.end())
         {
-            pNodes.push_back(it.first);
+            res.mValidators.emplace_back(it->second);
         }
     }
+    for (auto const& inner : qSet.innerSets)
+    {
+        res.mInnerSets.emplace_back(indexQSet(inner, nodeIndices));
+    }
+    return res;
+}
 
-    return isVBlocking(qSet, pNodes);
+void
+collectValidators(IndexedQSet const& qSet, std::vector<size_t>& validators)
+{
+    validators.insert(validators.end(), qSet.mValidators.begin(),
+                      qSet.mValidators.end());
+    for (auto const& inner : qSet.mInnerSets)
+    {
+        collectValidators(inner, validators);
+    }
+}
+
+// same semantic as LocalNode::isQuorumSliceInternal
+bool
+isQuorumSliceIndexed(IndexedQSet const& qSet, BitSet const& nodes)
+{
+    uint32 thresholdLeft = qSet.mThreshold;
+    if (thresholdLeft == 0)
+    {
+        return false;
+    }
+    for (auto validator : qSet.mValidators)
+    {
+        if (nodes.get(validator) && --thresholdLeft == 0)
+        {
+            return true;
+        }
+    }
+    for (auto const& inner : qSet.mInnerSets)
+    {
+        if (isQuorumSliceIndexed(inner, nodes) && --thresholdLeft == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
 }
 
 bool
@@ -247,38 +317,87 @@ LocalNode::isQuorum(
     std::function<bool(SCPStatement const&)> const& filter)
 {
     ZoneScoped;
-    std::vector<NodeID> pNodes;
+    // Number the filtered nodes, so that sets of nodes can be represented as
+    // bitsets and quorum sets compiled against that numbering.
+    std::vector<SCPStatement const*> statements;
+    UnorderedMap<NodeID, size_t> nodeIndices;
     for (auto const& it : map)
     {
-        if (filter(it.second->getStatement()))
+        auto const& st = it.second->getStatement();
+        if (filter(st))
+        {
+            nodeIndices.emplace(it.first, statements.size());
+            statements.emplace_back(&st);
+        }
+    }
+    size_t const n = statements.size();
+
+    // Nodes usually share a handful of quorum sets, so they are compiled once
+    // per distinct quorum set. `qSetPtrs` keeps them alive for the lookups.
+    std::vector<SCPQuorumSetPtr> qSetPtrs(n);
+    std::map<SCPQuorumSet const*, IndexedQSet> compiled;
+    std::vector<IndexedQSet const*> nodeQSets(n, nullptr);
+    // dependents[j] lists the nodes whose quorum set references node j
+    std::vector<std::vector<size_t>> dependents(n);
+    std::vector<size_t> validators;
+    for (size_t i = 0; i < n; i++)
+    {
+        qSetPtrs[i] = qfun(*statements[i]);
+        if (!qSetPtrs[i])
+        {
+            continue;
+        }
+        auto res = compiled.try_emplace(qSetPtrs[i].get());
+        if (res.second)
         {
-            pNodes.push_back(it.first);
+            res.first->second = indexQSet(*qSetPtrs[i], nodeIndices);
+        }
+        nodeQSets[i] = &res.first->second;
+
+        validators.clear();
+        collectValidators(*nodeQSets[i], validators);
+        std::sort(validators.begin(), validators.end());
+        validators.erase(std::unique(validators.begin(), validators.end()),
+                         validators.end());
+        for (auto v : validators)
+        {
+            dependents[v].emplace_back(i);
         }
     }
 
-    size_t count = 0;
-    do
+    // Remove the nodes that don't have a slice within the remaining nodes
+    // until the set is stable. Only the dependents of a removed node need to
+    // be checked again.
+    BitSet nodes(n);
+    std::vector<size_t> toCheck;
+    std::vector<bool> queued(n, true);
+    for (size_t i = 0; i < n; i++)
     {
-        count = pNodes.size();
-        std::vector<NodeID> fNodes(pNodes.size());
-        auto quorumFilter = [&](NodeID nodeID) -> bool {
-            auto qSetPtr = qfun(map.find(nodeID)->second->getStatement());
-            if (qSetPtr)
-            {
-                return isQuorumSlice(*qSetPtr, pNodes);
-            }
-            else
+        nodes.set(i);
+        toCheck.emplace_back(n - 1 - i);
+    }
+    while (!toCheck.empty())
+    {
+        size_t i = toCheck.back();
+        toCheck.pop_back();
+        queued[i] = false;
+        if (!nodes.get(i) ||
+            (nodeQSets[i] && isQuorumSliceIndexed(*nodeQSets[i], nodes)))
+        {
+            continue;
+        }
+        nodes.unset(i);
+        for (auto d : dependents[i])
+        {
+            if (nodes.get(d) && !queued[d])
             {
-                return false;
+                queued[d] = true;
+                toCheck.emplace_back(d);
             }
-        };
-        auto it = std::copy_if(pNodes.begin(), pNodes.end(), fNodes.begin(),
-                               quorumFilter);
-        fNodes.resize(std::distance(fNodes.begin(), it));
-        pNodes = fNodes;
-    } while (count != pNodes.size());
-
-    return isQuorumSlice(qSet, pNodes);
+        }
+    }
+
+    return isQuorumSliceIndexed(indexQSet(qSet, nodeIndices), nodes);
 }
 
 std::vector<NodeID>
@@ -111,7 +111,8 @@ class LocalNode
     // called recursively
     static bool isQuorumSliceInternal(SCPQuorumSet const& qset,
                                       std::vector<NodeID> const& nodeSet);
-    static bool isVBlockingInternal(SCPQuorumSet const& qset,
-                                    std::vector<NodeID> const& nodeSet);
+    static bool
+    isVBlockingInternal(SCPQuorumSet const& qset,
+                        std::function<bool(NodeID const&)> const& contains);
 };
 }
@@ -19,7 +19,6 @@
 
 namespace stellar
 {
-using namespace std::placeholders;
 
 NominationProtocol::NominationProtocol(Slot& slot)
     : mSlot(slot), mRoundNumber(0), mNominationStarted(false), mTimerExpCount(0)
@@ -191,11 +190,9 @@ NominationProtocol::emitNomination()
 bool
 NominationProtocol::acceptPredicate(Value const& v, SCPStatement const& st)
 {
+    // recorded statements are sane, so their values are sorted
     auto const& nom = st.pledges.nominate();
-    bool res;
-    res = (std::find(nom.accepted.begin(), nom.accepted.end(), v) !=
-           nom.accepted.end());
-    return res;
+    return std::binary_search(nom.accepted.begin(), nom.accepted.end(), v);
 }
 
 void
@@ -209,7 +206,7 @@ NominationProtocol::applyAll(SCPNomination const& nom,
     // NB: "accepted" should be a subset of "votes", so this should no-op
     for (auto const& a : nom.accepted)
     {
-        if (std::find(nom.votes.begin(), nom.votes.end(), a) == nom.votes.end())
+        if (!std::binary_search(nom.votes.begin(), nom.votes.end(), a))
         {
             processor(a);
         }
@@ -411,25 +408,26 @@ NominationProtocol::processEnvelope(SCPEnvelopeWrapperPtr envelope)
         // attempts to promote some of the votes to accepted
         for (auto const& v : nom.votes)
         {
-            auto vw = mSlot.getSCPDriver().wrapValue(v);
-            if (mAccepted.find(vw) != mAccepted.end())
+            // looked up without wrapping: wrapping a value can be expensive
+            if (mAccepted.find(v) != mAccepted.end())
             { // v is already accepted
                 continue;
             }
             if (mSlot.federatedAccept(
                     [&v](SCPStatement const& st) -> bool {
                         auto const& nom = st.pledges.nominate();
-                        bool res;
-                        res = (std::find(nom.votes.begin(), nom.votes.end(),
-                                         v) != nom.votes.end());
-                        return res;
+                        return std::binary_search(nom.votes.begin(),
+                                                  nom.votes.end(), v);
+                    },
+                    [&v](SCPStatement const& st) {
+                        return acceptPredicate(v, st);
                     },
-                    std::bind(&NominationProtocol::acceptPredicate, v, _1),
                     mLatestNominations))
             {
                 auto vl = validateValue(v);
                 if (vl == SCPDriver::kFullyValidatedValue)
                 {
+                    auto vw = mSlot.getSCPDriver().wrapValue(v);
                     mAccepted.emplace(vw);
                     mVotes.emplace(vw);
                     modified = true;
@@ -457,9 +455,11 @@ NominationProtocol::processEnvelope(SCPEnvelopeWrapperPtr envelope)
             {
                 continue;
             }
+            auto const& v = a->getValue();
             if (mSlot.federatedRatify(
-                    std::bind(&NominationProtocol::acceptPredicate,
-                              a->getValue(), _1),
+                    [&v](SCPStatement const& st) {
+                        return acceptPredicate(v, st);
+                    },
                     mLatestNominations))
             {
                 mCandidates.emplace(a);
@@ -23,6 +23,22 @@ WrappedValuePtrComparator::operator()(ValueWrapperPtr const& l,
     return l->getValue() < r->getValue();
 }
 
+bool
+WrappedValuePtrComparator::operator()(ValueWrapperPtr const& l,
+                                      Value const& r) const
+{
+    releaseAssert(l);
+    return l->getValue() < r;
+}
+
+bool
+WrappedValuePtrComparator::operator()(Value const& l,
+                                      ValueWrapperPtr const& r) const
+{
+    releaseAssert(r);
+    return l < r->getValue();
+}
+
 SCPEnvelopeWrapper::SCPEnvelopeWrapper(SCPEnvelope const& e) : mEnvelope(e)
 {
 }
@@ -36,7 +36,12 @@ typedef std::shared_ptr<ValueWrapper> ValueWrapperPtr;
 class WrappedValuePtrComparator
 {
   public:
+    // allows looking up a `Value` without wrapping it first
+    using is_transparent = void;
+
     bool operator()(ValueWrapperPtr const& l, ValueWrapperPtr const& r) const;
+    bool operator()(ValueWrapperPtr const& l, Value const& r) const;
+    bool operator()(Value const& l, ValueWrapperPtr const& r) const;
 };
 
 typedef std::set<ValueWrapperPtr, WrappedValuePtrComparator> ValueWrapperPtrSet;
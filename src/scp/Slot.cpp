@@ -394,7 +394,8 @@ Slot::getJsonQuorumInfo(NodeID const& id, bool summary, bool fullKeys)
 }
 
 bool
-Slot::federatedAccept(StatementPredicate voted, StatementPredicate accepted,
+Slot::federatedAccept(StatementPredicate const& voted,
+                      StatementPredicate const& accepted,
                       std::map<NodeID, SCPEnvelopeWrapperPtr> const& envs)
 {
     // Checks if the nodes that claimed to accept the statement form a
@@ -424,7 +425,7 @@ Slot::federatedAccept(StatementPredicate voted, StatementPredicate accepted,
 }
 
 bool
-Slot::federatedRatify(StatementPredicate voted,
+Slot::federatedRatify(StatementPredicate const& voted,
                       std::map<NodeID, SCPEnvelopeWrapperPtr> const& envs)
 {
     return LocalNode::isQuorum(
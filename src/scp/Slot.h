@@ -185,11 +185,12 @@ class Slot : public std::enable_shared_from_this<Slot>
 
     // returns true if the statement defined by voted and accepted
     // should be accepted
-    bool federatedAccept(StatementPredicate voted, StatementPredicate accepted,
+    bool federatedAccept(StatementPredicate const& voted,
+                         StatementPredicate const& accepted,
                          std::map<NodeID, SCPEnvelopeWrapperPtr> const& envs);
     // returns true if the statement defined by voted
     // is ratified
-    bool federatedRatify(StatementPredicate voted,
+    bool federatedRatify(StatementPredicate const& voted,
                          std::map<NodeID, SCPEnvelopeWrapperPtr> const& envs);
 
     std::shared_ptr<LocalNode> getLocalNode();
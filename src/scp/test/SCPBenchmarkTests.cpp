@@ -0,0 +1,458 @@
+// Copyright 2023 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "crypto/SHA.h"
+#include "crypto/SecretKey.h"
+#include "lib/catch.hpp"
+#include "scp/SCP.h"
+#include "test/ScaleReporter.h"
+#include "util/Logging.h"
+#include "util/Math.h"
+#include "xdrpp/marshal.h"
+#include <chrono>
+#include <deque>
+#include <fmt/format.h>
+#include <map>
+#include <optional>
+#include <tuple>
+
+// Benchmark of the SCP message processing, run with
+//
+//     stellar-core test "[scp-bench]"
+//
+// Every node of the simulated network runs its own `SCP` instance behind a
+// synthetic driver, and envelopes are delivered in-process (no overlay, no
+// herder, no signatures) so that the measured time is spent in `SCP`, `Slot`,
+// `BallotProtocol` and `NominationProtocol`. The delivery order is
+// configurable and deterministic. Timers only fire once the network runs out
+// of messages, which is when they would fire on a real network too.
+//
+// For every topology and size, a row is written with the number of envelopes
+// delivered, their throughput, the time spent per `receiveEnvelope` and the
+// number of envelope and value wrappers allocated per delivered envelope.
+
+namespace stellar
+{
+namespace
+{
+
+enum class DeliveryOrder
+{
+    // Envelopes are delivered in the order they were emitted.
+    FIFO,
+    // The latest emitted envelope is delivered first.
+    LIFO,
+    // Any pending envelope may be delivered next.
+    RANDOM
+};
+
+char const*
+deliveryOrderName(DeliveryOrder order)
+{
+    switch (order)
+    {
+    case DeliveryOrder::FIFO:
+        return "fifo";
+    case DeliveryOrder::LIFO:
+        return "lifo";
+    default:
+        return "random";
+    }
+}
+
+// Nodes of the simulated network along with their quorum sets.
+struct BenchTopology
+{
+    std::vector<NodeID> mNodeIDs;
+    std::vector<SCPQuorumSet> mQSets;
+};
+
+class BenchNetwork;
+
+class BenchSCPDriver : public SCPDriver
+{
+    BenchNetwork& mNetwork;
+    size_t const mIndex;
+
+  public:
+    SCP mSCP;
+
+    BenchSCPDriver(BenchNetwork& network, size_t index, NodeID const& nodeID,
+                   SCPQuorumSet const& qSet)
+        : mNetwork(network), mIndex(index), mSCP(*this, nodeID, true, qSet)
+    {
+    }
+
+    void
+    signEnvelope(SCPEnvelope&) override
+    {
+    }
+
+    SCPEnvelopeWrapperPtr wrapEnvelope(SCPEnvelope const& envelope) override;
+    ValueWrapperPtr wrapValue(Value const& value) override;
+    SCPQuorumSetPtr getQSet(Hash const& qSetHash) override;
+    void emitEnvelope(SCPEnvelope const& envelope) override;
+    void valueExternalized(uint64 slotIndex, Value const& value) override;
+    void setupTimer(uint64 slotIndex, int timerID,
+                    std::chrono::milliseconds timeout,
+                    std::function<void()> cb) override;
+    void stopTimer(uint64 slotIndex, int timerID) override;
+
+    ValidationLevel
+    validateValue(uint64 slotIndex, Value const& value,
+                  bool nomination) override
+    {
+        return kFullyValidatedValue;
+    }
+
+    ValueWrapperPtr
+    combineCandidates(uint64 slotIndex,
+                      ValueWrapperPtrSet const& candidates) override
+    {
+        // candidates are ordered by value
+        return *candidates.rbegin();
+    }
+
+    Hash
+    getHashOf(std::vector<xdr::opaque_vec<>> const& vals) const override
+    {
+        SHA256 hasher;
+        for (auto const& v : vals)
+        {
+            hasher.add(v);
+        }
+        return hasher.finish();
+    }
+};
+
+class BenchNetwork
+{
+  public:
+    struct Stats
+    {
+        size_t mEnvelopesDelivered{0};
+        size_t mEnvelopesWrapped{0};
+        size_t mValuesWrapped{0};
+        size_t mTimersFired{0};
+        std::chrono::nanoseconds mProcessingTime{0};
+        std::chrono::nanoseconds mMaxProcessingTime{0};
+    };
+
+    BenchNetwork(BenchTopology const& topology, DeliveryOrder order)
+        : mOrder(order), mRandom(1)
+    {
+        for (size_t i = 0; i < topology.mNodeIDs.size(); ++i)
+        {
+            auto const& qSet = topology.mQSets.at(i);
+            mQSets.emplace(sha256(xdr::xdr_to_opaque(qSet)),
+                           std::make_shared<SCPQuorumSet>(qSet));
+            mNodes.emplace_back(std::make_unique<BenchSCPDriver>(
+                *this, i, topology.mNodeIDs[i], qSet));
+        }
+    }
+
+    // Runs consensus on `slotIndex`, with every node nominating its own value,
+    // until all the nodes externalize.
+    void
+    runSlot(uint64 slotIndex)
+    {
+        mExternalized = 0;
+        mExternalizedValue.reset();
+        for (size_t i = 0; i < mNodes.size(); ++i)
+        {
+            Value v = xdr::xdr_to_opaque(
+                sha256(fmt::format("{:d}-{:d}", slotIndex, i)));
+            auto& scp = mNodes[i]->mSCP;
+            scp.nominate(slotIndex, mNodes[i]->wrapValue(v), mPreviousValue);
+        }
+        while (mExternalized < mNodes.size())
+        {
+            if (mPending.empty())
+            {
+                // Nothing left to deliver: let the timeouts expire.
+                REQUIRE(!mTimers.empty());
+                auto timers = std::move(mTimers);
+                mTimers.clear();
+                for (auto& t : timers)
+                {
+                    ++mStats.mTimersFired;
+                    t.second();
+                }
+                continue;
+            }
+            auto delivery = popPending();
+            auto& node = *mNodes[delivery.first];
+            auto env = node.wrapEnvelope(*delivery.second);
+
+            auto start = std::chrono::steady_clock::now();
+            node.mSCP.receiveEnvelope(env);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+
+            ++mStats.mEnvelopesDelivered;
+            mStats.mProcessingTime += elapsed;
+            mStats.mMaxProcessingTime =
+                std::max<std::chrono::nanoseconds>(mStats.mMaxProcessingTime,
+                                                   elapsed);
+        }
+
+        // Drop whatever is left of this slot before moving on.
+        mPending.clear();
+        mTimers.clear();
+        for (auto& n : mNodes)
+        {
+            n->mSCP.purgeSlots(slotIndex, slotIndex);
+        }
+        mPreviousValue = *mExternalizedValue;
+    }
+
+    size_t
+    size() const
+    {
+        return mNodes.size();
+    }
+
+    void
+    broadcast(size_t from, SCPEnvelope const& envelope)
+    {
+        auto env = std::make_shared<SCPEnvelope const>(envelope);
+        for (size_t i = 0; i < mNodes.size(); ++i)
+        {
+            if (i != from)
+            {
+                mPending.emplace_back(i, env);
+            }
+        }
+    }
+
+    void
+    externalized(Value const& value)
+    {
+        if (mExternalizedValue)
+        {
+            REQUIRE(*mExternalizedValue == value);
+        }
+        else
+        {
+            mExternalizedValue = value;
+        }
+        ++mExternalized;
+    }
+
+    SCPQuorumSetPtr
+    getQSet(Hash const& qSetHash) const
+    {
+        auto it = mQSets.find(qSetHash);
+        return it == mQSets.end() ? nullptr : it->second;
+    }
+
+    void
+    setTimer(size_t node, uint64 slotIndex, int timerID,
+             std::function<void()> cb)
+    {
+        auto key = std::make_tuple(node, slotIndex, timerID);
+        if (cb)
+        {
+            mTimers[key] = std::move(cb);
+        }
+        else
+        {
+            mTimers.erase(key);
+        }
+    }
+
+    Stats mStats;
+
+  private:
+    using Delivery = std::pair<size_t, std::shared_ptr<SCPEnvelope const>>;
+
+    Delivery
+    popPending()
+    {
+        Delivery res;
+        switch (mOrder)
+        {
+        case DeliveryOrder::FIFO:
+            res = std::move(mPending.front());
+            mPending.pop_front();
+            break;
+        case DeliveryOrder::LIFO:
+            res = std::move(mPending.back());
+            mPending.pop_back();
+            break;
+        case DeliveryOrder::RANDOM:
+        {
+            stellar::uniform_int_distribution<size_t> dist(
+                0, mPending.size() - 1);
+            std::swap(mPending[dist(mRandom)], mPending.back());
+            res = std::move(mPending.back());
+            mPending.pop_back();
+            break;
+        }
+        }
+        return res;
+    }
+
+    DeliveryOrder const mOrder;
+    stellar_default_random_engine mRandom;
+    std::vector<std::unique_ptr<BenchSCPDriver>> mNodes;
+    std::map<Hash, SCPQuorumSetPtr> mQSets;
+    std::deque<Delivery> mPending;
+    std::map<std::tuple<size_t, uint64, int>, std::function<void()>> mTimers;
+    size_t mExternalized{0};
+    std::optional<Value> mExternalizedValue;
+    Value mPreviousValue;
+};
+
+SCPEnvelopeWrapperPtr
+BenchSCPDriver::wrapEnvelope(SCPEnvelope const& envelope)
+{
+    ++mNetwork.mStats.mEnvelopesWrapped;
+    return SCPDriver::wrapEnvelope(envelope);
+}
+
+ValueWrapperPtr
+BenchSCPDriver::wrapValue(Value const& value)
+{
+    ++mNetwork.mStats.mValuesWrapped;
+    return SCPDriver::wrapValue(value);
+}
+
+SCPQuorumSetPtr
+BenchSCPDriver::getQSet(Hash const& qSetHash)
+{
+    return mNetwork.getQSet(qSetHash);
+}
+
+void
+BenchSCPDriver::emitEnvelope(SCPEnvelope const& envelope)
+{
+    mNetwork.broadcast(mIndex, envelope);
+}
+
+void
+BenchSCPDriver::valueExternalized(uint64 slotIndex, Value const& value)
+{
+    mNetwork.externalized(value);
+}
+
+void
+BenchSCPDriver::setupTimer(uint64 slotIndex, int timerID,
+                           std::chrono::milliseconds timeout,
+                           std::function<void()> cb)
+{
+    mNetwork.setTimer(mIndex, slotIndex, timerID, std::move(cb));
+}
+
+void
+BenchSCPDriver::stopTimer(uint64 slotIndex, int timerID)
+{
+    mNetwork.setTimer(mIndex, slotIndex, timerID, nullptr);
+}
+
+std::vector<NodeID>
+generateNodeIDs(size_t n)
+{
+    std::vector<NodeID> ids;
+    for (size_t i = 0; i < n; ++i)
+    {
+        ids.emplace_back(SecretKey::pseudoRandomForTesting().getPublicKey());
+    }
+    return ids;
+}
+
+uint32
+bftThreshold(size_t n)
+{
+    return static_cast<uint32>(n - (n - 1) / 3);
+}
+
+// Every node trusts all the nodes directly.
+BenchTopology
+flatTopology(size_t nNodes)
+{
+    BenchTopology res{generateNodeIDs(nNodes), {}};
+    SCPQuorumSet qSet;
+    qSet.threshold = bftThreshold(nNodes);
+    for (auto const& id : res.mNodeIDs)
+    {
+        qSet.validators.emplace_back(id);
+    }
+    res.mQSets.assign(nNodes, qSet);
+    return res;
+}
+
+// Nodes are grouped in organizations of `orgSize` nodes, and every node
+// requires a majority of each of a BFT threshold of the organizations, as
+// validators on the public network do.
+BenchTopology
+tieredTopology(size_t nOrgs, size_t orgSize)
+{
+    BenchTopology res{generateNodeIDs(nOrgs * orgSize), {}};
+    SCPQuorumSet qSet;
+    qSet.threshold = bftThreshold(nOrgs);
+    for (size_t i = 0; i < nOrgs; ++i)
+    {
+        SCPQuorumSet org;
+        org.threshold = static_cast<uint32>(orgSize / 2 + 1);
+        for (size_t j = 0; j < orgSize; ++j)
+        {
+            org.validators.emplace_back(res.mNodeIDs.at(i * orgSize + j));
+        }
+        qSet.innerSets.emplace_back(org);
+    }
+    res.mQSets.assign(nOrgs * orgSize, qSet);
+    return res;
+}
+
+void
+runSCPBenchmark(std::string const& topology,
+                std::function<BenchTopology(size_t)> makeTopology,
+                std::vector<size_t> const& sizes, DeliveryOrder order)
+{
+    size_t const slots = 5;
+    ScaleReporter r({fmt::format("scp-{}-{}-nodes", topology,
+                                 deliveryOrderName(order)),
+                     "envelopes", "envpersec", "usperenv", "maxusperenv",
+                     "timers", "envwrapsperenv", "valwrapsperenv"});
+    for (auto size : sizes)
+    {
+        BenchNetwork network(makeTopology(size), order);
+        auto start = std::chrono::steady_clock::now();
+        for (uint64 slot = 1; slot <= slots; ++slot)
+        {
+            network.runSlot(slot);
+        }
+        auto elapsed = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+
+        auto const& stats = network.mStats;
+        double envs = static_cast<double>(stats.mEnvelopesDelivered);
+        double usPerEnv =
+            std::chrono::duration<double, std::micro>(stats.mProcessingTime)
+                .count() /
+            envs;
+        double maxUs = std::chrono::duration<double, std::micro>(
+                           stats.mMaxProcessingTime)
+                           .count();
+        r.write({static_cast<double>(network.size()), envs, envs / elapsed,
+                 usPerEnv, maxUs, static_cast<double>(stats.mTimersFired),
+                 stats.mEnvelopesWrapped / envs, stats.mValuesWrapped / envs});
+    }
+}
+}
+
+TEST_CASE("SCP message processing benchmark", "[scp-bench][!hide]")
+{
+    for (auto order :
+         {DeliveryOrder::FIFO, DeliveryOrder::LIFO, DeliveryOrder::RANDOM})
+    {
+        runSCPBenchmark("flat", flatTopology, {4, 16, 64, 128}, order);
+        runSCPBenchmark(
+            "tiered",
+            [](size_t nOrgs) { return tieredTopology(nOrgs, 3); },
+            {4, 7, 16, 34, 67}, order);
+    }
+}
+}
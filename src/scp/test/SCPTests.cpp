@@ -476,6 +476,62 @@ TEST_CASE("vblocking and quorum", "[scp]")
     REQUIRE(LocalNode::isVBlocking(qSet, nodeSet) == true);
 }
 
+TEST_CASE("quorum with transitive quorum sets", "[scp]")
+{
+    setupValues();
+    SIMULATION_CREATE_NODE(0);
+    SIMULATION_CREATE_NODE(1);
+    SIMULATION_CREATE_NODE(2);
+    SIMULATION_CREATE_NODE(3);
+    SIMULATION_CREATE_NODE(4);
+
+    auto makeQSet = [](uint32 threshold, std::vector<NodeID> const& nodes) {
+        auto qSet = std::make_shared<SCPQuorumSet>();
+        qSet->threshold = threshold;
+        qSet->validators.insert(qSet->validators.end(), nodes.begin(),
+                                nodes.end());
+        return qSet;
+    };
+    auto qSetAll = makeQSet(3, {v0NodeID, v1NodeID, v2NodeID, v3NodeID});
+
+    std::map<NodeID, SCPEnvelopeWrapperPtr> map;
+    std::map<NodeID, SCPQuorumSetPtr> qSets;
+    for (auto const& nodeID : {v0NodeID, v1NodeID, v2NodeID, v3NodeID})
+    {
+        SCPEnvelope env;
+        env.statement.nodeID = nodeID;
+        map.emplace(nodeID, std::make_shared<SCPEnvelopeWrapper>(env));
+        qSets[nodeID] = qSetAll;
+    }
+    auto qfun = [&](SCPStatement const& st) { return qSets[st.nodeID]; };
+
+    REQUIRE(LocalNode::isQuorum(*qSetAll, map, qfun));
+
+    // v3 depends on v4 that didn't send a statement
+    qSets[v3NodeID] = makeQSet(1, {v4NodeID});
+    REQUIRE(LocalNode::isQuorum(*qSetAll, map, qfun));
+
+    SECTION("removing a node makes its dependents drop out")
+    {
+        qSets[v2NodeID] = makeQSet(2, {v2NodeID, v3NodeID});
+        REQUIRE(!LocalNode::isQuorum(*qSetAll, map, qfun));
+    }
+
+    SECTION("filtered out nodes are not part of the quorum")
+    {
+        REQUIRE(!LocalNode::isQuorum(
+            *qSetAll, map, qfun, [&](SCPStatement const& st) {
+                return !(st.nodeID == v0NodeID);
+            }));
+    }
+
+    SECTION("nodes without a quorum set are not part of the quorum")
+    {
+        qSets[v1NodeID] = nullptr;
+        REQUIRE(!LocalNode::isQuorum(*qSetAll, map, qfun));
+    }
+}
+
 TEST_CASE("v blocking distance", "[scp]")
 {
     setupValues();
@@ -18,12 +18,16 @@
 #include "medida/stats/snapshot.h"
 #include "overlay/StellarXDR.h"
 #include "simulation/Topologies.h"
+#include "test/ScaleReporter.h"
 #include "test/test.h"
 #include "transactions/TransactionFrame.h"
 #include "util/Logging.h"
 #include "util/Math.h"
+#include "util/HashOfHash.h"
+#include "util/UnorderedMap.h"
 #include "util/types.h"
 #include "xdrpp/autocheck.h"
+#include <algorithm>
 #include <fmt/format.h>
 #include <sstream>
 
@@ -446,70 +450,6 @@ newLoadTestApp(VirtualClock& clock)
     return appPtr;
 }
 
-class ScaleReporter
-{
-    std::vector<std::string> mColumns;
-    std::string mFilename;
-    std::ofstream mOut;
-    size_t mNumWritten{0};
-    static std::string
-    join(std::vector<std::string> const& parts, std::string const& sep)
-    {
-        std::string sum;
-        bool first = true;
-        for (auto const& s : parts)
-        {
-            if (first)
-            {
-                first = false;
-            }
-            else
-            {
-                sum += sep;
-            }
-            sum += s;
-        }
-        return sum;
-    }
-
-  public:
-    ScaleReporter(std::vector<std::string> const& columns)
-        : mColumns(columns)
-        , mFilename(fmt::format("{:s}-{:d}.csv", join(columns, "-vs-"),
-                                std::time(nullptr)))
-    {
-        mOut.exceptions(std::ios::failbit | std::ios::badbit);
-        mOut.open(mFilename);
-        LOG_INFO(DEFAULT_LOG, "Opened {} for writing", mFilename);
-        mOut << join(columns, ",") << std::endl;
-    }
-
-    ~ScaleReporter()
-    {
-        LOG_INFO(DEFAULT_LOG, "Wrote {} rows to {}", mNumWritten, mFilename);
-    }
-
-    void
-    write(std::vector<double> const& vals)
-    {
-        assert(vals.size() == mColumns.size());
-        std::ostringstream oss;
-        for (size_t i = 0; i < vals.size(); ++i)
-        {
-            if (i != 0)
-            {
-                oss << ", ";
-                mOut << ",";
-            }
-            oss << mColumns.at(i) << "=" << std::fixed << vals.at(i);
-            mOut << std::fixed << vals.at(i);
-        }
-        LOG_INFO(DEFAULT_LOG, "Writing {}", oss.str());
-        mOut << std::endl;
-        ++mNumWritten;
-    }
-};
-
 TEST_CASE("Accounts vs latency", "[scalability][!hide]")
 {
     ScaleReporter r({"accounts", "txcount", "latencymin", "latencymax",
@@ -660,6 +600,187 @@ TEST_CASE("Branched cycle nodes vs network traffic", "[scalability][!hide]")
     });
 }
 
+static double
+percentile(std::vector<double> const& sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    auto i = static_cast<size_t>(p * sorted.size());
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+// Floods a fixed payment workload from one node of `sim` while SCP keeps
+// closing ledgers, and reports for every node: the time it took transactions
+// to reach its transaction queue (in virtual time, so that it only depends on
+// the overlay logic), the share of flooded bytes it received more than once,
+// the bytes it read and wrote, and the wall clock time its main thread spent
+// working.
+static void
+floodingBenchmark(std::string const& name, Simulation::pointer sim)
+{
+    sim->startAllNodes();
+    sim->crankUntil([&]() { return sim->haveAllExternalized(3, 4); },
+                    2 * 3 * Herder::EXP_LEDGER_TIMESPAN_SECONDS, false);
+    REQUIRE(sim->haveAllExternalized(3, 4));
+
+    auto nodeIDs = sim->getNodeIDs();
+    auto& app = *sim->getNode(nodeIDs[0]);
+    auto& loadGen = app.getLoadGenerator();
+    auto& complete =
+        app.getMetrics().NewMeter({"loadgen", "run", "complete"}, "run");
+
+    uint32_t const nAccounts = 100;
+    uint32_t const nTxs = 1000;
+    uint32_t const txRate = 20;
+    loadGen.generateLoad(GeneratedLoadConfig::createAccountsLoad(
+        nAccounts, /* txRate */ 10));
+    sim->crankUntil(
+        [&]() {
+            return complete.count() == 1 &&
+                   loadGen.checkAccountSynced(app, true).empty();
+        },
+        10 * Herder::EXP_LEDGER_TIMESPAN_SECONDS, false);
+
+    // Only measure the payments
+    struct NodeCounters
+    {
+        std::chrono::nanoseconds mBusyTime;
+        int64_t mUniqueFloodBytes;
+        int64_t mDuplicateFloodBytes;
+        int64_t mBytesRead;
+        int64_t mBytesWritten;
+    };
+    auto getCounters = [&](NodeID const& id) {
+        auto& metrics = sim->getNode(id)->getMetrics();
+        return NodeCounters{
+            sim->getNodeBusyTime(id),
+            metrics.NewMeter({"overlay", "flood", "unique-recv"}, "byte")
+                .count(),
+            metrics.NewMeter({"overlay", "flood", "duplicate-recv"}, "byte")
+                .count(),
+            metrics.NewMeter({"overlay", "byte", "read"}, "byte").count(),
+            metrics.NewMeter({"overlay", "byte", "write"}, "byte").count()};
+    };
+    std::vector<NodeCounters> before;
+    for (auto const& id : nodeIDs)
+    {
+        before.emplace_back(getCounters(id));
+    }
+
+    // When each transaction was first seen in the queue of each node. The
+    // first node is the one submitting the transactions.
+    std::vector<UnorderedMap<Hash, VirtualClock::time_point>> firstSeen(
+        nodeIDs.size());
+    auto recordKnownTxs = [&]() {
+        for (size_t i = 0; i < nodeIDs.size(); i++)
+        {
+            auto node = sim->getNode(nodeIDs[i]);
+            auto now = node->getClock().now();
+            node->getHerder().forEachKnownTx(
+                [&](TransactionFrameBaseConstPtr const& tx) {
+                    firstSeen[i].emplace(tx->getFullHash(), now);
+                });
+        }
+    };
+
+    loadGen.generateLoad(GeneratedLoadConfig::txLoad(LoadGenMode::PAY,
+                                                     nAccounts, nTxs, txRate));
+    auto deadline = app.getClock().now() +
+                    std::chrono::seconds(nTxs / txRate) +
+                    10 * Herder::EXP_LEDGER_TIMESPAN_SECONDS;
+    auto lcl = app.getLedgerManager().getLastClosedLedgerNum();
+    while (complete.count() < 2 || !sim->haveAllExternalized(lcl + 2, 4))
+    {
+        REQUIRE(app.getClock().now() < deadline);
+        sim->crankAllNodes();
+        recordKnownTxs();
+        if (complete.count() < 2)
+        {
+            lcl = app.getLedgerManager().getLastClosedLedgerNum();
+        }
+    }
+
+    ScaleReporter r({name + "node", "txs", "missed", "latency50", "latency90",
+                     "latency99", "latencymax", "dupratio", "in-byte",
+                     "out-byte", "busy-ms"});
+    for (size_t i = 0; i < nodeIDs.size(); i++)
+    {
+        std::vector<double> latencies;
+        size_t missed = 0;
+        for (auto const& submitted : firstSeen[0])
+        {
+            auto it = firstSeen[i].find(submitted.first);
+            if (it == firstSeen[i].end())
+            {
+                ++missed;
+                continue;
+            }
+            latencies.emplace_back(
+                std::chrono::duration<double, std::milli>(it->second -
+                                                          submitted.second)
+                    .count());
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        auto after = getCounters(nodeIDs[i]);
+        auto unique = after.mUniqueFloodBytes - before[i].mUniqueFloodBytes;
+        auto duplicate =
+            after.mDuplicateFloodBytes - before[i].mDuplicateFloodBytes;
+        r.write({(double)i, (double)latencies.size(), (double)missed,
+                 percentile(latencies, 0.5), percentile(latencies, 0.9),
+                 percentile(latencies, 0.99), percentile(latencies, 1.0),
+                 unique + duplicate == 0
+                     ? 0.0
+                     : (double)duplicate / (double)(unique + duplicate),
+                 (double)(after.mBytesRead - before[i].mBytesRead),
+                 (double)(after.mBytesWritten - before[i].mBytesWritten),
+                 std::chrono::duration<double, std::milli>(
+                     after.mBusyTime - before[i].mBusyTime)
+                     .count()});
+    }
+}
+
+// Run with `stellar-core test "[overlay-bench]"`
+TEST_CASE("Overlay flooding benchmark", "[overlay-bench][scalability][!hide]")
+{
+    auto confGen = [](int cfgCount) -> Config {
+        Config res = getTestConfig(cfgCount);
+        res.ARTIFICIALLY_ACCELERATE_TIME_FOR_TESTING = true;
+        res.TARGET_PEER_CONNECTIONS = 1000;
+        res.MAX_ADDITIONAL_PEER_CONNECTIONS = 1000;
+        res.TESTING_UPGRADE_MAX_TX_SET_SIZE = 1000;
+        return res;
+    };
+
+    SECTION("hierarchical")
+    {
+        floodingBenchmark(
+            "hierarchical",
+            Topologies::hierarchicalQuorum(
+                4, Simulation::OVER_LOOPBACK,
+                sha256("flooding-bench-hierarchical"), confGen, 2));
+    }
+    SECTION("random")
+    {
+        floodingBenchmark("random",
+                          Topologies::random(24, 4, 0.75,
+                                             Simulation::OVER_LOOPBACK,
+                                             sha256("flooding-bench-random"),
+                                             confGen));
+    }
+    SECTION("tiered")
+    {
+        // A fully connected core of validators, like the tier 1 of the
+        // public network, with watchers connected to a few of them
+        floodingBenchmark(
+            "tiered", Topologies::hierarchicalQuorumSimplified(
+                          7, 20, Simulation::OVER_LOOPBACK,
+                          sha256("flooding-bench-tiered"), confGen, 3));
+    }
+}
+
 TEST_CASE("Bucket list entries vs write throughput", "[scalability][!hide]")
 {
     VirtualClock clock;
@@ -407,13 +407,26 @@ Simulation::crankNode(NodeID const& id, VirtualClock::time_point timeout)
     });
 
     size_t count = 0;
+    auto start = std::chrono::steady_clock::now();
     while (!doneWithQuantum)
     {
         count += clock->crank(false);
     }
+    mNodes[id].mBusyTime += std::chrono::steady_clock::now() - start;
     return count - quantumClicks;
 }
 
+std::chrono::nanoseconds
+Simulation::getNodeBusyTime(NodeID const& id)
+{
+    auto it = mNodes.find(id);
+    if (it == mNodes.end())
+    {
+        throw std::runtime_error("Unknown node");
+    }
+    return it->second.mBusyTime;
+}
+
 std::size_t
 Simulation::crankAllNodes(int nbTicks)
 {
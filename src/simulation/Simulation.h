@@ -71,6 +71,8 @@ class Simulation
                              bool validatorsOnly = false);
 
     size_t crankNode(NodeID const& id, VirtualClock::time_point timeout);
+    // Wall clock time spent running the main thread of the node so far
+    std::chrono::nanoseconds getNodeBusyTime(NodeID const& id);
     size_t crankAllNodes(int nbTicks = 1);
     void crankForAtMost(VirtualClock::duration seconds, bool finalCrank);
     void crankForAtLeast(VirtualClock::duration seconds, bool finalCrank);
@@ -100,6 +102,7 @@ class Simulation
     {
         std::shared_ptr<VirtualClock> mClock;
         Application::pointer mApp;
+        std::chrono::nanoseconds mBusyTime{0};
 
         ~Node()
         {
@@ -4,6 +4,8 @@
 
 #include "simulation/Topologies.h"
 #include "crypto/SHA.h"
+#include "util/Math.h"
+#include <set>
 
 namespace stellar
 {
@@ -191,6 +193,39 @@ Topologies::branchedcycle(int nNodes, double quorumThresoldFraction,
     return simulation;
 }
 
+Simulation::pointer
+Topologies::random(int nNodes, int nConnections, double quorumThresoldFraction,
+                   Simulation::Mode mode, Hash const& networkID,
+                   Simulation::ConfigGen confGen,
+                   Simulation::QuorumSetAdjuster qSetAdjust)
+{
+    auto simulation = Topologies::separate(nNodes, quorumThresoldFraction, mode,
+                                           networkID, 0, confGen, qSetAdjust);
+
+    auto nodes = simulation->getNodeIDs();
+    assert(static_cast<int>(nodes.size()) == nNodes);
+    assert(nConnections >= 1 && nConnections < nNodes);
+
+    set<std::pair<int, int>> connected;
+    auto connect = [&](int from, int to) {
+        if (from != to &&
+            connected.emplace(min(from, to), max(from, to)).second)
+        {
+            simulation->addPendingConnection(nodes[from], nodes[to]);
+        }
+    };
+    for (int from = 0; from < nNodes; from++)
+    {
+        connect(from, (from + 1) % nNodes);
+        for (int i = 1; i < nConnections; i++)
+        {
+            connect(from, rand_uniform<int>(0, nNodes - 1));
+        }
+    }
+
+    return simulation;
+}
+
 Simulation::pointer
 Topologies::hierarchicalQuorum(
     int nBranches, Simulation::Mode mode, Hash const& networkID,
@@ -41,6 +41,15 @@ class Topologies
                   Simulation::ConfigGen confGen = nullptr,
                   Simulation::QuorumSetAdjuster qSetAdjust = nullptr);
 
+    // nNodes with same qSet - each node is connected to its successor (so
+    // that the network is connected) and to `nConnections - 1` other nodes
+    // picked at random
+    static Simulation::pointer
+    random(int nNodes, int nConnections, double quorumThresoldFraction,
+           Simulation::Mode mode, Hash const& networkID,
+           Simulation::ConfigGen confGen = nullptr,
+           Simulation::QuorumSetAdjuster qSetAdjust = nullptr);
+
     // nNodes with same qSet - no connection created
     static Simulation::pointer
     separate(int nNodes, double quorumThresoldFraction, Simulation::Mode mode,
@@ -0,0 +1,84 @@
+#pragma once
+
+// Copyright 2023 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/Logging.h"
+#include <cassert>
+#include <ctime>
+#include <fmt/format.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stellar
+{
+
+// Writes the rows of a scalability test to a timestamped CSV file named
+// after its columns, logging every row as it goes.
+class ScaleReporter
+{
+    std::vector<std::string> mColumns;
+    std::string mFilename;
+    std::ofstream mOut;
+    size_t mNumWritten{0};
+    static std::string
+    join(std::vector<std::string> const& parts, std::string const& sep)
+    {
+        std::string sum;
+        bool first = true;
+        for (auto const& s : parts)
+        {
+            if (first)
+            {
+                first = false;
+            }
+            else
+            {
+                sum += sep;
+            }
+            sum += s;
+        }
+        return sum;
+    }
+
+  public:
+    ScaleReporter(std::vector<std::string> const& columns)
+        : mColumns(columns)
+        , mFilename(fmt::format("{:s}-{:d}.csv", join(columns, "-vs-"),
+                                std::time(nullptr)))
+    {
+        mOut.exceptions(std::ios::failbit | std::ios::badbit);
+        mOut.open(mFilename);
+        LOG_INFO(DEFAULT_LOG, "Opened {} for writing", mFilename);
+        mOut << join(columns, ",") << std::endl;
+    }
+
+    ~ScaleReporter()
+    {
+        LOG_INFO(DEFAULT_LOG, "Wrote {} rows to {}", mNumWritten, mFilename);
+    }
+
+    void
+    write(std::vector<double> const& vals)
+    {
+        assert(vals.size() == mColumns.size());
+        std::ostringstream oss;
+        for (size_t i = 0; i < vals.size(); ++i)
+        {
+            if (i != 0)
+            {
+                oss << ", ";
+                mOut << ",";
+            }
+            oss << mColumns.at(i) << "=" << std::fixed << vals.at(i);
+            mOut << std::fixed << vals.at(i);
+        }
+        LOG_INFO(DEFAULT_LOG, "Writing {}", oss.str());
+        mOut << std::endl;
+        ++mNumWritten;
+    }
+};
+}
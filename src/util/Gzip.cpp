@@ -0,0 +1,340 @@
+// Copyright 2023 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/Gzip.h"
+#include "util/FileSystemException.h"
+#include "util/Fs.h"
+#include "util/GlobalChecks.h"
+#include <Tracy.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+
+namespace stellar
+{
+
+namespace
+{
+size_t const GZIP_BUFFER_SIZE = 256 * 1024;
+// Size of the blocks compressed independently by a parallel `gzipFile`: large
+// enough for the compression ratio to be close to the one of a single member.
+size_t const GZIP_PARALLEL_BLOCK_SIZE = 16 * 1024 * 1024;
+// `windowBits` selecting the gzip format (and, on inflate, auto-detection of
+// gzip and zlib headers)
+int const GZIP_DEFLATE_WINDOW_BITS = 15 + 16;
+int const GZIP_INFLATE_WINDOW_BITS = 15 + 32;
+
+std::ifstream
+openInput(std::string const& filename)
+{
+    std::ifstream in(filename, std::ifstream::binary);
+    if (!in)
+    {
+        throw FileSystemException(
+            fmt::format(FMT_STRING("failed to open {} for reading: {}"),
+                        filename, std::strerror(errno)));
+    }
+    in.exceptions(std::ios::badbit);
+    return in;
+}
+
+std::ofstream
+openOutput(std::string const& filename)
+{
+    std::ofstream out(filename, std::ofstream::binary | std::ofstream::trunc);
+    if (!out)
+    {
+        throw FileSystemException(
+            fmt::format(FMT_STRING("failed to open {} for writing: {}"),
+                        filename, std::strerror(errno)));
+    }
+    out.exceptions(std::ios::failbit | std::ios::badbit);
+    return out;
+}
+
+// Feeds `size` bytes to the deflate stream `zs`, passing the compressed output
+// to `write`. `finish` terminates the gzip member.
+template <typename Write>
+void
+deflateChunk(z_stream& zs, char const* data, size_t size, bool finish,
+             std::vector<unsigned char>& buf, Write&& write)
+{
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zs.avail_in = static_cast<uInt>(size);
+    int flush = finish ? Z_FINISH : Z_NO_FLUSH;
+    int ret;
+    do
+    {
+        zs.next_out = buf.data();
+        zs.avail_out = static_cast<uInt>(buf.size());
+        ret = deflate(&zs, flush);
+        if (ret == Z_STREAM_ERROR)
+        {
+            throw std::runtime_error("gzip: deflate failed");
+        }
+        write(reinterpret_cast<char const*>(buf.data()),
+              buf.size() - zs.avail_out);
+    } while (zs.avail_out == 0);
+    releaseAssert(zs.avail_in == 0);
+    releaseAssert(!finish || ret == Z_STREAM_END);
+}
+
+class Deflater
+{
+    z_stream mStream{};
+
+  public:
+    Deflater()
+    {
+        if (deflateInit2(&mStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                         GZIP_DEFLATE_WINDOW_BITS, 8,
+                         Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            throw std::runtime_error("gzip: deflateInit2 failed");
+        }
+    }
+    ~Deflater()
+    {
+        deflateEnd(&mStream);
+    }
+    Deflater(Deflater const&) = delete;
+    Deflater& operator=(Deflater const&) = delete;
+
+    z_stream&
+    get()
+    {
+        return mStream;
+    }
+};
+
+// Compresses `data` as a complete gzip member.
+std::vector<char>
+gzipMember(std::vector<char> const& data)
+{
+    ZoneScoped;
+    Deflater deflater;
+    std::vector<unsigned char> buf(GZIP_BUFFER_SIZE);
+    std::vector<char> res;
+    res.reserve(deflateBound(&deflater.get(), static_cast<uLong>(data.size())));
+    deflateChunk(
+        deflater.get(), data.data(), data.size(), true, buf,
+        [&](char const* p, size_t n) { res.insert(res.end(), p, p + n); });
+    return res;
+}
+
+void
+gzipFileSequential(std::ifstream& in, std::ofstream& out)
+{
+    Deflater deflater;
+    std::vector<char> inBuf(GZIP_BUFFER_SIZE);
+    std::vector<unsigned char> outBuf(GZIP_BUFFER_SIZE);
+    bool done = false;
+    while (!done)
+    {
+        in.read(inBuf.data(), inBuf.size());
+        done = in.eof();
+        deflateChunk(deflater.get(), inBuf.data(), in.gcount(), done, outBuf,
+                     [&](char const* p, size_t n) { out.write(p, n); });
+    }
+}
+
+// Process-wide limit on the number of blocks being compressed at the same
+// time, shared by all the concurrent parallel `gzipFile` calls (several
+// history files get compressed at once when publishing).
+class CompressionSlots
+{
+    std::mutex mMutex;
+    std::condition_variable mCv;
+    size_t mAvailable;
+
+  public:
+    CompressionSlots()
+        : mAvailable(std::max(1u, std::thread::hardware_concurrency()))
+    {
+    }
+
+    void
+    acquire()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCv.wait(lock, [&]() { return mAvailable > 0; });
+        --mAvailable;
+    }
+
+    void
+    release()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            ++mAvailable;
+        }
+        mCv.notify_one();
+    }
+};
+
+CompressionSlots&
+compressionSlots()
+{
+    static CompressionSlots slots;
+    return slots;
+}
+
+// Holds one of the `compressionSlots` for its lifetime
+class CompressionSlot
+{
+  public:
+    CompressionSlot()
+    {
+        compressionSlots().acquire();
+    }
+    ~CompressionSlot()
+    {
+        compressionSlots().release();
+    }
+    CompressionSlot(CompressionSlot const&) = delete;
+    CompressionSlot& operator=(CompressionSlot const&) = delete;
+};
+
+void
+gzipFileParallel(std::ifstream& in, std::ofstream& out, size_t threads)
+{
+    // Compress up to `threads` blocks at a time, writing them in order. Each
+    // block also needs a process-wide slot, which is only held while it is
+    // compressed: the tasks never wait on anything, so this can't deadlock.
+    bool done = false;
+    while (!done)
+    {
+        std::vector<std::future<std::vector<char>>> members;
+        while (!done && members.size() < threads)
+        {
+            auto slot = std::make_unique<CompressionSlot>();
+            std::vector<char> block(GZIP_PARALLEL_BLOCK_SIZE);
+            in.read(block.data(), block.size());
+            block.resize(in.gcount());
+            done = in.eof();
+            if (!block.empty())
+            {
+                members.emplace_back(std::async(
+                    std::launch::async,
+                    [b = std::move(block), s = std::move(slot)]() mutable {
+                        auto held = std::move(s);
+                        return gzipMember(b);
+                    }));
+            }
+        }
+        for (auto& m : members)
+        {
+            auto member = m.get();
+            out.write(member.data(), member.size());
+        }
+    }
+}
+
+// Decompresses all the members of `src`, passing the output to `write`.
+template <typename Write>
+void
+inflateFile(std::string const& src, Write&& write)
+{
+    auto in = openInput(src);
+    z_stream zs{};
+    if (inflateInit2(&zs, GZIP_INFLATE_WINDOW_BITS) != Z_OK)
+    {
+        throw std::runtime_error("gzip: inflateInit2 failed");
+    }
+    std::vector<char> inBuf(GZIP_BUFFER_SIZE);
+    std::vector<unsigned char> outBuf(GZIP_BUFFER_SIZE);
+    // the input is only valid if it ends on the end of a member
+    bool memberDone = false;
+    // inflate may have more output pending when it fills the output buffer
+    bool outputFull = false;
+    try
+    {
+        while (in)
+        {
+            in.read(inBuf.data(), inBuf.size());
+            zs.next_in = reinterpret_cast<Bytef*>(inBuf.data());
+            zs.avail_in = static_cast<uInt>(in.gcount());
+            while (zs.avail_in != 0 || outputFull)
+            {
+                if (memberDone)
+                {
+                    if (zs.avail_in == 0)
+                    {
+                        break;
+                    }
+                    // more data after the end of a member: next member
+                    if (inflateReset(&zs) != Z_OK)
+                    {
+                        throw std::runtime_error("gzip: inflateReset failed");
+                    }
+                    memberDone = false;
+                }
+                zs.next_out = outBuf.data();
+                zs.avail_out = static_cast<uInt>(outBuf.size());
+                int ret = inflate(&zs, Z_NO_FLUSH);
+                // Z_BUF_ERROR only means that no progress was possible
+                if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+                {
+                    throw std::runtime_error(fmt::format(
+                        FMT_STRING("gzip: invalid compressed data in {}: {}"),
+                        src, zs.msg ? zs.msg : std::to_string(ret)));
+                }
+                write(reinterpret_cast<char const*>(outBuf.data()),
+                      outBuf.size() - zs.avail_out);
+                outputFull = zs.avail_out == 0;
+                memberDone = ret == Z_STREAM_END;
+            }
+        }
+        if (!memberDone)
+        {
+            throw std::runtime_error(fmt::format(
+                FMT_STRING("gzip: unexpected end of file in {}"), src));
+        }
+    }
+    catch (...)
+    {
+        inflateEnd(&zs);
+        throw;
+    }
+    inflateEnd(&zs);
+}
+}
+
+void
+gzipFile(std::string const& src, std::string const& dst, size_t threads)
+{
+    ZoneScoped;
+    auto in = openInput(src);
+    auto out = openOutput(dst);
+    // A single member compresses a bit better, only split when there is
+    // enough data to keep several threads busy
+    if (threads > 1 && fs::size(in) >= 2 * GZIP_PARALLEL_BLOCK_SIZE)
+    {
+        gzipFileParallel(in, out, threads);
+    }
+    else
+    {
+        gzipFileSequential(in, out);
+    }
+    out.close();
+}
+
+void
+gunzipFile(std::string const& src, std::string const& dst)
+{
+    ZoneScoped;
+    auto out = openOutput(dst);
+    inflateFile(src, [&](char const* p, size_t n) { out.write(p, n); });
+    out.close();
+}
+}
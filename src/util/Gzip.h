@@ -0,0 +1,29 @@
+#pragma once
+
+// Copyright 2023 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include <cstddef>
+#include <string>
+
+namespace stellar
+{
+
+// In-process, streaming gzip (de)compression of files, using zlib.
+// These create or truncate `dst`, leave `src` untouched and throw
+// `FileSystemException` on I/O errors and `std::runtime_error` on invalid
+// input.
+
+// When `threads` is greater than 1 and the file is large enough, the input is
+// split in blocks that are compressed concurrently, each as a separate gzip
+// member. The output is still a regular gzip file (RFC 1952 allows several
+// members in a file), only slightly larger than a single member one. The
+// number of blocks compressed at the same time by all the concurrent calls is
+// also limited to the hardware concurrency.
+void gzipFile(std::string const& src, std::string const& dst,
+              size_t threads = 1);
+
+// Decompresses all the members of `src`.
+void gunzipFile(std::string const& src, std::string const& dst);
+}
@@ -15,8 +15,10 @@
 #include <Tracy.hpp>
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
+#include <zlib.h>
 #ifdef _WIN32
 #include <io.h>
 #endif
@@ -27,14 +29,73 @@ namespace stellar
 /**
  * Helper for loading a sequence of XDR objects from a file one at a time,
  * rather than all at once.
+ *
+ * Files with a `.gz` suffix are decompressed on the fly; such streams only
+ * support sequential reads (`readOne`).
  */
 class XDRInputFileStream
 {
     std::ifstream mIn;
+    std::unique_ptr<gzFile_s, decltype(&gzclose)> mGzIn{nullptr, &gzclose};
+    bool mGzGood{false};
     std::vector<char> mBuf;
     size_t mSizeLimit;
     size_t mSize;
 
+    // Reads up to `size` bytes from the compressed stream, returning how many
+    // were read: less than `size` only at the end of the file.
+    size_t
+    gzRead(char* buf, size_t size)
+    {
+        size_t total = 0;
+        while (total < size)
+        {
+            int n = gzread(mGzIn.get(), buf + total,
+                           static_cast<unsigned>(size - total));
+            if (n <= 0)
+            {
+                int err = Z_OK;
+                char const* msg = gzerror(mGzIn.get(), &err);
+                if (n < 0 || err != Z_OK)
+                {
+                    // includes truncated files (Z_BUF_ERROR)
+                    throw xdr::xdr_runtime_error(
+                        std::string("IO failure or corrupted gzip file: ") +
+                        msg);
+                }
+                break;
+            }
+            total += n;
+        }
+        return total;
+    }
+
+    // Reads `size` bytes from either kind of stream, returning false if the
+    // end of the file is reached first. Throws on IO errors.
+    bool
+    readExactly(char* buf, size_t size, char const* what)
+    {
+        if (mGzIn)
+        {
+            if (gzRead(buf, size) != size)
+            {
+                mGzGood = false;
+                return false;
+            }
+            return true;
+        }
+        if (!mIn.read(buf, size))
+        {
+            if (mIn.eof())
+            {
+                mIn.clear(std::ios_base::eofbit);
+                return false;
+            }
+            throw xdr::xdr_runtime_error(what);
+        }
+        return true;
+    }
+
   public:
     XDRInputFileStream(unsigned int sizeLimit = 0)
         : mSizeLimit{sizeLimit}, mSize{0}
@@ -45,13 +106,48 @@ class XDRInputFileStream
     close()
     {
         ZoneScoped;
-        mIn.close();
+        if (mGzIn)
+        {
+            mGzIn.reset();
+            mGzGood = false;
+        }
+        else
+        {
+            mIn.close();
+        }
     }
 
     void
     open(std::string const& filename)
     {
         ZoneScoped;
+        if (std::filesystem::path(filename).extension() == ".gz")
+        {
+            mGzIn.reset(gzopen(filename.c_str(), "rb"));
+            if (!mGzIn)
+            {
+                std::string msg("failed to open XDR file: ");
+                msg += filename;
+                msg += ", reason: ";
+                msg += std::to_string(errno);
+                CLOG_ERROR(Fs, "{}", msg);
+                throw FileSystemException(msg);
+            }
+            gzbuffer(mGzIn.get(), 128 * 1024);
+            // zlib would otherwise read files that are not compressed as is
+            if (gzdirect(mGzIn.get()))
+            {
+                mGzIn.reset();
+                std::string msg("not a gzip file: ");
+                msg += filename;
+                CLOG_ERROR(Fs, "{}", msg);
+                throw FileSystemException(msg);
+            }
+            mGzGood = true;
+            // compressed size
+            mSize = fs::size(filename);
+            return;
+        }
         mIn.open(filename, std::ifstream::binary);
         if (!mIn)
         {
@@ -68,7 +164,7 @@ class XDRInputFileStream
 
     operator bool() const
     {
-        return mIn.good();
+        return mGzIn ? mGzGood : mIn.good();
     }
 
     size_t
@@ -80,6 +176,7 @@ class XDRInputFileStream
     std::streamoff
     pos()
     {
+        releaseAssertOrThrow(!mGzIn);
         releaseAssertOrThrow(!mIn.fail());
         return mIn.tellg();
     }
@@ -87,6 +184,7 @@ class XDRInputFileStream
     void
     seek(size_t pos)
     {
+        releaseAssertOrThrow(!mGzIn);
         releaseAssertOrThrow(!mIn.fail());
         mIn.seekg(pos);
     }
@@ -113,17 +211,9 @@ class XDRInputFileStream
     {
         ZoneScoped;
         char szBuf[4];
-        if (!mIn.read(szBuf, 4))
+        if (!readExactly(szBuf, 4, "IO failure in readOne"))
         {
-            if (mIn.eof())
-            {
-                mIn.clear(std::ios_base::eofbit);
-                return false;
-            }
-            else
-            {
-                throw xdr::xdr_runtime_error("IO failure in readOne");
-            }
+            return false;
         }
 
         auto sz = getXDRSize(szBuf);
@@ -135,7 +225,9 @@ class XDRInputFileStream
         {
             mBuf.resize(sz);
         }
-        if (!mIn.read(mBuf.data(), sz))
+        if (sz != 0 &&
+            !readExactly(mBuf.data(), sz,
+                         "malformed XDR file or IO failure in readOne"))
         {
             throw xdr::xdr_runtime_error(
                 "malformed XDR file or IO failure in readOne");
@@ -155,6 +247,7 @@ class XDRInputFileStream
     readPage(T& out, LedgerKey const& key, size_t pageSize)
     {
         ZoneScoped;
+        releaseAssertOrThrow(!mGzIn);
         if (mBuf.size() != pageSize)
         {
             mBuf.resize(pageSize);
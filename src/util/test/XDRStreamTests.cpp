@@ -6,11 +6,13 @@
 #include "ledger/test/LedgerTestUtils.h"
 #include "lib/catch.hpp"
 #include "test/test.h"
+#include "util/Gzip.h"
 #include "util/Logging.h"
 #include "util/XDRStream.h"
 #include <fmt/format.h>
 
 #include <chrono>
+#include <fstream>
 
 using namespace stellar;
 
@@ -44,6 +46,75 @@ TEST_CASE("XDROutputFileStream fail modes", "[xdrstream]")
     }
 }
 
+TEST_CASE("XDRInputFileStream reads gzip files", "[xdrstream]")
+{
+    VirtualClock clock;
+    Config const& cfg = getTestConfig(0);
+    fs::mkpath(cfg.BUCKET_DIR_PATH);
+    auto filename = fmt::format("{}/entries.xdr", cfg.BUCKET_DIR_PATH);
+    auto filenameGz = filename + ".gz";
+
+    auto ledgerEntries = LedgerTestUtils::generateValidLedgerEntries(1000);
+    auto bucketEntries =
+        Bucket::convertToBucketEntry(false, {}, ledgerEntries, {});
+    {
+        XDROutputFileStream out(clock.getIOContext(), /*doFsync=*/false);
+        out.open(filename);
+        for (auto const& e : bucketEntries)
+        {
+            out.writeOne(e);
+        }
+        out.close();
+    }
+
+    SECTION("compressed entries round-trip")
+    {
+        gzipFile(filename, filenameGz);
+        XDRInputFileStream in;
+        in.open(filenameGz);
+        BucketEntry be;
+        size_t i = 0;
+        while (in.readOne(be))
+        {
+            REQUIRE(i < bucketEntries.size());
+            REQUIRE(be == bucketEntries[i++]);
+        }
+        REQUIRE(i == bucketEntries.size());
+        in.close();
+    }
+    SECTION("truncated compressed file throws")
+    {
+        gzipFile(filename, filenameGz);
+        {
+            std::ifstream in(filenameGz, std::ifstream::binary);
+            std::string content((std::istreambuf_iterator<char>(in)),
+                                std::istreambuf_iterator<char>());
+            in.close();
+            std::ofstream out(filenameGz,
+                              std::ofstream::binary | std::ofstream::trunc);
+            out.write(content.data(), content.size() / 2);
+        }
+        XDRInputFileStream in;
+        in.open(filenameGz);
+        BucketEntry be;
+        REQUIRE_THROWS_AS(
+            [&]() {
+                while (in.readOne(be))
+                {
+                }
+            }(),
+            xdr::xdr_runtime_error);
+    }
+    SECTION("uncompressed file with gz suffix is rejected")
+    {
+        REQUIRE(std::rename(filename.c_str(), filenameGz.c_str()) == 0);
+        XDRInputFileStream in;
+        REQUIRE_THROWS_AS(in.open(filenameGz), FileSystemException);
+    }
+    std::remove(filename.c_str());
+    std::remove(filenameGz.c_str());
+}
+
 TEST_CASE("XDROutputFileStream fsync bench", "[!hide][xdrstream][bench]")
 {
     VirtualClock clock;